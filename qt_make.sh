@@ -7,6 +7,21 @@ echo $($QMAKE --version)
 $QMAKE -project -o $PROJECT
 echo 'QMAKE_CXXFLAGS += --std=c++11' >> $PROJECT
 echo 'QT += network widgets multimedia multimediawidgets' >> $PROJECT
+# gm_trafficgen and gm_capreplay have their own main() and are built by CMake only
+echo 'SOURCES -= tools/trafficgen.cpp' >> $PROJECT
+echo 'SOURCES -= tools/capreplay.cpp' >> $PROJECT
+# so are the benchmarks and tests
+echo 'SOURCES -= tests/ingest_bench.cpp' >> $PROJECT
+echo 'SOURCES -= tests/handoff_stress.cpp' >> $PROJECT
+echo 'SOURCES -= tests/decode_bench.cpp' >> $PROJECT
+echo 'SOURCES -= tests/robot_registry_test.cpp' >> $PROJECT
+echo 'SOURCES -= tests/gc_decode_test.cpp' >> $PROJECT
+echo 'SOURCES -= tests/multifield_load.cpp' >> $PROJECT
+echo 'SOURCES -= tests/config_bench.cpp' >> $PROJECT
+echo 'SOURCES -= tests/render_bench.cpp' >> $PROJECT
+echo 'SOURCES -= tests/field_space_bench.cpp' >> $PROJECT
+echo 'SOURCES -= tests/log_archive_test.cpp' >> $PROJECT
+echo 'SOURCES -= tests/log_convert_test.cpp' >> $PROJECT
 
 if [ ! -d build ]; then
 	mkdir build
@@ -11,7 +11,25 @@ AspectRatioPixmapLabel::AspectRatioPixmapLabel(QWidget *parent) : QLabel(parent)
 void AspectRatioPixmapLabel::setPixmap(const QPixmap &p)
 {
 	pix = p;
-	QLabel::setPixmap(scaledPixmap());
+	if(pix.size() == targetSize())
+		QLabel::setPixmap(pix);
+	else
+		QLabel::setPixmap(scaledPixmap());
+}
+
+void AspectRatioPixmapLabel::setSceneSize(const QSize &size)
+{
+	scene_size = size;
+}
+
+/*
+ * Largest size of the scene that fits into the label.
+ */
+QSize AspectRatioPixmapLabel::targetSize() const
+{
+	if(scene_size.isEmpty())
+		return this->size();
+	return scene_size.scaled(this->size(), Qt::KeepAspectRatio);
 }
 
 int AspectRatioPixmapLabel::heightForWidth(int width) const
@@ -37,5 +55,6 @@ void AspectRatioPixmapLabel::resizeEvent(QResizeEvent *e)
 {
 	if(!pix.isNull())
 		QLabel::setPixmap(scaledPixmap());
+	emit resized();
 }
 
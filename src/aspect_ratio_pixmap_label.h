@@ -8,6 +8,11 @@
 #include <QPixmap>
 #include <QResizeEvent>
 
+/*
+ * Shows a pixmap scaled to the label, keeping its aspect ratio.
+ * A pixmap that already has targetSize() is shown as is, so a caller that
+ * renders at that size avoids the smooth scaling pass.
+ */
 class AspectRatioPixmapLabel : public QLabel
 {
 	Q_OBJECT
@@ -16,11 +21,16 @@ public:
 	virtual int heightForWidth(int width) const;
 	virtual QSize sizeHint() const;
 	QPixmap scaledPixmap() const;
+	void setSceneSize(const QSize &);
+	QSize targetSize() const;
+signals:
+	void resized();
 public slots:
 	void setPixmap(const QPixmap &);
 	void resizeEvent(QResizeEvent *);
 private:
 	QPixmap pix;
+	QSize scene_size;
 };
 
 #endif // ASPECT_RATIO_PIXMAP_LABEL_H
@@ -0,0 +1,320 @@
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+
+#include "binary_log.h"
+
+BinaryLogFile::BinaryLogFile() : data(nullptr), count(0)
+{
+}
+
+BinaryLogFile::~BinaryLogFile()
+{
+	close();
+}
+
+/*
+ * Map the file, false if it is not a binary log of this version.
+ */
+bool BinaryLogFile::open(const QString &file_name)
+{
+	close();
+	file.setFileName(file_name);
+	if(!file.open(QIODevice::ReadOnly)) {
+		std::cerr << "file open error" << std::endl;
+		return false;
+	}
+	const qint64 file_size = file.size();
+	if(file_size < static_cast<qint64>(sizeof(binary_log_header_T)) || (data = file.map(0, file_size)) == nullptr) {
+		std::cerr << "cannot map " << file_name.toStdString() << std::endl;
+		close();
+		return false;
+	}
+	const binary_log_header_T &log_header = header();
+	if(memcmp(log_header.magic, BINARY_LOG_MAGIC, sizeof(BINARY_LOG_MAGIC)) != 0 ||
+			log_header.version != BINARY_LOG_VERSION || log_header.record_size != sizeof(binary_log_record_T)) {
+		std::cerr << "unsupported binary log: " << file_name.toStdString() << std::endl;
+		close();
+		return false;
+	}
+	// a record cut off by a crash is ignored
+	count = (file_size - sizeof(binary_log_header_T)) / sizeof(binary_log_record_T);
+	return true;
+}
+
+void BinaryLogFile::close(void)
+{
+	if(data)
+		file.unmap(data);
+	data = nullptr;
+	count = 0;
+	file.close();
+}
+
+const binary_log_header_T &BinaryLogFile::header(void) const
+{
+	return *reinterpret_cast<const binary_log_header_T *>(data);
+}
+
+size_t BinaryLogFile::size(void) const
+{
+	return count;
+}
+
+const binary_log_record_T &BinaryLogFile::record(const size_t index) const
+{
+	return reinterpret_cast<const binary_log_record_T *>(data + sizeof(binary_log_header_T))[index];
+}
+
+bool isBinaryLog(const std::string &file_name)
+{
+	char magic[sizeof(BINARY_LOG_MAGIC)];
+	FILE *fp = fopen(file_name.c_str(), "rb");
+	if(!fp)
+		return false;
+	const bool binary = fread(magic, sizeof(magic), 1, fp) == 1 && memcmp(magic, BINARY_LOG_MAGIC, sizeof(magic)) == 0;
+	fclose(fp);
+	return binary;
+}
+
+void initBinaryLogHeader(binary_log_header_T &header, const int start_date, const int start_time_ms)
+{
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, BINARY_LOG_MAGIC, sizeof(BINARY_LOG_MAGIC));
+	header.version = BINARY_LOG_VERSION;
+	header.record_size = sizeof(binary_log_record_T);
+	header.start_date = start_date;
+	header.start_time_ms = start_time_ms;
+}
+
+static void copyString(char *dst, const size_t size, const char *src)
+{
+	strncpy(dst, src, size - 1);
+	dst[size - 1] = '\0';
+}
+
+/*
+ * Fill the LogData of a record, false for records the player ignores.
+ */
+static bool toLogData(const binary_log_header_T &header, const binary_log_record_T &record, LogData &ldata)
+{
+	const int32_t *v = record.values;
+	logTimeString(ldata.time_str, sizeof(ldata.time_str), header.start_time_ms + record.time_us / 1000);
+	switch(record.type) {
+	case BINARY_LOG_ROBOT: {
+		LogDataRobotComm &buf = ldata.robot_comm;
+		ldata.type = LOG_TYPE_ROBOTINFO;
+		strcpy(buf.time_str, ldata.time_str);
+		buf.id = v[0];
+		copyString(buf.color_str, sizeof(record.color), record.color);
+		buf.fps = v[1];
+		buf.voltage = record.reals[0];
+		buf.x = v[2];
+		buf.y = v[3];
+		buf.theta = record.reals[1];
+		buf.ball_x = v[4];
+		buf.ball_y = v[5];
+		buf.goal_pole_x1 = v[6];
+		buf.goal_pole_y1 = v[7];
+		buf.goal_pole_x2 = v[8];
+		buf.goal_pole_y2 = v[9];
+		buf.cf_own = v[10];
+		buf.cf_ball = v[11];
+		copyString(buf.msg, sizeof(record.text), record.text);
+		return true;
+	}
+	case BINARY_LOG_SCORE:
+		if(v[0] == 0) {
+			ldata.type = LOG_TYPE_SCORE1;
+			ldata.score1 = v[1];
+		} else if(v[0] == 1) {
+			ldata.type = LOG_TYPE_SCORE2;
+			ldata.score2 = v[1];
+		} else {
+			return false;
+		}
+		return true;
+	case BINARY_LOG_REMAINING_TIME:
+		ldata.type = LOG_TYPE_REMAININGTIME;
+		ldata.remaining_time = v[0];
+		return true;
+	case BINARY_LOG_SECONDARY_TIME:
+		ldata.type = LOG_TYPE_SECONDARYTIME;
+		ldata.secondary_time = v[0];
+		return true;
+	case BINARY_LOG_GAME_STATE:
+		ldata.type = LOG_TYPE_GAMESTATE;
+		ldata.game_state = v[0];
+		return true;
+	}
+	return false;
+}
+
+static void fromLogData(const LogData &ldata, const long long time_ms, binary_log_record_T &record)
+{
+	int32_t *v = record.values;
+	memset(&record, 0, sizeof(record));
+	record.time_us = time_ms * 1000;
+	if(ldata.type == LOG_TYPE_ROBOTINFO) {
+		const LogDataRobotComm &buf = ldata.robot_comm;
+		record.type = BINARY_LOG_ROBOT;
+		v[0] = buf.id;
+		v[1] = buf.fps;
+		v[2] = buf.x;
+		v[3] = buf.y;
+		v[4] = buf.ball_x;
+		v[5] = buf.ball_y;
+		v[6] = buf.goal_pole_x1;
+		v[7] = buf.goal_pole_y1;
+		v[8] = buf.goal_pole_x2;
+		v[9] = buf.goal_pole_y2;
+		v[10] = buf.cf_own;
+		v[11] = buf.cf_ball;
+		record.reals[0] = static_cast<float>(buf.voltage);
+		record.reals[1] = static_cast<float>(buf.theta);
+		copyString(record.color, sizeof(record.color), buf.color_str);
+		copyString(record.text, sizeof(record.text), buf.msg);
+	} else if(ldata.type == LOG_TYPE_SCORE1 || ldata.type == LOG_TYPE_SCORE2) {
+		record.type = BINARY_LOG_SCORE;
+		v[0] = ldata.type == LOG_TYPE_SCORE1 ? 0 : 1;
+		v[1] = ldata.type == LOG_TYPE_SCORE1 ? ldata.score1 : ldata.score2;
+	} else if(ldata.type == LOG_TYPE_REMAININGTIME) {
+		record.type = BINARY_LOG_REMAINING_TIME;
+		v[0] = ldata.remaining_time;
+	} else if(ldata.type == LOG_TYPE_SECONDARYTIME) {
+		record.type = BINARY_LOG_SECONDARY_TIME;
+		v[0] = ldata.secondary_time;
+	} else if(ldata.type == LOG_TYPE_GAMESTATE) {
+		record.type = BINARY_LOG_GAME_STATE;
+		v[0] = ldata.game_state;
+	}
+}
+
+bool isBinaryLogEntry(const binary_log_record_T &record)
+{
+	switch(record.type) {
+	case BINARY_LOG_ROBOT:
+	case BINARY_LOG_REMAINING_TIME:
+	case BINARY_LOG_SECONDARY_TIME:
+	case BINARY_LOG_GAME_STATE:
+		return true;
+	case BINARY_LOG_SCORE:
+		return record.values[0] == 0 || record.values[0] == 1;
+	}
+	return false;
+}
+
+bool binaryLogData(const BinaryLogFile &file, const size_t index, LogData &ldata)
+{
+	return toLogData(file.header(), file.record(index), ldata);
+}
+
+/*
+ * The whole log as LogData, for the exporter, the converter and archives.
+ * The player keeps a binary log mapped instead.
+ */
+bool readBinaryLog(const std::string &file_name, std::vector<LogData> &log_data)
+{
+	BinaryLogFile file;
+	if(!file.open(QString::fromStdString(file_name)))
+		return false;
+	log_data.reserve(log_data.size() + file.size());
+	for(size_t i = 0; i < file.size(); i++) {
+		LogData ldata;
+		if(toLogData(file.header(), file.record(i), ldata))
+			log_data.push_back(ldata);
+	}
+	return true;
+}
+
+bool writeBinaryLog(const std::string &file_name, const std::vector<LogData> &log_data)
+{
+	FILE *fp = fopen(file_name.c_str(), "wb");
+	if(!fp) {
+		std::cerr << "cannot open " << file_name << std::endl;
+		return false;
+	}
+	std::vector<long long> times;
+	const long long start = logTimesMs(log_data, times);
+	binary_log_header_T header;
+	initBinaryLogHeader(header, 0, static_cast<int>(start));
+	bool ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+	int cut = 0;
+	for(size_t i = 0; i < log_data.size() && ok; i++) {
+		binary_log_record_T record;
+		fromLogData(log_data[i], times[i], record);
+		if(log_data[i].type == LOG_TYPE_ROBOTINFO && strlen(log_data[i].robot_comm.msg) >= sizeof(record.text))
+			cut++;
+		ok = fwrite(&record, sizeof(record), 1, fp) == 1;
+	}
+	if(fclose(fp) != 0 || !ok) {
+		std::cerr << "cannot write " << file_name << std::endl;
+		return false;
+	}
+	if(cut > 0)
+		std::cerr << cut << " robot messages cut to " << sizeof(binary_log_record_T::text) - 1 << " bytes" << std::endl;
+	return true;
+}
+
+/*
+ * The time of an entry as a text format writes it. Times that are not
+ * log times are written as they are.
+ */
+static void textLogTime(char *time_str, const size_t size, const LogData &ldata, const TextLogVersion version)
+{
+	const long long time_ms = logTimeMs(ldata.time_str);
+	if(version == TEXT_LOG_2_1 || time_ms < 0) {
+		copyString(time_str, size, ldata.time_str);
+		return;
+	}
+	const long long seconds = time_ms / 1000;
+	snprintf(time_str, size, "%d:%d:%d", static_cast<int>(seconds / 3600), static_cast<int>(seconds / 60 % 60), static_cast<int>(seconds % 60));
+}
+
+/*
+ * Writes the lines of the given format. Format 2.1 is what LogWriter
+ * writes; entries read from older text logs keep their times in whole
+ * seconds. Format 1.0 has no secondary time or game state, those entries
+ * are left out.
+ */
+bool writeTextLog(const std::string &file_name, const std::vector<LogData> &log_data, const TextLogVersion version)
+{
+	FILE *fp = fopen(file_name.c_str(), "w");
+	if(!fp) {
+		std::cerr << "cannot open " << file_name << std::endl;
+		return false;
+	}
+	if(version == TEXT_LOG_2_0)
+		fprintf(fp, "Game Monitor, version: %d.%d\n", 2, 0);
+	else if(version == TEXT_LOG_2_1)
+		fprintf(fp, "Game Monitor, version: %d.%d\n", 2, 1);
+	// format 1.0 lines have no type, their number of fields tells it
+	const bool v1 = version == TEXT_LOG_1_0;
+	for(const auto &ldata : log_data) {
+		char time_str[sizeof(ldata.time_str)];
+		textLogTime(time_str, sizeof(time_str), ldata, version);
+		if(ldata.type == LOG_TYPE_ROBOTINFO) {
+			const LogDataRobotComm &buf = ldata.robot_comm;
+			fprintf(fp, "%s%s,%d,%s,%d,%.2lf,%d,%d,%f,%d,%d,%d,%d,%d,%d,%d,%d,%s\n", v1 ? "" : "RobotInfo,",
+				time_str, buf.id, buf.color_str, buf.fps, buf.voltage, buf.x, buf.y, buf.theta,
+				buf.ball_x, buf.ball_y, buf.goal_pole_x1, buf.goal_pole_y1, buf.goal_pole_x2, buf.goal_pole_y2,
+				buf.cf_own, buf.cf_ball, buf.msg);
+		} else if(ldata.type == LOG_TYPE_SCORE1) {
+			fprintf(fp, "%s%s,%d,%d\n", v1 ? "" : "Score,", time_str, 0, ldata.score1);
+		} else if(ldata.type == LOG_TYPE_SCORE2) {
+			fprintf(fp, "%s%s,%d,%d\n", v1 ? "" : "Score,", time_str, 1, ldata.score2);
+		} else if(ldata.type == LOG_TYPE_REMAININGTIME) {
+			fprintf(fp, "%s%s,%d\n", v1 ? "" : "RemainingTime,", time_str, ldata.remaining_time);
+		} else if(ldata.type == LOG_TYPE_SECONDARYTIME && !v1) {
+			fprintf(fp, "SecondaryTime,%s,%d\n", time_str, ldata.secondary_time);
+		} else if(ldata.type == LOG_TYPE_GAMESTATE && !v1) {
+			fprintf(fp, "GameState,%s,%d\n", time_str, ldata.game_state);
+		}
+	}
+	const bool error = ferror(fp) != 0;
+	if(fclose(fp) != 0 || error) {
+		std::cerr << "cannot write " << file_name << std::endl;
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,111 @@
+#ifndef BINARY_LOG_H
+#define BINARY_LOG_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <QFile>
+#include <QString>
+
+#include "log_reader.h"
+
+/*
+ * Binary game log, written by LogWriter when log/format is "binary".
+ *
+ * A file is one binary_log_header_T followed by binary_log_record_T
+ * records, all of the same size, so record i is at a fixed offset and a
+ * mapped file can be indexed without parsing. Times are microseconds of a
+ * monotonic clock since the header's start time. All fields are in host
+ * byte order.
+ *
+ * Strings are cut to fit their field with its terminating 0, so a robot
+ * message keeps at most 79 bytes. The monitor never writes longer ones,
+ * packets carry at most MAX_STRING (comm_info.h) bytes, but text logs
+ * may hold messages of up to 99 bytes; writeBinaryLog() cuts them and
+ * reports how many it cut.
+ */
+static const char BINARY_LOG_MAGIC[8] = { 'H', 'L', 'G', 'M', 'L', 'O', 'G', '\0' };
+static const uint32_t BINARY_LOG_VERSION = 2;
+
+enum {
+	BINARY_LOG_ROBOT = 1,          // values: id, fps, x, y, ball x, ball y, goal poles x1 y1 x2 y2, cf own, cf ball
+	                               // reals: voltage, theta; color; text: message
+	BINARY_LOG_SCORE = 2,          // values: team, score
+	BINARY_LOG_REMAINING_TIME = 3, // values: seconds
+	BINARY_LOG_SECONDARY_TIME = 4, // values: seconds
+	BINARY_LOG_GAME_STATE = 5,     // values: state
+	BINARY_LOG_LINK_QUALITY = 6,   // values: id, socket drops; reals: packets/s, jitter ms, longest gap ms; color
+	BINARY_LOG_RECORD_START = 7,   // text: record name
+	BINARY_LOG_RECORD_STOP = 8,
+	BINARY_LOG_SEPARATE = 9,
+};
+
+struct binary_log_header_T {
+	char magic[8];
+	uint32_t version;
+	uint32_t record_size;
+	int32_t start_date;    // local date of time 0 as yyyymmdd, 0 if unknown
+	int32_t start_time_ms; // local time of day of time 0
+	uint32_t reserved[4];
+};
+
+struct binary_log_record_T {
+	uint32_t type;
+	float reals[3];
+	int64_t time_us; // since the start time
+	int32_t values[12];
+	char color[16];
+	char text[80];
+};
+
+static_assert(sizeof(binary_log_header_T) == 40, "binary log header layout");
+static_assert(sizeof(binary_log_record_T) == 168, "binary log record layout");
+
+/*
+ * A binary log mapped into memory, read only.
+ */
+class BinaryLogFile
+{
+public:
+	BinaryLogFile();
+	~BinaryLogFile();
+	bool open(const QString &);
+	void close(void);
+	const binary_log_header_T &header(void) const;
+	size_t size(void) const;
+	const binary_log_record_T &record(const size_t) const;
+private:
+	BinaryLogFile(const BinaryLogFile &);
+	BinaryLogFile &operator=(const BinaryLogFile &);
+	QFile file;
+	unsigned char *data;
+	size_t count;
+};
+
+bool isBinaryLog(const std::string &);
+void initBinaryLogHeader(binary_log_header_T &, const int, const int);
+bool readBinaryLog(const std::string &, std::vector<LogData> &);
+
+/*
+ * Access to single records of a mapped log, for the player: which records
+ * it shows, and the LogData of one record, made only when it is played.
+ */
+bool isBinaryLogEntry(const binary_log_record_T &);
+bool binaryLogData(const BinaryLogFile &, const size_t, LogData &);
+
+/*
+ * Conversion between the text formats and the binary format. Entries
+ * that LogData does not keep, such as link quality, are not converted.
+ * Text logs can be written in any format readLogFile() reads.
+ */
+enum TextLogVersion {
+	TEXT_LOG_1_0, // no header, robot information, scores and remaining time only
+	TEXT_LOG_2_0, // times in whole seconds
+	TEXT_LOG_2_1, // times with milliseconds, as LogWriter writes
+};
+
+bool writeBinaryLog(const std::string &, const std::vector<LogData> &);
+bool writeTextLog(const std::string &, const std::vector<LogData> &, const TextLogVersion = TEXT_LOG_2_1);
+
+#endif // BINARY_LOG_H
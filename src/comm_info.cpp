@@ -0,0 +1,63 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "comm_info.h"
+
+void CommInfoView::copyTo(struct comm_info_T &comm_info) const
+{
+	unsigned char *p = reinterpret_cast<unsigned char *>(&comm_info);
+	std::memcpy(p, data, size);
+	std::memset(p + size, 0, sizeof(comm_info) - size);
+}
+
+void decodeCommInfoObjects(const unsigned char (*object)[4], CommInfoObjects &objs)
+{
+	// indexed by the (our side, opposite side) bits of the first byte
+	static const int type_table[4] = { GOAL_POLE, ENEMY, SELF_POS, BALL };
+	constexpr float deg_to_rad = static_cast<float>(M_PI / 180.0);
+	// No branches in the loop body: each object is 4 bytes holding a 10-bit
+	// signed x and y in centimeters and the heading in 2 degree steps.
+	for(int i = 0; i < MAX_COMM_INFO_OBJ; i++) {
+		const int d0 = object[i][0];
+		const int d1 = object[i][1];
+		const int d2 = object[i][2];
+		const int d3 = object[i][3];
+		const int exist = (d0 & COMM_EXIST) >> 7;
+		const int x = ((((d0 & 0x0f) << 6) | (d1 >> 2)) ^ 0x200) - 0x200;
+		const int y = ((((d1 & 0x03) << 8) | d2) ^ 0x200) - 0x200;
+		objs.x[i] = x * 10;
+		objs.y[i] = y * 10;
+		objs.th[i] = static_cast<float>(d3 * 2 - 180) * deg_to_rad;
+		objs.type[i] = type_table[(d0 >> 5) & 0x3] & -exist;
+	}
+}
+
+/*
+ * Inverse of decodeCommInfoObjects() for one object. Positions are in
+ * millimeters and clipped to the 10-bit range of the packet.
+ */
+void encodeCommInfoObject(unsigned char *object, const int type, const Pos &pos)
+{
+	int side;
+	if(type == SELF_POS)
+		side = COMM_OUR_SIDE;
+	else if(type == BALL)
+		side = COMM_OUR_SIDE | COMM_OPPOSITE_SIDE;
+	else if(type == ENEMY)
+		side = COMM_OPPOSITE_SIDE;
+	else if(type == GOAL_POLE)
+		side = 0;
+	else {
+		std::memset(object, 0, 4);
+		return;
+	}
+	const int x = std::max(-512, std::min(511, static_cast<int>(pos.x) / 10)) & 0x3ff;
+	const int y = std::max(-512, std::min(511, static_cast<int>(pos.y) / 10)) & 0x3ff;
+	const int deg = static_cast<int>(std::lround(pos.th * 180.0 / M_PI));
+	const int th = (((deg + 180) % 360 + 360) % 360) / 2;
+	object[0] = static_cast<unsigned char>(COMM_EXIST | side | (x >> 6));
+	object[1] = static_cast<unsigned char>(((x & 0x3f) << 2) | (y >> 8));
+	object[2] = static_cast<unsigned char>(y & 0xff);
+	object[3] = static_cast<unsigned char>(th);
+}
@@ -0,0 +1,90 @@
+#ifndef COMM_INFO_H
+#define COMM_INFO_H
+
+#include <cstddef>
+
+#include "pos_types.h"
+
+static const int COMM_INFO_PORT = 7110;
+static const int MAX_COMM_INFO_OBJ = 7;
+static const int MAX_STRING = 74;
+
+static const unsigned char COMM_EXIST = 0x80;
+static const unsigned char COMM_OUR_SIDE = 0x40;
+static const unsigned char COMM_OPPOSITE_SIDE = 0x20;
+static const unsigned char COMM_NOT_EXIST = 0x00;
+
+static const int MAX_BLACK_POLES = 6;
+static const int MAX_YELLOW_POLES = 1;
+static const int MAX_BLUE_POLES = 1;
+static const int MAX_MAGENTA_OBJECTS = 3;
+static const int MAX_CYAN_OBJECTS = 3;
+
+static const int MAGENTA = 0;
+static const int CYAN    = 1;
+
+struct comm_info_T {
+	unsigned char id;
+	unsigned char cf_own;
+	unsigned char cf_ball;
+	unsigned char object[MAX_COMM_INFO_OBJ][4];
+	unsigned char status;
+	unsigned char fps;
+	unsigned char voltage;
+	unsigned char temperature;
+	unsigned char hishest_servo;
+	unsigned char command[MAX_STRING];
+};
+
+/*
+ * One received robot datagram, the index of the port it arrived on (0 for
+ * the base port) and its receive time in microseconds of the monotonic
+ * clock (std::chrono::steady_clock). Robots are identified by
+ * comm_info.id, not by the port.
+ */
+struct comm_packet_T {
+	int port_index;
+	long long receive_time;
+	struct comm_info_T comm_info;
+};
+
+/*
+ * Read-only view of a robot datagram sitting in a receive buffer.
+ * Nothing is copied until copyTo() is called. A datagram is valid when it
+ * carries at least every field in front of the command string and is not
+ * longer than comm_info_T; a shorter command string is zero padded.
+ */
+class CommInfoView
+{
+public:
+	static const size_t MIN_SIZE = offsetof(struct comm_info_T, command);
+	static const size_t MAX_SIZE = sizeof(struct comm_info_T);
+	CommInfoView(const unsigned char *buf, size_t len) : data(buf), size(len) {}
+	bool isValid(void) const { return size >= MIN_SIZE && size <= MAX_SIZE; }
+	unsigned char id(void) const { return data[offsetof(struct comm_info_T, id)]; }
+	const unsigned char (*objects(void) const)[4]
+	{
+		return reinterpret_cast<const unsigned char (*)[4]>(data + offsetof(struct comm_info_T, object));
+	}
+	void copyTo(struct comm_info_T &) const;
+private:
+	const unsigned char *data;
+	size_t size;
+};
+
+/*
+ * Objects of one packet unpacked in a single pass. Positions are in
+ * millimeters, angles in radians, and type is NONE for empty entries.
+ */
+struct CommInfoObjects {
+	int x[MAX_COMM_INFO_OBJ];
+	int y[MAX_COMM_INFO_OBJ];
+	float th[MAX_COMM_INFO_OBJ];
+	int type[MAX_COMM_INFO_OBJ];
+	Pos pos(int i) const { return Pos(static_cast<float>(x[i]), static_cast<float>(y[i]), th[i]); }
+};
+
+void decodeCommInfoObjects(const unsigned char (*)[4], CommInfoObjects &);
+void encodeCommInfoObject(unsigned char *, const int, const Pos &);
+
+#endif // COMM_INFO_H
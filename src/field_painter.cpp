@@ -0,0 +1,465 @@
+#include <cmath>
+#include <cstring>
+
+#include <QPainterPath>
+#include <QPolygon>
+
+#include "field_painter.h"
+
+static inline int distance(const int x1, const int y1, const int x2, const int y2)
+{
+	const int x = x1 - x2;
+	const int y = y1 - y2;
+	return std::sqrt(x * x + y * y);
+}
+
+void PositionMarker::setFromLog(const LogDataRobotComm &data)
+{
+	// Role and message
+	const char *msg = data.msg;
+	if(strstr(msg, "Attacker")) {
+		// Red
+		strcpy(color, "red");
+	} else if(strstr(msg, "Neutral")) {
+		// Green
+		strcpy(color, "green");
+	} else if(strstr(msg, "Defender")) {
+		// Blue
+		strcpy(color, "blue");
+	} else if(strstr(msg, "Keeper")) {
+		// Orange
+		strcpy(color, "orange");
+	} else {
+		// Black
+		strcpy(color, "black");
+	}
+	message = std::string(msg);
+
+	enable_pos  = true;
+	enable_ball = true;
+	enable_goal_pole[0] = true;
+	enable_goal_pole[1] = true;
+
+	pos.x = data.x;
+	pos.y = data.y;
+	pos.th = data.theta;
+	ball.x = data.ball_x;
+	ball.y = data.ball_y;
+	goal_pole[0].x = data.goal_pole_x1;
+	goal_pole[0].y = data.goal_pole_y1;
+	goal_pole[1].x = data.goal_pole_x2;
+	goal_pole[1].y = data.goal_pole_y2;
+	self_conf = data.cf_own;
+	ball_conf = data.cf_ball;
+	voltage = data.voltage;
+	temperature = data.temperature;
+}
+
+FieldPainter::FieldPainter(const std::shared_ptr<const MonitorConfig> &monitor_config, const FieldView &field_view, TextCache *cache) : config(monitor_config), view(field_view), text_cache(cache)
+{
+}
+
+/*
+ * Texts of the markers rarely change between frames, they are drawn from
+ * the text cache if there is one.
+ */
+void FieldPainter::drawText(QPainter &painter, const int x, const int y, const QString &text) const
+{
+	if(text_cache != nullptr)
+		text_cache->drawText(painter, x, y, text);
+	else
+		painter.drawText(x, y, text);
+}
+
+void FieldPainter::drawField(QPainter &painter, const FieldParameterInt &field_param) const
+{
+	const int line_width = config->field_line_width;
+	QPen pen(Qt::white, line_width);
+	painter.setPen(pen);
+	// draw field lines, center circle and penalty marks
+	const int field_left = field_param.border_strip_width;
+	const int field_right = field_param.border_strip_width + field_param.field_length;
+	const int field_top = field_param.border_strip_width;
+	const int field_bottom = field_param.border_strip_width + field_param.field_width;
+	painter.drawLine(field_left, field_top, field_right, field_top);
+	painter.drawLine(field_left, field_top, field_left, field_bottom);
+	painter.drawLine(field_right, field_bottom, field_left, field_bottom);
+	painter.drawLine(field_right, field_top, field_right, field_bottom);
+	const int center_line_pos = field_left + field_param.field_length / 2;
+	painter.drawLine(center_line_pos, field_top, center_line_pos, field_bottom);
+	const int left_goal_x = field_left - field_param.goal_depth;
+	const int right_goal_x = field_right + field_param.goal_depth;
+	const int goal_top = field_param.field_width / 2 - field_param.goal_width / 2 + field_top;
+	const int goal_bottom = goal_top + field_param.goal_width;
+	painter.drawLine(left_goal_x, goal_top, left_goal_x, goal_bottom);
+	painter.drawLine(left_goal_x, goal_top, field_left, goal_top);
+	painter.drawLine(left_goal_x, goal_bottom, field_left, goal_bottom);
+	painter.drawLine(right_goal_x, goal_top, right_goal_x, goal_bottom);
+	painter.drawLine(right_goal_x, goal_top, field_right, goal_top);
+	painter.drawLine(right_goal_x, goal_bottom, field_right, goal_bottom);
+	const int left_goal_area_x = field_left + field_param.goal_area_length;
+	const int right_goal_area_x = field_right - field_param.goal_area_length;
+	const int goal_area_top = field_param.field_width / 2 - field_param.goal_area_width / 2 + field_top;
+	const int goal_area_bottom = goal_area_top + field_param.goal_area_width;
+	painter.drawLine(left_goal_area_x, goal_area_top, left_goal_area_x, goal_area_bottom);
+	painter.drawLine(left_goal_area_x, goal_area_top, field_left, goal_area_top);
+	painter.drawLine(left_goal_area_x, goal_area_bottom, field_left, goal_area_bottom);
+	painter.drawLine(right_goal_area_x, goal_area_top, right_goal_area_x, goal_area_bottom);
+	painter.drawLine(right_goal_area_x, goal_area_top, field_right, goal_area_top);
+	painter.drawLine(right_goal_area_x, goal_area_bottom, field_right, goal_area_bottom);
+	const int center_of_field_y = field_top + field_param.field_width / 2;
+	const int &dia = field_param.center_circle_diameter;
+	const int radius = dia / 2; // radius of center circle
+	painter.drawEllipse(center_line_pos - radius, center_of_field_y - radius, dia, dia);
+	painter.drawPoint(field_left + field_param.penalty_mark_distance, center_of_field_y);
+	painter.drawPoint(field_right - field_param.penalty_mark_distance, center_of_field_y);
+}
+
+void FieldPainter::drawTeamMarker(QPainter &painter, const FieldParameterInt &field_param) const
+{
+	// on the side of our own goal
+	int pos_x;
+	if(view.reverse)
+		pos_x = field_param.field_length / 2 - field_param.field_length / 4;
+	else
+		pos_x = field_param.field_length / 2 + field_param.field_length / 4;
+	const int pos_y = field_param.border_strip_width / 2;
+	painter.setPen(QPen(Qt::white));
+	QFont font = painter.font();
+	constexpr int team_marker_font_size = 32;
+	font.setPointSize(team_marker_font_size);
+	painter.setFont(font);
+	drawText(painter, pos_x, pos_y, QString("CIT Brains"));
+}
+
+bool FieldPainter::isReversed(const PositionMarker &marker) const
+{
+	// positions are stored as seen by MAGENTA
+	return (marker.colornum == 0 && view.reverse) || (marker.colornum == 1 && !view.reverse);
+}
+
+/*
+ * Lay out the information boxes of one frame. Robots and balls are marked
+ * as occupied first. Boxes of the last frame are kept where they are still
+ * free and near their robot, so they do not jump around; only the others
+ * are placed again, in drawing order. Runs once per frame before
+ * drawMarkers() and keeps its result in the markers.
+ */
+void FieldPainter::placeInformation(std::vector<PositionMarker> &positions, FieldSpaceManager &field_space) const
+{
+	const int field_w = config->field_image_width;
+	const int field_h = config->field_image_height;
+	field_space.clear();
+	for(size_t i = 0; i < positions.size(); i++) {
+		if(!positions[i].enable_pos)
+			continue;
+		int self_x = positions[i].pos.x;
+		int self_y = positions[i].pos.y;
+		int ball_x = positions[i].ball.x;
+		int ball_y = positions[i].ball.y;
+		if(isReversed(positions[i])) {
+			self_x = field_w - self_x;
+			self_y = field_h - self_y;
+			ball_x = field_w - ball_x;
+			ball_y = field_h - ball_y;
+		}
+		field_space.setObjectPos(self_x, self_y, 200, 200);
+		field_space.setObjectPos(ball_x, ball_y, 50, 50);
+	}
+	for(size_t i = 0; i < positions.size(); i++) {
+		PositionMarker &marker = positions[i];
+		if(!view.robot_information || !marker.enable_pos || !marker.info_placed) {
+			marker.info_placed = false;
+			continue;
+		}
+		int self_x = marker.pos.x;
+		int self_y = marker.pos.y;
+		if(isReversed(marker)) {
+			self_x = field_w - self_x;
+			self_y = field_h - self_y;
+		}
+		marker.info_placed = distance(marker.info_x, marker.info_y, self_x, self_y) <= INFO_MAX_DRIFT &&
+			field_space.reserveSpace(marker.info_x, marker.info_y, INFO_FRAME_WIDTH, INFO_FRAME_HEIGHT);
+	}
+	for(size_t i = 0; view.robot_information && i < positions.size(); i++) {
+		PositionMarker &marker = positions[i];
+		if(!marker.enable_pos || marker.info_placed)
+			continue;
+		int self_x = marker.pos.x;
+		int self_y = marker.pos.y;
+		if(isReversed(marker)) {
+			self_x = field_w - self_x;
+			self_y = field_h - self_y;
+		}
+		int frame_x, frame_y;
+		if(field_space.getEmptySpace(frame_x, frame_y, INFO_FRAME_WIDTH, INFO_FRAME_HEIGHT, self_x, self_y)) {
+			marker.info_placed = true;
+			marker.info_x = frame_x;
+			marker.info_y = frame_y;
+		} else {
+			marker.info_x = self_x;
+			marker.info_y = self_y + 120;
+		}
+	}
+}
+
+/*
+ * Draw trails, information boxes, robots, balls and goal posts. Trail
+ * points older than trail_since_ms are left out. Robot bodies are drawn
+ * by drawRobotBody() unless another drawer is given.
+ */
+void FieldPainter::drawMarkers(QPainter &paint, const std::vector<PositionMarker> &positions, const long long trail_since_ms, const RobotDrawer &robot_drawer) const
+{
+	QFont font = paint.font();
+	const int font_size = config->marker_font_size;
+	font.setPointSize(font_size);
+	paint.setFont(font);
+
+	const int field_w = config->field_image_width;
+	const int field_h = config->field_image_height;
+	for(size_t i = 0; i < positions.size(); i++) {
+		if(positions[i].enable_pos) {
+			int self_x = positions[i].pos.x;
+			int self_y = positions[i].pos.y;
+			double theta = positions[i].pos.th;
+			const bool flag_reverse = isReversed(positions[i]);
+			if(flag_reverse) {
+				self_x = field_w - self_x;
+				self_y = field_h - self_y;
+				theta = theta + M_PI;
+			}
+			const int robot_id = positions[i].robot_id;
+			const QColor color = getColor(positions[i].color);
+			if(view.trails) {
+				drawTrail(paint, positions[i].trail, color, flag_reverse, trail_since_ms);
+				drawTrail(paint, positions[i].ball_trail, QColor(0xFF, 0xA5, 0x00), flag_reverse, trail_since_ms);
+			}
+			if(view.robot_information)
+				drawRobotInformation(paint, positions[i], self_x, self_y);
+			if(robot_drawer)
+				robot_drawer(paint, self_x, self_y, theta, color);
+			else
+				drawRobotBody(paint, self_x, self_y, theta, color);
+			drawRobotLabel(paint, self_x, self_y, robot_id, color, positions[i].self_conf);
+
+			if(positions[i].enable_ball && positions[i].ball_conf > 0) {
+				int ball_x = positions[i].ball.x;
+				int ball_y = positions[i].ball.y;
+				if(flag_reverse) {
+					ball_x = field_w - ball_x;
+					ball_y = field_h - ball_y;
+				}
+				const int distance_ball_and_robot = distance(ball_x, ball_y, self_x, self_y);
+				drawBallMarker(paint, ball_x, ball_y, robot_id, distance_ball_and_robot, self_x, self_y);
+			}
+			// draw goal posts
+			if(view.goal_post) {
+				for(int j = 0; j < 2; j++) {
+					if(positions[i].enable_goal_pole[j]) {
+						int goal_pole_x = positions[i].goal_pole[j].x;
+						int goal_pole_y = positions[i].goal_pole[j].y;
+						bool flag_reverse = false;
+						if(flag_reverse) {
+							goal_pole_x = field_w - goal_pole_x;
+							goal_pole_y = field_h - goal_pole_y;
+						}
+						drawGoalPostMarker(paint, goal_pole_x, goal_pole_y, self_x, self_y);
+					}
+				}
+			}
+		}
+	}
+}
+
+void FieldPainter::drawRobotBody(QPainter &painter, const int self_x, const int self_y, const double theta, const QColor marker_color) const
+{
+	// set marker color according to robot role
+	const int robot_pen_size = config->marker_pen_size;
+	painter.setPen(QPen(marker_color, robot_pen_size));
+
+	// draw robot marker
+	painter.drawPoint(self_x, self_y);
+	const int robot_marker_radius = config->marker_robot_size;
+	painter.drawEllipse(self_x - robot_marker_radius, self_y - robot_marker_radius, robot_marker_radius * 2, robot_marker_radius * 2);
+	const int robot_marker_direction_length = config->marker_direction_marker_length;
+	const int direction_x = self_x + robot_marker_direction_length * std::cos(theta);
+	const int direction_y = self_y + robot_marker_direction_length * std::sin(theta);
+	painter.drawLine(self_x, self_y, direction_x, direction_y);
+}
+
+/*
+ * The robot number and the self position confidence bar. They change
+ * with every robot and confidence, so they are not part of the body
+ * sprites and are drawn every frame.
+ */
+void FieldPainter::drawRobotLabel(QPainter &painter, const int self_x, const int self_y, const int robot_id, const QColor marker_color, const double self_conf) const
+{
+	painter.setPen(QPen(marker_color, config->marker_pen_size));
+
+	// draw robot number
+	QString id_str = QString::number(robot_id);
+	const int font_offset_x = config->marker_font_offset_x;
+	const int font_offset_y = config->marker_font_offset_y;
+	drawText(painter, self_x - font_offset_x, self_y - font_offset_y, id_str);
+
+	// draw self position confidence
+	if(view.self_pos_conf) {
+		constexpr int bar_width = 80;
+		constexpr int bar_height = 12;
+		const int bar_left = self_x - bar_width / 2;
+		const int bar_top = self_y + 35;
+		QPainterPath path_frame, path_conf;
+		path_frame.addRect(bar_left - 2, bar_top - 2, bar_width + 4, bar_height + 4);
+		painter.fillPath(path_frame, Qt::white);
+		const auto conf = self_conf;
+		const int conf_width = static_cast<int>(conf / 100.0 * bar_width);
+		QPen pen = painter.pen();
+		constexpr int pen_size = 1;
+		painter.setPen(QPen(QColor(0, 0, 0), pen_size));
+		painter.setRenderHint(QPainter::NonCosmeticDefaultPen);
+		painter.drawRect(bar_left, bar_top, bar_width, bar_height);
+		painter.setRenderHint(QPainter::Antialiasing);
+		painter.setPen(pen);
+		path_conf.addRect(bar_left, bar_top, conf_width, bar_height);
+		QColor color;
+		// change color by self-position confidence (red, orange or green)
+		if(conf < 30) {
+			color = Qt::red;
+		} else if(conf < 70) {
+			color = QColor(0xFF, 0xA5, 0x00); // orange
+		} else {
+			color = Qt::green;
+		}
+		painter.fillPath(path_conf, color);
+	}
+}
+
+void FieldPainter::drawRobotInformation(QPainter &painter, const PositionMarker &marker, const int self_x, const int self_y) const
+{
+	constexpr int frame_width = INFO_FRAME_WIDTH;
+	constexpr int frame_height = INFO_FRAME_HEIGHT;
+	const int frame_x = marker.info_x;
+	const int frame_y = marker.info_y;
+	const int frame_left = frame_x - frame_width / 2;
+	const int frame_top = frame_y - frame_height / 2;
+	constexpr int pen_size = 3;
+	painter.setPen(QPen(Qt::red, pen_size));
+	painter.drawLine(frame_x, frame_y, self_x, self_y);
+	QPainterPath path_frame;
+	path_frame.addRect(frame_left, frame_top, frame_width, frame_height);
+	const QColor frame_color(0xE6, 0xE6, 0xFA); // lavender
+	painter.fillPath(path_frame, frame_color);
+	const QColor frame_border_color(0x80, 0x00, 0x80); // purple
+	painter.setPen(QPen(frame_border_color, pen_size));
+	painter.drawRect(frame_left, frame_top, frame_width, frame_height);
+
+	painter.setPen(QPen(Qt::red));
+	constexpr int font_size = 20;
+	// all boxes share the font, only the first one of a frame sets it
+	if(painter.font().pointSize() != font_size) {
+		QFont font = painter.font();
+		font.setPointSize(font_size);
+		painter.setFont(font);
+	}
+	constexpr int font_offset_x = 12;
+	constexpr int font_offset_y = 20 + font_size / 2;
+	std::string s(marker.message); // message without role name
+	s.erase(s.begin(), s.begin() + s.find(" "));
+	drawText(painter, frame_left + font_offset_x, frame_top + font_offset_y, QString(s.c_str()));
+	QString voltage_str = QString::number(marker.voltage) + "[V] / " + QString::number(marker.temperature) + "[C]";
+	constexpr int font_offset_2y = 20 + font_size / 2 + font_size + 15;
+	drawText(painter, frame_left + font_offset_x, frame_top + font_offset_2y, voltage_str);
+
+	constexpr int bar_width = 8;
+	constexpr int bar_height = frame_height - 4;
+	QColor bar_color(0xFF, 0xA5, 0x00); // orange
+	painter.setPen(QPen(bar_color, 2));
+	painter.drawRect(frame_left + 2, frame_top + 2, bar_width, bar_height - 2);
+	QPainterPath path_bar;
+	const int bar_left = frame_left + 2;
+	const int bar_fill_height = static_cast<int>(marker.ball_conf / 100.0 * bar_height);
+	const int bar_fill_top = frame_top + 2 + (bar_height - bar_fill_height);
+	path_bar.addRect(bar_left, bar_fill_top, bar_width, bar_fill_height);
+	painter.fillPath(path_bar, bar_color);
+}
+
+void FieldPainter::drawBallMarker(QPainter &painter, const int ball_x, const int ball_y, const int owner_id, const int distance_ball_and_robot, const int self_x, const int self_y) const
+{
+	// draw ball position as orange
+	const int ball_marker_size = config->marker_ball_size;
+	QColor orange(0xFF, 0xA5, 0x00);
+	painter.setPen(QPen(orange, ball_marker_size));
+	painter.drawPoint(ball_x, ball_y);
+	constexpr int ball_near_threshold = 50; // Do not draw robot number if the ball is near the robot.
+	if(distance_ball_and_robot > ball_near_threshold) {
+		QString id_str = QString::number(owner_id);
+		const int font_offset_x = config->marker_font_offset_x;
+		const int font_offset_y = config->marker_font_offset_y;
+		drawText(painter, ball_x - font_offset_x, ball_y - font_offset_y, id_str);
+	}
+	painter.setPen(QPen(orange, 1));
+	painter.drawLine(self_x, self_y, ball_x, ball_y);
+}
+
+void FieldPainter::drawGoalPostMarker(QPainter &painter, const int goal_x, const int goal_y, const int self_x, const int self_y) const
+{
+	QColor goal_post_color = Qt::red;
+	const int goal_post_marker_size = config->marker_goal_pole_size;
+	painter.setPen(QPen(goal_post_color, goal_post_marker_size));
+	painter.drawPoint(goal_x, goal_y);
+	painter.setPen(QPen(goal_post_color, 1));
+	painter.drawLine(self_x, self_y, goal_x, goal_y);
+}
+
+void FieldPainter::drawTrail(QPainter &painter, const Trail &trail, const QColor color, const bool flag_reverse, const long long since_ms) const
+{
+	const int first = trail.firstSince(since_ms);
+	if(trail.size() - first < 2)
+		return;
+	const int field_w = config->field_image_width;
+	const int field_h = config->field_image_height;
+	QPolygon line(trail.size() - first);
+	for(int i = first; i < trail.size(); i++) {
+		const Trail::Point &p = trail.at(i);
+		if(flag_reverse)
+			line.setPoint(i - first, field_w - p.x, field_h - p.y);
+		else
+			line.setPoint(i - first, p.x, p.y);
+	}
+	QColor trail_color = color;
+	trail_color.setAlpha(160);
+	painter.setPen(QPen(trail_color, 2));
+	painter.drawPolyline(line);
+}
+
+void FieldPainter::drawHighlightCircle(QPainter &painter, const int center_x, const int center_y) const
+{
+	QColor circle_color = Qt::red;
+	QPen pen = painter.pen();
+	const int pen_size = 2;
+	int circle_size;
+	painter.setPen(QPen(circle_color, pen_size));
+	circle_size = 200;
+	painter.drawEllipse(center_x - (circle_size / 2), center_y - (circle_size / 2), circle_size, circle_size);
+	painter.setPen(QPen(circle_color, pen_size));
+	circle_size = 100;
+	painter.drawEllipse(center_x - (circle_size / 2), center_y - (circle_size / 2), circle_size, circle_size);
+	painter.setPen(pen);
+}
+
+QColor FieldPainter::getColor(const char *color_name)
+{
+	if(!strcmp(color_name, "red")) {
+		return QColor(0xFF, 0x8E, 0x8E);
+	} else if(!strcmp(color_name, "black")) {
+		return QColor(0x00, 0x00, 0x00);
+	} else if(!strcmp(color_name, "green")) {
+		return QColor(0x8E, 0xFF, 0x8E);
+	} else if(!strcmp(color_name, "blue")) {
+		return QColor(0x8E, 0x8E, 0xFF);
+	} else if(!strcmp(color_name, "orange")) {
+		return QColor(0xFF, 0xA5, 0xA0);
+	} else {
+		return QColor(0x00, 0x00, 0x00);
+	}
+}
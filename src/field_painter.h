@@ -0,0 +1,159 @@
+#ifndef FIELD_PAINTER_H
+#define FIELD_PAINTER_H
+
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <QColor>
+#include <QPainter>
+
+#include "pos_types.h"
+#include "log_reader.h"
+#include "monitor_config.h"
+#include "field_space_manager.h"
+#include "trail.h"
+#include "text_cache.h"
+
+/*
+ * Field parameters.
+ * See Law 1 of rule book(2018) at http://www.robocuphumanoid.org/wp-content/uploads/RCHL-2018-Rules-Proposal_changesMarked_final.pdf
+ */
+class FieldParameter
+{
+	// unit: meter
+public:
+	FieldParameter() :
+		field_length(9.0),
+		field_width(6.0),
+		goal_depth(0.6),
+		goal_width(2.6),
+		goal_height(1.8),
+		goal_area_length(1.0),
+		goal_area_width(5.0),
+		penalty_mark_distance(2.1),
+		center_circle_diameter(1.5),
+		border_strip_width(0.7)
+	{
+	}
+	~FieldParameter() {};
+	const double field_length;
+	const double field_width;
+	const double goal_depth;
+	const double goal_width;
+	const double goal_height;
+	const double goal_area_length;
+	const double goal_area_width;
+	const double penalty_mark_distance;
+	const double center_circle_diameter;
+	const double border_strip_width;
+};
+
+class FieldParameterInt
+{
+	// unit: centimeter
+public:
+	FieldParameterInt(FieldParameter param) :
+		field_length(static_cast<int>(param.field_length * 100)),
+		field_width(static_cast<int>(param.field_width * 100)),
+		goal_depth(static_cast<int>(param.goal_depth * 100)),
+		goal_width(static_cast<int>(param.goal_width * 100)),
+		goal_height(static_cast<int>(param.goal_height * 100)),
+		goal_area_length(static_cast<int>(param.goal_area_length * 100)),
+		goal_area_width(static_cast<int>(param.goal_area_width * 100)),
+		penalty_mark_distance(static_cast<int>(param.penalty_mark_distance * 100)),
+		center_circle_diameter(static_cast<int>(param.center_circle_diameter * 100)),
+		border_strip_width(static_cast<int>(param.border_strip_width * 100))
+	{
+	}
+	~FieldParameterInt() {};
+	const int field_length;
+	const int field_width;
+	const int goal_depth;
+	const int goal_width;
+	const int goal_height;
+	const int goal_area_length;
+	const int goal_area_width;
+	const int penalty_mark_distance;
+	const int center_circle_diameter;
+	const int border_strip_width;
+};
+
+class PositionMarker {
+public:
+	PositionMarker() : self_conf(0.0), ball_conf(0.0), voltage(0.0), temperature(0.0), colornum(0), robot_id(0), info_placed(false), info_x(0), info_y(0), enable_pos(false), enable_ball(false), enable_goal_pole{false, false} { color[0] = '\0'; }
+	double self_conf;
+	double ball_conf;
+	double voltage;
+	double temperature;
+	int colornum;
+	int robot_id;
+	bool info_placed; /* information box position of the last frame */
+	int info_x;
+	int info_y;
+	bool enable_pos;
+	bool enable_ball;
+	bool enable_goal_pole[2];
+	struct tm lastReceiveTime;
+	char color[20];
+	Pos pos; /* self position */
+	Pos ball; /* ball position */
+	Pos goal_pole[2]; /* goal pole position */
+	Trail trail; /* recent self positions */
+	Trail ball_trail; /* recent ball positions seen by this robot */
+	std::string message;
+	void setFromLog(const LogDataRobotComm &);
+};
+
+/*
+ * Options of the View menu and the reverse check box that change what is
+ * drawn on the map.
+ */
+struct FieldView {
+	FieldView() : reverse(false), goal_post(false), robot_information(true), self_pos_conf(true), trails(false) {}
+	bool reverse;
+	bool goal_post;
+	bool robot_information;
+	bool self_pos_conf;
+	bool trails;
+};
+
+/*
+ * Draws the field and the robot markers in field image coordinates.
+ * A FieldPainter only reads its configuration snapshot and the markers it
+ * is given, so the monitor window and the export workers each draw with
+ * their own instance and the same code.
+ */
+class FieldPainter
+{
+public:
+	// draws the body of one robot marker, the window passes its sprite cache
+	typedef std::function<void(QPainter &, const int, const int, const double, const QColor)> RobotDrawer;
+	FieldPainter(const std::shared_ptr<const MonitorConfig> &, const FieldView &, TextCache * = nullptr);
+	void drawField(QPainter &, const FieldParameterInt &) const;
+	void drawTeamMarker(QPainter &, const FieldParameterInt &) const;
+	void placeInformation(std::vector<PositionMarker> &, FieldSpaceManager &) const;
+	void drawMarkers(QPainter &, const std::vector<PositionMarker> &, const long long, const RobotDrawer & = RobotDrawer()) const;
+	void drawRobotBody(QPainter &, const int, const int, const double, const QColor) const;
+	static QColor getColor(const char *);
+	static const int MARKER_COLORS = 5; // different colors getColor() returns
+	static const int INFO_FRAME_WIDTH = 200;
+	static const int INFO_FRAME_HEIGHT = 80;
+	static const int INFO_MAX_DRIFT = 300; // from the robot, before the box is placed again
+private:
+	bool isReversed(const PositionMarker &) const;
+	void drawText(QPainter &, const int, const int, const QString &) const;
+	void drawRobotLabel(QPainter &, const int, const int, const int, const QColor, const double) const;
+	void drawRobotInformation(QPainter &, const PositionMarker &, const int, const int) const;
+	void drawBallMarker(QPainter &, const int, const int, const int, const int, const int, const int) const;
+	void drawGoalPostMarker(QPainter &, const int, const int, const int, const int) const;
+	void drawTrail(QPainter &, const Trail &, const QColor, const bool, const long long) const;
+	void drawHighlightCircle(QPainter &, const int, const int) const;
+	const std::shared_ptr<const MonitorConfig> config;
+	const FieldView view;
+	TextCache *text_cache;
+};
+
+#endif // FIELD_PAINTER_H
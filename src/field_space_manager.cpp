@@ -1,16 +1,9 @@
-#include <utility>
+#include <algorithm>
 #include <cmath>
 
 #include "field_space_manager.h"
 
-static inline int distance(const int x1, const int y1, const int x2, const int y2)
-{
-	const int x = x1 - x2;
-	const int y = y1 - y2;
-	return std::sqrt(x * x + y * y);
-}
-
-FieldSpaceManager::FieldSpaceManager(const int field_w, const int field_h) : EXIST(1), EMPTY(0), grid_num_x(20), grid_num_y(20), grid_map(grid_num_y, std::vector<int>(grid_num_x, EMPTY)), field_width(field_w), field_height(field_h)
+FieldSpaceManager::FieldSpaceManager(const int field_w, const int field_h, const int grid_x, const int grid_y) : EXIST(1), EMPTY(0), grid_num_x(grid_x), grid_num_y(grid_y), grid_map(grid_num_x * grid_num_y, EMPTY), sum_table((grid_num_x + 1) * (grid_num_y + 1), 0), sum_valid_rows(grid_num_y + 1), failed_w(0), failed_h(0), field_width(field_w), field_height(field_h)
 {
 }
 
@@ -22,22 +15,57 @@ void FieldSpaceManager::setObjectPos(const int x, const int y, const int w, cons
 {
 	const int step_x = field_width / grid_num_x;
 	const int step_y = field_height / grid_num_y;
-	for(int yi = (y - h / 2) / step_y; yi * step_y < (y + h / 2); yi++) {
-		for(int xi = (x - w / 2) / step_x; xi * step_x < (x + w / 2); xi++) {
-			if(yi < 0 || yi >= grid_num_y) continue;
-			if(xi < 0 || xi >= grid_num_x) continue;
-			grid_map[yi][xi] = EXIST;
-		}
-	}
+	// the cells overlapped by the rectangle, clipped to the grid
+	const int x0 = std::max((x - w / 2) / step_x, 0);
+	const int y0 = std::max((y - h / 2) / step_y, 0);
+	int x1 = (x - w / 2) / step_x;
+	while(x1 * step_x < (x + w / 2)) x1++;
+	int y1 = (y - h / 2) / step_y;
+	while(y1 * step_y < (y + h / 2)) y1++;
+	markCells(x0, y0, std::min(x1, grid_num_x) - x0, std::min(y1, grid_num_y) - y0);
 }
 
 void FieldSpaceManager::clear(void)
 {
-	for(int i = 0; i < grid_num_y; i++) {
-		for(int j = 0; j < grid_num_x; j++) {
-			grid_map[i][j] = EMPTY;
+	std::fill(grid_map.begin(), grid_map.end(), EMPTY);
+	std::fill(sum_table.begin(), sum_table.end(), 0);
+	sum_valid_rows = grid_num_y + 1;
+	failed_w = 0;
+	failed_h = 0;
+}
+
+void FieldSpaceManager::markCells(const int xi, const int yi, const int w, const int h)
+{
+	if(w <= 0 || h <= 0)
+		return;
+	for(int y = yi; y < yi + h; y++)
+		std::fill(grid_map.begin() + y * grid_num_x + xi, grid_map.begin() + y * grid_num_x + xi + w, EXIST);
+	// sum_table row y + 1 covers grid rows up to y
+	sum_valid_rows = std::min(sum_valid_rows, yi + 1);
+}
+
+void FieldSpaceManager::updateSumTable(void)
+{
+	const int stride = grid_num_x + 1;
+	for(int y = sum_valid_rows; y <= grid_num_y; y++) {
+		const unsigned char *cells = &grid_map[(y - 1) * grid_num_x];
+		const int *above = &sum_table[(y - 1) * stride];
+		int *row = &sum_table[y * stride];
+		int row_sum = 0;
+		for(int x = 1; x <= grid_num_x; x++) {
+			row_sum += cells[x - 1];
+			row[x] = above[x] + row_sum;
 		}
 	}
+	sum_valid_rows = grid_num_y + 1;
+}
+
+bool FieldSpaceManager::isEmpty(const int xi, const int yi, const int w, const int h) const
+{
+	const int stride = grid_num_x + 1;
+	const int *top = &sum_table[yi * stride];
+	const int *bottom = &sum_table[(yi + h) * stride];
+	return bottom[xi + w] - bottom[xi] - top[xi + w] + top[xi] == 0;
 }
 
 bool FieldSpaceManager::getEmptySpace(int &space_x, int &space_y, const int request_w, const int request_h, const int priority_x, const int priority_y)
@@ -46,56 +74,92 @@ bool FieldSpaceManager::getEmptySpace(int &space_x, int &space_y, const int requ
 	const int grid_step_y = field_height / grid_num_y;
 	const int necessary_grid_num_x = request_w / grid_step_x + 1;
 	const int necessary_grid_num_y = request_h / grid_step_y + 1;
-	int start_x, start_y;
-	std::vector<std::pair<int, int>> spaces;
-	for(int yi = 0; yi < grid_num_y; yi++) {
-		for(int xi = 0; xi < grid_num_x; xi++) {
-			if(grid_map[yi][xi] == EMPTY) {
-				start_x = xi;
-				start_y = yi;
-				for(int yyi = 0; yyi < necessary_grid_num_y; yyi++) {
-					for(int xxi = 0; xxi < necessary_grid_num_x; xxi++) {
-						if(yi + yyi >= grid_num_y) goto exit_loop;
-						if(xi + xxi >= grid_num_x) goto exit_loop;
-						if(grid_map[yi + yyi][xi + xxi] != EMPTY) {
-							goto exit_loop;
-						}
-					}
+	const int max_xi = grid_num_x - necessary_grid_num_x;
+	const int max_yi = grid_num_y - necessary_grid_num_y;
+	space_x = 0;
+	space_y = 0;
+	if(max_xi < 0 || max_yi < 0)
+		return false;
+	// cells are only ever taken until clear(), so a size that did not fit
+	// before does not fit now, nor does anything larger
+	if(failed_w > 0 && necessary_grid_num_x >= failed_w && necessary_grid_num_y >= failed_h)
+		return false;
+	updateSumTable();
+
+	// center of a space relative to its top left cell
+	const int offset_x = static_cast<int>(necessary_grid_num_x / 2.0 * grid_step_x);
+	const int offset_y = static_cast<int>(necessary_grid_num_y / 2.0 * grid_step_y);
+	// top left cell of the space centered on the priority position
+	const int start_xi = std::max(0, std::min(max_xi, static_cast<int>(std::lround(static_cast<double>(priority_x - offset_x) / grid_step_x))));
+	const int start_yi = std::max(0, std::min(max_yi, static_cast<int>(std::lround(static_cast<double>(priority_y - offset_y) / grid_step_y))));
+	const int max_ring = std::max(std::max(start_xi, max_xi - start_xi), std::max(start_yi, max_yi - start_yi));
+	// every candidate in ring r is at least this far from the priority
+	// position, minus the rounding of the start cell
+	const double ring_step = std::min(grid_step_x, grid_step_y);
+	const double start_error = std::hypot(std::abs(start_xi * grid_step_x + offset_x - priority_x), std::abs(start_yi * grid_step_y + offset_y - priority_y));
+
+	double best_dist2 = -1.0;
+	int best_xi = 0, best_yi = 0;
+	for(int ring = 0; ring <= max_ring; ring++) {
+		if(best_dist2 >= 0.0) {
+			const double bound = ring * ring_step - start_error;
+			if(bound > 0.0 && bound * bound > best_dist2)
+				break;
+		}
+		const int y_begin = std::max(0, start_yi - ring);
+		const int y_end = std::min(max_yi, start_yi + ring);
+		for(int yi = y_begin; yi <= y_end; yi++) {
+			const bool edge_row = (yi == start_yi - ring || yi == start_yi + ring);
+			// inner rows of the ring only have their two end cells
+			const int x_step = edge_row ? 1 : std::max(1, 2 * ring);
+			for(int xi = start_xi - ring; xi <= start_xi + ring; xi += x_step) {
+				if(xi < 0 || xi > max_xi)
+					continue;
+				if(!isEmpty(xi, yi, necessary_grid_num_x, necessary_grid_num_y))
+					continue;
+				const double dx = grid_step_x * xi + offset_x - priority_x;
+				const double dy = grid_step_y * yi + offset_y - priority_y;
+				const double dist2 = dx * dx + dy * dy;
+				// ties go to the upper left space, like a row major scan
+				if(best_dist2 < 0.0 || dist2 < best_dist2 ||
+						(dist2 == best_dist2 && (yi < best_yi || (yi == best_yi && xi < best_xi)))) {
+					best_dist2 = dist2;
+					best_xi = xi;
+					best_yi = yi;
 				}
-				spaces.push_back(std::pair<int, int>(start_x, start_y));
 			}
-exit_loop: ;
 		}
 	}
-	if(spaces.size() > 0) {
-		int min_index = 0;
-		int min_distance = 10000;
-		for(int index = 0; index < spaces.size(); index++) {
-			const int posx = grid_step_x * spaces[index].first + static_cast<int>(necessary_grid_num_x / 2.0 * grid_step_x);
-			const int posy = grid_step_y * spaces[index].second + static_cast<int>(necessary_grid_num_y / 2.0 * grid_step_y);
-			const int dist = distance(posx, posy, priority_x, priority_y);
-			if(dist < min_distance) {
-				min_distance = dist;
-				min_index = index;
-			}
-		}
-		const int xi = spaces[min_index].first;
-		const int yi = spaces[min_index].second;
-		for(int yyi = 0; yyi < necessary_grid_num_y; yyi++) {
-			for(int xxi = 0; xxi < necessary_grid_num_x; xxi++) {
-				if(yi + yyi >= grid_num_y) continue;
-				if(xi + xxi >= grid_num_x) continue;
-				grid_map[yi + yyi][xi + xxi] = EXIST;
-			}
-		}
-		// return center pos of space
-		space_x = grid_step_x * xi + static_cast<int>(necessary_grid_num_x / 2.0 * grid_step_x);
-		space_y = grid_step_y * yi + static_cast<int>(necessary_grid_num_y / 2.0 * grid_step_y);
-		return true;
+	if(best_dist2 < 0.0) {
+		// no space found
+		failed_w = necessary_grid_num_x;
+		failed_h = necessary_grid_num_y;
+		return false;
 	}
-	// no space found
-	space_x = 0;
-	space_y = 0;
-	return false;
+	markCells(best_xi, best_yi, necessary_grid_num_x, necessary_grid_num_y);
+	// return center pos of space
+	space_x = grid_step_x * best_xi + offset_x;
+	space_y = grid_step_y * best_yi + offset_y;
+	return true;
 }
 
+/*
+ * Take a space returned by an earlier getEmptySpace() call again, if it is
+ * still free.
+ */
+bool FieldSpaceManager::reserveSpace(const int space_x, const int space_y, const int request_w, const int request_h)
+{
+	const int grid_step_x = field_width / grid_num_x;
+	const int grid_step_y = field_height / grid_num_y;
+	const int necessary_grid_num_x = request_w / grid_step_x + 1;
+	const int necessary_grid_num_y = request_h / grid_step_y + 1;
+	const int xi = (space_x - static_cast<int>(necessary_grid_num_x / 2.0 * grid_step_x)) / grid_step_x;
+	const int yi = (space_y - static_cast<int>(necessary_grid_num_y / 2.0 * grid_step_y)) / grid_step_y;
+	if(xi < 0 || yi < 0 || xi + necessary_grid_num_x > grid_num_x || yi + necessary_grid_num_y > grid_num_y)
+		return false;
+	updateSumTable();
+	if(!isEmpty(xi, yi, necessary_grid_num_x, necessary_grid_num_y))
+		return false;
+	markCells(xi, yi, necessary_grid_num_x, necessary_grid_num_y);
+	return true;
+}
@@ -3,23 +3,44 @@
 
 #include <vector>
 
+/*
+ * Occupancy grid over the field image, used to find free space for the
+ * robot information boxes.
+ *
+ * Cells live in one flat array. A summed-area table over it answers "is
+ * this rectangle free" in constant time. Marking a rectangle invalidates
+ * the table rows from its top edge down, and the next query rebuilds
+ * them. That is O(grid) per placed box, but only a few thousand
+ * additions on the monitor's grid; no update of the table can be cheaper,
+ * since every entry below and right of a marked cell changes.
+ * getEmptySpace() visits candidate positions in rings around the
+ * preferred position and stops as soon as no farther ring can hold a
+ * closer one. A query that finds nothing visits every candidate, so the
+ * size that failed is remembered until clear().
+ */
 class FieldSpaceManager
 {
 public:
-	FieldSpaceManager(const int, const int);
+	FieldSpaceManager(const int, const int, const int = 20, const int = 20);
 	~FieldSpaceManager();
 	void setObjectPos(const int, const int, const int, const int);
 	void clear(void);
 	bool getEmptySpace(int &, int &, const int, const int, const int = 0, const int = 0);
+	bool reserveSpace(const int, const int, const int, const int);
 private:
-	const int EXIST;
-	const int EMPTY;
+	void markCells(const int, const int, const int, const int);
+	void updateSumTable(void);
+	bool isEmpty(const int, const int, const int, const int) const;
+	const unsigned char EXIST;
+	const unsigned char EMPTY;
 	const int grid_num_x;
 	const int grid_num_y;
-	std::vector<std::vector<int>> grid_map;
+	std::vector<unsigned char> grid_map; // grid_num_x * grid_num_y cells, row major
+	std::vector<int> sum_table; // (grid_num_x + 1) * (grid_num_y + 1), first row and column are 0
+	int sum_valid_rows; // rows of sum_table that are up to date
+	int failed_w, failed_h; // cells of the smallest request that found no space, 0 if none
 	const int field_width;
 	const int field_height;
 };
 
 #endif // FIELD_SPACE_MANAGER_H
-
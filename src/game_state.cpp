@@ -1,6 +1,25 @@
+#include <cstring>
+
 #include "game_state.h"
+#include "gc_layout.h"
+
+namespace {
+
+inline int readInt16(const unsigned char *p)
+{
+	return static_cast<signed short>(p[1] << 8 | p[0]);
+}
+
+} // namespace
 
-GameState::GameState() : m_game_state(0), m_remaining_time(0), m_secondary_time(0), m_score1(0), m_score2(0), f_update_score1(false), f_update_score2(false)
+const GameState::Decoder GameState::decoders[] = {
+	// most common version first
+	{ GCLayoutV12::version, GCLayoutV12::packet_size, &GameState::decodePacket<GCLayoutV12> },
+	{ GCLayoutV11::version, GCLayoutV11::packet_size, &GameState::decodePacket<GCLayoutV11> },
+};
+const unsigned int GameState::num_decoders = sizeof(decoders) / sizeof(decoders[0]);
+
+GameState::GameState() : m_data(), f_received(false), m_rejected_packets(0), m_unsupported_packets(0)
 {
 }
 
@@ -8,115 +27,185 @@ GameState::~GameState()
 {
 }
 
-void GameState::setData(const char *in_data, const unsigned int data_len)
+/*
+ * Decode one GameController packet and return the fields that changed
+ * (GS_* bits). Malformed, duplicated and out-of-order packets and
+ * packets of unknown protocol versions return 0. source is the IPv4
+ * address of the sender; packets are numbered per GameController, so
+ * several of them on one network are told apart by it.
+ */
+unsigned int GameState::setData(const char *in_data, const unsigned int data_len, const unsigned int source)
 {
 	const unsigned char *data = reinterpret_cast<const unsigned char *>(in_data);
-	constexpr unsigned int packet_size = 640;
-	if(data_len != packet_size)
-		return;
-	decodeData(data + 0);
-	decodeTeamInfo(data + 24);
-	decodeTeamInfo(data + 24 + 308);
+	constexpr unsigned int header_size = 6;
+	if(data_len < header_size || !(data[0] == 'R' && data[1] == 'G' && data[2] == 'm' && data[3] == 'e')) {
+		m_rejected_packets++;
+		return 0;
+	}
+	const unsigned int protcol_version = data[5] << 8 | data[4];
+	for(unsigned int i = 0; i < num_decoders; i++) {
+		if(decoders[i].version != protcol_version)
+			continue;
+		if(decoders[i].packet_size != data_len) {
+			m_rejected_packets++;
+			return 0;
+		}
+		return (this->*decoders[i].decode)(data, source);
+	}
+	m_unsupported_packets++;
+	return 0;
 }
 
-void GameState::decodeData(const unsigned char *data)
+template<class Layout>
+unsigned int GameState::decodePacket(const unsigned char *data, const unsigned int source)
 {
-	if(!(data[0] == 'R' && data[1] == 'G' && data[2] == 'm' && data[3] == 'e')) {
-		return;
+	typedef Layout L;
+	if(!acceptPacketNumber(data[L::packet_number], source)) {
+		m_rejected_packets++;
+		return 0;
 	}
-	const unsigned int protcol_version = data[5] << 8 | data[4];
-	const unsigned int packet_number = data[6];
-	const unsigned int players_per_team = data[7];
-	const unsigned int game_type = data[8];
-	const   signed int state = data[9];
-	const unsigned int first_half = data[10];
-	const unsigned int kick_off_team = data[11];
-	const unsigned int secondary_state = data[12];
-	const unsigned int secondary_state_info = data[16] << 24 | data[15] << 16 | data[14] << 8 | data[13];
-	const unsigned int drop_in_team = data[17];
-	const   signed int drop_in_time = static_cast<signed short>(data[19] << 8 | data[18]);
-	const   signed int secs_remaining = static_cast<signed short>(data[21] << 8 | data[20]);
-	const   signed int secondary_time = static_cast<signed short>(data[23] << 8 | data[22]);
-
-	constexpr unsigned int PROTCOL_VERSION = 12;
-	if(protcol_version != PROTCOL_VERSION)
-		return;
-	m_game_state = state;
-	m_remaining_time = secs_remaining;
-	m_secondary_time = secondary_time;
-}
-
-void GameState::decodeTeamInfo(const unsigned char *data)
-{
-	const unsigned int team_number = data[0];
-	const unsigned int team_color = data[1];
-	const unsigned int score = data[2];
-	const unsigned int penalty_shot = data[3];
-	const unsigned int single_shots = data[5] << 8 | data[4];
-	const unsigned int coach_sequence = data[6];
-	const unsigned char *coach_message = data + 7;
-	constexpr unsigned int coach_message_size = 253;
-	decodeRobotInfo(data + 7 + coach_message_size);
-	constexpr unsigned int max_players = 11;
-	for(unsigned int i = 0; i < max_players; i++) {
-		constexpr unsigned int sizeof_robot_info = 4;
-		decodeRobotInfo(data + 260 + sizeof_robot_info + (sizeof_robot_info * i));
+	const   signed int state = data[L::state];
+	const   signed int secs_remaining = readInt16(data + L::secs_remaining);
+	const   signed int secondary_time = readInt16(data + L::secondary_time);
+	m_data.version = L::version;
+	m_data.players_per_team = data[L::players_per_team];
+	m_data.first_half = data[L::first_half];
+	m_data.kick_off_team = data[L::kick_off_team];
+	m_data.secondary_state = data[L::secondary_state];
+
+	unsigned int dirty = 0;
+	if(m_data.game_state != state) {
+		m_data.game_state = state;
+		dirty |= GS_GAME_STATE;
+	}
+	if(m_data.remaining_time != secs_remaining) {
+		m_data.remaining_time = secs_remaining;
+		dirty |= GS_REMAINING_TIME;
 	}
+	if(m_data.secondary_time != secondary_time) {
+		m_data.secondary_time = secondary_time;
+		dirty |= GS_SECONDARY_TIME;
+	}
+	dirty |= decodeTeamInfo<L>(data + L::team_info, m_data.teams[0]);
+	dirty |= decodeTeamInfo<L>(data + L::team_info + L::team_info_size, m_data.teams[1]);
+	// the first packet reports everything, even fields that decoded to 0
+	if(!f_received) {
+		f_received = true;
+		dirty = GS_ALL;
+	}
+	return dirty;
+}
 
-	constexpr unsigned int TEAM_COLOR_BLUE = 0;
-	constexpr unsigned int TEAM_COLOR_RED = 1;
+template<class Layout>
+unsigned int GameState::decodeTeamInfo(const unsigned char *data, GCTeamInfo &team)
+{
+	typedef Layout L;
+	static_assert(L::max_players <= GC_MAX_PLAYERS, "too many players for GCTeamInfo");
+	static_assert(L::robot_info_size == sizeof(GCRobotInfo), "robot info must match GCRobotInfo");
+	GCTeamInfo decoded;
+	std::memset(&decoded, 0, sizeof(decoded));
+	decoded.team_number = data[L::team_number];
+	decoded.team_color = data[L::team_color];
+	decoded.score = data[L::score];
+	decoded.penalty_shot = data[L::penalty_shot];
+	decoded.single_shots = data[L::single_shots + 1] << 8 | data[L::single_shots];
+	decoded.coach_sequence = data[L::coach_sequence];
+	// robot infos are plain byte quadruples, so they are copied as is
+	std::memcpy(&decoded.coach, data + L::coach, sizeof(GCRobotInfo));
+	std::memcpy(decoded.players, data + L::players, L::max_players * sizeof(GCRobotInfo));
+
+	unsigned int dirty = 0;
+	if(std::memcmp(&team, &decoded, sizeof(decoded)) != 0) {
+		std::memcpy(&team, &decoded, sizeof(decoded));
+		dirty |= GS_TEAM_INFO;
+	}
+	const unsigned int score = decoded.score;
+	if(decoded.team_color == GC_TEAM_COLOR_BLUE && m_data.score1 != score) {
+		m_data.score1 = score;
+		dirty |= GS_SCORE1;
+	} else if(decoded.team_color == GC_TEAM_COLOR_RED && m_data.score2 != score) {
+		m_data.score2 = score;
+		dirty |= GS_SCORE2;
+	}
+	return dirty;
+}
 
-	if(team_color == TEAM_COLOR_BLUE && m_score1 != score) {
-		f_update_score1 = true;
-		m_score1 = score;
-	} else if(team_color == TEAM_COLOR_RED && m_score2 != score) {
-		f_update_score2 = true;
-		m_score2 = score;
+/*
+ * packet_number is an 8-bit counter incremented by the GameController for
+ * every packet. Anything that is not ahead of the last accepted number is
+ * a duplicate or arrived late. A long run of such packets means the
+ * GameController was restarted, so we resynchronize. Every source address
+ * has a counter of its own.
+ */
+bool GameState::acceptPacketNumber(const unsigned int packet_number, const unsigned int source)
+{
+	constexpr unsigned int resync_threshold = 8;
+	PacketSource *packet_source = nullptr;
+	for(auto &known : m_sources) {
+		if(known.address == source) {
+			packet_source = &known;
+			break;
+		}
+	}
+	if(packet_source == nullptr) {
+		const PacketSource first = { source, packet_number, 0 };
+		m_sources.push_back(first);
+		return true;
 	}
+	const unsigned char ahead = static_cast<unsigned char>(packet_number - packet_source->packet_number);
+	if(ahead == 0 || ahead >= 128) {
+		if(++packet_source->stale_in_row < resync_threshold)
+			return false;
+	}
+	packet_source->stale_in_row = 0;
+	packet_source->packet_number = packet_number;
+	return true;
 }
 
-void GameState::decodeRobotInfo(const unsigned char *data)
+const GameStateData &GameState::getData(void) const
 {
-	const unsigned int penalty = data[0];
-	const unsigned int secs_till_unpenalised = data[1];
-	const unsigned int yello_card_count = data[2];
-	const unsigned int red_card_count = data[3];
+	return m_data;
 }
 
-int GameState::getGameState(void)
+int GameState::getGameState(void) const
 {
-	return m_game_state;
+	return m_data.game_state;
 }
 
-int GameState::getRemainingTime(void)
+int GameState::getRemainingTime(void) const
 {
-	return m_remaining_time;
+	return m_data.remaining_time;
 }
 
-int GameState::getSecondaryTime(void)
+int GameState::getSecondaryTime(void) const
 {
-	return m_secondary_time;
+	return m_data.secondary_time;
 }
 
-bool GameState::updatedScore1(void)
+unsigned int GameState::getScore1(void) const
 {
-	return f_update_score1;
+	return m_data.score1;
 }
 
-bool GameState::updatedScore2(void)
+unsigned int GameState::getScore2(void) const
 {
-	return f_update_score2;
+	return m_data.score2;
 }
 
-unsigned int GameState::getScore1(void)
+const GCTeamInfo &GameState::getTeamInfo(const unsigned int index) const
 {
-	f_update_score1 = false;
-	return m_score1;
+	return m_data.teams[index];
 }
 
-unsigned int GameState::getScore2(void)
+/*
+ * Malformed packets and duplicated or late ones.
+ */
+unsigned int GameState::getRejectedPackets(void) const
 {
-	f_update_score2 = false;
-	return m_score2;
+	return m_rejected_packets;
 }
 
+unsigned int GameState::getUnsupportedPackets(void) const
+{
+	return m_unsupported_packets;
+}
@@ -1,31 +1,94 @@
 #ifndef GAME_STATE_H
 #define GAME_STATE_H
 
+#include <vector>
+
+/*
+ * Bits of the dirty mask returned by GameState::setData().
+ */
+enum {
+	GS_GAME_STATE     = 0x01,
+	GS_REMAINING_TIME = 0x02,
+	GS_SECONDARY_TIME = 0x04,
+	GS_SCORE1         = 0x08,
+	GS_SCORE2         = 0x10,
+	GS_TEAM_INFO      = 0x20,
+	GS_ALL            = 0x3F,
+};
+
+static const unsigned int GC_MAX_PLAYERS = 11;
+static const unsigned int GC_TEAM_COLOR_BLUE = 0;
+static const unsigned int GC_TEAM_COLOR_RED = 1;
+
+struct GCRobotInfo {
+	unsigned char penalty;
+	unsigned char secs_till_unpenalised;
+	unsigned char yellow_card_count;
+	unsigned char red_card_count;
+};
+
+struct GCTeamInfo {
+	unsigned char team_number;
+	unsigned char team_color;
+	unsigned char score;
+	unsigned char penalty_shot;
+	unsigned short single_shots;
+	unsigned char coach_sequence;
+	GCRobotInfo coach;
+	GCRobotInfo players[GC_MAX_PLAYERS];
+};
+
+struct GameStateData {
+	int game_state;
+	int remaining_time;
+	int secondary_time;
+	unsigned int score1;
+	unsigned int score2;
+	unsigned int version;
+	unsigned int players_per_team;
+	unsigned int first_half;
+	unsigned int kick_off_team;
+	unsigned int secondary_state;
+	GCTeamInfo teams[2]; // in packet order
+};
+
 class GameState
 {
 public:
 	GameState();
 	~GameState();
-	void setData(const char *data, const unsigned int data_len);
-	int getGameState(void);
-	int getRemainingTime(void);
-	int getSecondaryTime(void);
-	bool updatedScore1(void);
-	bool updatedScore2(void);
-	unsigned int getScore1(void);
-	unsigned int getScore2(void);
+	unsigned int setData(const char *data, const unsigned int data_len, const unsigned int source = 0);
+	const GameStateData &getData(void) const;
+	int getGameState(void) const;
+	int getRemainingTime(void) const;
+	int getSecondaryTime(void) const;
+	unsigned int getScore1(void) const;
+	unsigned int getScore2(void) const;
+	const GCTeamInfo &getTeamInfo(const unsigned int index) const;
+	unsigned int getRejectedPackets(void) const;
+	unsigned int getUnsupportedPackets(void) const;
 private:
-	void decodeData(const unsigned char *data);
-	void decodeTeamInfo(const unsigned char *data);
-	void decodeRobotInfo(const unsigned char *data);
-	int m_game_state;
-	int m_remaining_time;
-	int m_secondary_time;
-	unsigned int m_score1;
-	unsigned int m_score2;
-	bool f_update_score1;
-	bool f_update_score2;
+	// packet numbering of one GameController
+	struct PacketSource {
+		unsigned int address;
+		unsigned int packet_number;
+		unsigned int stale_in_row;
+	};
+	struct Decoder {
+		unsigned int version;
+		unsigned int packet_size;
+		unsigned int (GameState::*decode)(const unsigned char *, const unsigned int);
+	};
+	static const Decoder decoders[];
+	static const unsigned int num_decoders;
+	template<class Layout> unsigned int decodePacket(const unsigned char *data, const unsigned int source);
+	template<class Layout> unsigned int decodeTeamInfo(const unsigned char *data, GCTeamInfo &team);
+	bool acceptPacketNumber(const unsigned int packet_number, const unsigned int source);
+	GameStateData m_data;
+	bool f_received;
+	std::vector<PacketSource> m_sources;
+	unsigned int m_rejected_packets;
+	unsigned int m_unsupported_packets;
 };
 
 #endif // GAME_STATE_H
-
@@ -0,0 +1,86 @@
+#ifndef GC_LAYOUT_H
+#define GC_LAYOUT_H
+
+/*
+ * Byte layouts of the supported GameController protocol versions.
+ * Each layout gets its own instantiation of GameState::decodePacket(), so
+ * every offset is a compile-time constant. To support another version,
+ * add a layout and a row in GameState::decoders.
+ *
+ * Versions 12 and 11 of the humanoid league protocol are supported.
+ * Packets of other versions are counted as unsupported and shown in the
+ * performance panel.
+ */
+
+// RoboCupGameControlData version 12 (humanoid league), 640 bytes
+struct GCLayoutV12 {
+	static constexpr unsigned int version = 12;
+	static constexpr unsigned int packet_size = 640;
+	// header
+	static constexpr unsigned int packet_number = 6;
+	static constexpr unsigned int players_per_team = 7;
+	static constexpr unsigned int game_type = 8;
+	static constexpr unsigned int state = 9;
+	static constexpr unsigned int first_half = 10;
+	static constexpr unsigned int kick_off_team = 11;
+	static constexpr unsigned int secondary_state = 12;
+	static constexpr unsigned int secondary_state_info = 13; // 4 bytes
+	static constexpr unsigned int drop_in_team = 17;
+	static constexpr unsigned int drop_in_time = 18;
+	static constexpr unsigned int secs_remaining = 20;
+	static constexpr unsigned int secondary_time = 22;
+	// team info, relative to the start of each team
+	static constexpr unsigned int team_info = 24;
+	static constexpr unsigned int team_info_size = 308;
+	static constexpr unsigned int team_number = 0;
+	static constexpr unsigned int team_color = 1;
+	static constexpr unsigned int score = 2;
+	static constexpr unsigned int penalty_shot = 3;
+	static constexpr unsigned int single_shots = 4;
+	static constexpr unsigned int coach_sequence = 6;
+	static constexpr unsigned int coach_message = 7; // 253 bytes
+	static constexpr unsigned int coach = 260;
+	static constexpr unsigned int players = 264;
+	static constexpr unsigned int max_players = 11;
+	// robot info: penalty, secs_till_unpenalised, yellow cards, red cards
+	static constexpr unsigned int robot_info_size = 4;
+};
+
+// RoboCupGameControlData version 11 (humanoid league), 636 bytes; the
+// same as version 12 without secondary_state_info
+struct GCLayoutV11 {
+	static constexpr unsigned int version = 11;
+	static constexpr unsigned int packet_size = 636;
+	// header
+	static constexpr unsigned int packet_number = 6;
+	static constexpr unsigned int players_per_team = 7;
+	static constexpr unsigned int game_type = 8;
+	static constexpr unsigned int state = 9;
+	static constexpr unsigned int first_half = 10;
+	static constexpr unsigned int kick_off_team = 11;
+	static constexpr unsigned int secondary_state = 12;
+	static constexpr unsigned int drop_in_team = 13;
+	static constexpr unsigned int drop_in_time = 14;
+	static constexpr unsigned int secs_remaining = 16;
+	static constexpr unsigned int secondary_time = 18;
+	// team info, relative to the start of each team
+	static constexpr unsigned int team_info = 20;
+	static constexpr unsigned int team_info_size = 308;
+	static constexpr unsigned int team_number = 0;
+	static constexpr unsigned int team_color = 1;
+	static constexpr unsigned int score = 2;
+	static constexpr unsigned int penalty_shot = 3;
+	static constexpr unsigned int single_shots = 4;
+	static constexpr unsigned int coach_sequence = 6;
+	static constexpr unsigned int coach_message = 7; // 253 bytes
+	static constexpr unsigned int coach = 260;
+	static constexpr unsigned int players = 264;
+	static constexpr unsigned int max_players = 11;
+	// robot info: penalty, secs_till_unpenalised, yellow cards, red cards
+	static constexpr unsigned int robot_info_size = 4;
+};
+
+static_assert(GCLayoutV12::team_info + 2 * GCLayoutV12::team_info_size == GCLayoutV12::packet_size, "version 12 teams must end the packet");
+static_assert(GCLayoutV11::team_info + 2 * GCLayoutV11::team_info_size == GCLayoutV11::packet_size, "version 11 teams must end the packet");
+
+#endif // GC_LAYOUT_H
@@ -1,9 +1,20 @@
+#include <chrono>
+
 #include "gcreceiver.h"
 
-GCReceiver::GCReceiver(int port_num)
+GCReceiver::GCReceiver(int port, const QHostAddress &source) : port_num(port), source_address(source), udpSocket(nullptr), packet_count(0), rejected_count(0), unsupported_count(0), capture(nullptr)
+{
+}
+
+void GCReceiver::setCapture(PacketCapture *packet_capture)
+{
+	capture = packet_capture->addChannel(MAX_DATAGRAM_SIZE, CAPTURE_BATCH);
+}
+
+void GCReceiver::start(void)
 {
 	udpSocket = new QUdpSocket(this);
-	udpSocket->bind(QHostAddress::Any, port_num);
+	udpSocket->bind(QHostAddress::Any, port_num, QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint);
 	connect(udpSocket, SIGNAL(readyRead()), this, SLOT(readPendingDatagrams()));
 }
 
@@ -11,30 +22,68 @@ GCReceiver::~GCReceiver()
 {
 }
 
+unsigned long long GCReceiver::packetCount(void) const
+{
+	return packet_count.load(std::memory_order_relaxed);
+}
+
+/*
+ * Malformed, duplicated and late packets, see GameState::setData().
+ */
+unsigned int GCReceiver::rejectedCount(void) const
+{
+	return rejected_count.load(std::memory_order_relaxed);
+}
+
+/*
+ * Packets of a protocol version without a layout in gc_layout.h.
+ */
+unsigned int GCReceiver::unsupportedCount(void) const
+{
+	return unsupported_count.load(std::memory_order_relaxed);
+}
+
+const LatencyHistogram &GCReceiver::processTime(void) const
+{
+	return process_time;
+}
+
 void GCReceiver::readPendingDatagrams(void)
 {
+	ScopedTimer timer(process_time);
+	unsigned int dirty = 0;
+	const quint32 source = source_address.toIPv4Address();
+	QHostAddress sender;
+	quint16 sender_port = 0;
 	while(udpSocket->hasPendingDatagrams()) {
-		QByteArray datagrams;
-		datagrams.resize(udpSocket->pendingDatagramSize());
-		QHostAddress sender;
-		quint16 senderPort;
-		udpSocket->readDatagram(datagrams.data(), datagrams.size(), &sender, &senderPort);
-		char *p = datagrams.data();
-		char *buf = new char[datagrams.size()];
-		for(size_t i = 0; (i < (size_t)datagrams.size()); i++) {
-			buf[i] = p[i];
-		}
-		gc_data.setData(buf, datagrams.size());
-		emit gameStateChanged(gc_data.getGameState());
-		emit remainingTimeChanged(gc_data.getRemainingTime());
-		emit secondaryTimeChanged(gc_data.getSecondaryTime());
-		if(gc_data.updatedScore1()) {
-			emit scoreChanged1(gc_data.getScore1());
+		// when capturing, receive into the next slot of the capture slab
+		CaptureSlab *capture_slab = capture != nullptr ? capture->slab() : nullptr;
+		char *buffer = capture_slab != nullptr ? reinterpret_cast<char *>(capture_slab->slot(capture_slab->count)) : datagram;
+		const qint64 size = udpSocket->readDatagram(buffer, sizeof(datagram), &sender, &sender_port);
+		if(size < 0)
+			break;
+		if(source != 0 && sender.toIPv4Address() != source)
+			continue;
+		packet_count.fetch_add(1, std::memory_order_relaxed);
+		dirty |= gc_data.setData(buffer, size, sender.toIPv4Address());
+		if(capture_slab != nullptr) {
+			using namespace std::chrono;
+			packet_capture_record_T &record = capture_slab->records[capture_slab->count];
+			record.kind = CAPTURE_GAMECONTROLLER;
+			record.size = size;
+			record.local_port = port_num;
+			record.source_address = sender.toIPv4Address();
+			record.source_port = sender_port;
+			record.reserved = 0;
+			record.time_us = duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+			if(++capture_slab->count == CAPTURE_BATCH)
+				capture->submit();
 		}
-		if(gc_data.updatedScore2()) {
-			emit scoreChanged2(gc_data.getScore2());
-		}
-		delete[] buf;
 	}
+	if(capture != nullptr)
+		capture->submit();
+	rejected_count.store(gc_data.getRejectedPackets(), std::memory_order_relaxed);
+	unsupported_count.store(gc_data.getUnsupportedPackets(), std::memory_order_relaxed);
+	if(dirty)
+		emit stateChanged(dirty, gc_data.getData());
 }
-
@@ -5,26 +5,63 @@
 #include <QUdpSocket>
 #include <QtCore>
 
+#include <atomic>
+
 #include "game_state.h"
+#include "perf_counters.h"
+#include "packet_capture.h"
+
+Q_DECLARE_METATYPE(GameStateData);
 
+/*
+ * Receives GameController packets. Like UdpServer it lives on the network
+ * thread: the socket is created in start() and the change signals reach
+ * the GUI through queued connections.
+ *
+ * Packets that change nothing, and duplicated or late packets, emit no
+ * signal at all. Otherwise one stateChanged() carries the full state and
+ * a GS_* mask of the fields that changed.
+ *
+ * Several receivers may share the GameController port, one per monitored
+ * field. A receiver given a source address ignores packets from any other
+ * host, so each one follows the GameController of its own field.
+ *
+ * With a packet capture, the packets it follows are received straight
+ * into the slabs of a capture channel.
+ */
 class GCReceiver : public QObject
 {
 	Q_OBJECT
 public:
-	GCReceiver(const int);
+	GCReceiver(const int, const QHostAddress & = QHostAddress());
 	~GCReceiver();
+	// before the network thread starts
+	void setCapture(PacketCapture *);
+	// may be read from any thread
+	unsigned long long packetCount(void) const;
+	unsigned int rejectedCount(void) const;
+	unsigned int unsupportedCount(void) const;
+	const LatencyHistogram &processTime(void) const;
+public slots:
+	void start(void);
 private:
+	static const int MAX_DATAGRAM_SIZE = 1024;
+	static const int CAPTURE_BATCH = 16;
+	const int port_num;
+	const QHostAddress source_address;
 	QUdpSocket *udpSocket;
 	GameState gc_data;
+	char datagram[MAX_DATAGRAM_SIZE];
+	std::atomic<unsigned long long> packet_count;
+	// copied from gc_data after every read
+	std::atomic<unsigned int> rejected_count;
+	std::atomic<unsigned int> unsupported_count;
+	LatencyHistogram process_time; // per readPendingDatagrams() call
+	CaptureChannel *capture;
 signals:
-	void gameStateChanged(int);
-	void remainingTimeChanged(int);
-	void secondaryTimeChanged(int);
-	void scoreChanged1(int);
-	void scoreChanged2(int);
+	void stateChanged(unsigned int, GameStateData);
 private slots:
 	void readPendingDatagrams(void);
 };
 
 #endif // GCRECEIVER_H
-
@@ -1,8 +1,8 @@
 #include <iostream>
+#include <algorithm>
 #include <cstring>
 #include <cmath>
 #include <cstdlib>
-#include <fstream>
 #include <string>
 #include <cstring>
 #include <ctime>
@@ -12,49 +12,92 @@
 #include "pos_types.h"
 #include "interface.h"
 
-static inline int distance(const int x1, const int y1, const int x2, const int y2)
-{
-	const int x = x1 - x2;
-	const int y = y1 - y2;
-	return std::sqrt(x * x + y * y);
-}
-
-Interface::Interface(): fLogging(true), fReverse(false), fViewGoalpost(false), fViewRobotInformation(true), fPauseLog(false), fRecording(false), fViewSelfPosConf(true), score_team1(0), score_team2(0), max_robot_num(6), log_speed(1), field_param(FieldParameter()), field_space(1040, 740)
+Interface::Interface(const int field): log_writer(field == 0 ? std::string() : "-field" + std::to_string(field + 1)), robot_sprites(FieldPainter::MARKER_COLORS * HEADING_BUCKETS), sprite_half_size(0), replay_origin_ms(0), shown_gc_packet_count(0), fLogging(true), fReverse(false), fViewGoalpost(false), fViewRobotInformation(true), fPauseLog(false), fRecording(false), fViewSelfPosConf(true), fViewTrails(false), fViewHeatmap(false), fViewPerformance(false), score_team1(0), score_team2(0), log_speed(1), field_index(field), network_group(field == 0 ? QString("network") : QString("field%1").arg(field + 1)), field_param(FieldParameter())
 {
 	qRegisterMetaType<comm_info_T>("comm_info_T");
+	qRegisterMetaType<GameStateData>("GameStateData");
 	setAcceptDrops(true);
 	log_writer.setEnable();
-	positions = std::vector<PositionMarker>(max_robot_num);
 
 	statusBar = new QStatusBar;
 	statusBar->showMessage(QString("GameMonitor: Ready"));
 	setStatusBar(statusBar);
 
-	settings = new QSettings("./config.ini", QSettings::IniFormat);
-	initializeConfig();
-	logo_pos_x = field_param.field_length / 2 + field_param.field_length / 4;
-	logo_pos_y = field_param.border_strip_width / 2;
+	trail_clock.start();
 
-	// Run receive thread
-	const int base_udp_port = settings->value("network/port").toInt();
-	for(int i = 0; i < max_robot_num; i++)
-		th.push_back(new UdpServer(base_udp_port + i));
+	settings = new QSettings("./config.ini", QSettings::IniFormat);
+	initializeConfig(*settings, field_index);
+	settings->sync();
+	config = MonitorConfig::load(*settings);
+	config_file_data = readConfigFile();
+	createFieldGrids();
+	log_writer.setFlushPolicy(config->log_flush_interval_ms, config->log_fsync);
+	log_writer.setBinary(config->log_binary);
+	log_writer.setImageScale(config->field_image_width, config->field_image_height, config->image_scale_x, config->image_scale_y);
+	config_watcher = new QFileSystemWatcher(QStringList(settings->fileName()), this);
+
+	// Receivers live on their own thread so that socket reads never wait
+	// for a repaint. Their signals reach this object as queued calls.
+	// Every monitored field has its own ports, GameController source and
+	// network thread.
+	const int base_udp_port = settings->value(network_group + "/port").toInt();
+	const int udp_port_count = settings->value(network_group + "/port_count").toInt();
+	udp_server = new UdpServer(base_udp_port, udp_port_count);
+	udp_server->setLogWriter(&log_writer);
 
 	constexpr int gc_receive_port = 3838;
-	gc_thread = new GCReceiver(gc_receive_port);
+	const QString gc_address = settings->value(network_group + "/gc_address").toString();
+	gc_thread = new GCReceiver(gc_receive_port, gc_address.isEmpty() ? QHostAddress() : QHostAddress(gc_address));
+
+	if(settings->value("capture/enable").toBool()) {
+		packet_capture.reset(new PacketCapture(field_index == 0 ? std::string() : "-field" + std::to_string(field_index + 1)));
+		udp_server->setCapture(packet_capture.get());
+		gc_thread->setCapture(packet_capture.get());
+		packet_capture->start();
+	}
+
+	network_thread = new QThread(this);
+	network_thread->setObjectName(QString("network-") + network_group);
+	udp_server->moveToThread(network_thread);
+	gc_thread->moveToThread(network_thread);
+	connect(network_thread, SIGNAL(started()), udp_server, SLOT(start()));
+	connect(network_thread, SIGNAL(started()), gc_thread, SLOT(start()));
+
+	render_scheduler = new RenderScheduler(config->render_max_fps, this);
 
 	createWindow();
 	createMenus();
 	connection();
+	network_thread->start();
 
 	updateMapTimerId = startTimer(1000); // timer by 1000msec
 	drawField();
 
-	this->setWindowTitle("Humanoid League Game Monitor");
+	if(field_index == 0)
+		this->setWindowTitle("Humanoid League Game Monitor");
+	else
+		this->setWindowTitle(QString("Humanoid League Game Monitor - Field %1").arg(field_index + 1));
 }
 
 Interface::~Interface()
 {
+	shutdown();
+	delete udp_server;
+	delete gc_thread;
+}
+
+/*
+ * Stop receiving and write out the log and the capture. Connected to
+ * QCoreApplication::aboutToQuit(), so the files are complete even if the
+ * window is never destroyed; the destructor calls it again.
+ */
+void Interface::shutdown(void)
+{
+	network_thread->quit();
+	network_thread->wait();
+	if(packet_capture)
+		packet_capture->stop();
+	log_writer.stop();
 }
 
 void Interface::createMenus(void)
@@ -65,10 +108,13 @@ void Interface::createMenus(void)
 	settingsAction = new QAction(tr("&Size setting"), 0);
 
 	fileMenu->addAction(loadLogFileAction);
+	dumpPerformanceAction = new QAction(tr("&Dump Performance Counters"), 0);
 	fileMenu->addAction(settingsAction);
+	fileMenu->addAction(dumpPerformanceAction);
 
 	connect(loadLogFileAction, SIGNAL(triggered()), this, SLOT(loadLogFile(void)));
 	connect(settingsAction, SIGNAL(triggered()), this, SLOT(openSettingWindow(void)));
+	connect(dumpPerformanceAction, SIGNAL(triggered()), this, SLOT(dumpPerformance(void)));
 
 	viewMenu = menuBar()->addMenu(tr("&View"));
 
@@ -85,40 +131,88 @@ void Interface::createMenus(void)
 	viewMenu->addAction(viewGoalPostAction);
 	viewMenu->addAction(viewRobotInformationAction);
 	viewMenu->addAction(viewSelfPosConfAction);
+	viewTrailsAction = new QAction(tr("View &Trails"), 0);
+	viewTrailsAction->setCheckable(true);
+	viewTrailsAction->setChecked(fViewTrails);
+	viewHeatmapAction = new QAction(tr("View &Heatmap"), 0);
+	viewHeatmapAction->setCheckable(true);
+	viewHeatmapAction->setChecked(fViewHeatmap);
+	viewMenu->addAction(viewTrailsAction);
+	viewMenu->addAction(viewHeatmapAction);
+	viewPerformanceAction = new QAction(tr("View &Performance Overlay"), 0);
+	viewPerformanceAction->setCheckable(true);
+	viewPerformanceAction->setChecked(fViewPerformance);
+	viewMenu->addAction(viewPerformanceAction);
 	viewMenu->addSeparator();
 
 	connect(viewGoalPostAction, SIGNAL(toggled(bool)), this, SLOT(viewGoalpost(bool)));
 	connect(viewRobotInformationAction, SIGNAL(toggled(bool)), this, SLOT(viewRobotInformation(bool)));
 	connect(viewSelfPosConfAction, SIGNAL(toggled(bool)), this, SLOT(viewSelfPosConf(bool)));
+	connect(viewTrailsAction, SIGNAL(toggled(bool)), this, SLOT(viewTrails(bool)));
+	connect(viewHeatmapAction, SIGNAL(toggled(bool)), this, SLOT(viewHeatmap(bool)));
+	connect(viewPerformanceAction, SIGNAL(toggled(bool)), this, SLOT(viewPerformance(bool)));
 }
 
-void Interface::initializeConfig(void)
+/*
+ * Write the default of every missing setting to config.ini. Static, so the
+ * headless exporter gets the same defaults without a window.
+ */
+void Interface::initializeConfig(QSettings &settings, const int field_index)
 {
+	const FieldParameterInt field_param = FieldParameterInt(FieldParameter());
+	const QString network_group = field_index == 0 ? QString("network") : QString("field%1").arg(field_index + 1);
 	const int field_w = field_param.border_strip_width * 2 + field_param.field_length;
 	const int field_h = field_param.border_strip_width * 2 + field_param.field_width;
 	// field figure size (pixel size of drawing area)
-	settings->setValue("field_image/width" , settings->value("field_image/width", field_w));
-	settings->setValue("field_image/height", settings->value("field_image/height", field_h));
+	settings.setValue("field_image/width" , settings.value("field_image/width", field_w));
+	settings.setValue("field_image/height", settings.value("field_image/height", field_h));
 	// field size is 9000x6000 millimeters (See rule book of 2018)
 	// In this program, field dimensions are defined in centimeters.
-	settings->setValue("field_size/x", settings->value("field_size/x", field_param.field_length * 10));
-	settings->setValue("field_size/y", settings->value("field_size/y", field_param.field_width * 10));
-	settings->setValue("field_size/line_width", settings->value("field_size/line_width", 5));
+	settings.setValue("field_size/x", settings.value("field_size/x", field_param.field_length * 10));
+	settings.setValue("field_size/y", settings.value("field_size/y", field_param.field_width * 10));
+	settings.setValue("field_size/line_width", settings.value("field_size/line_width", 5));
 	// marker configurations
-	settings->setValue("marker/pen_size", settings->value("marker/pen_size", 3));
-	settings->setValue("marker/robot_size", settings->value("marker/robot_size", 15));
-	settings->setValue("marker/ball_size", settings->value("marker/ball_size", 6));
-	settings->setValue("marker/goal_pole_size", settings->value("marker/goal_pole_size", 5));
-	settings->setValue("marker/direction_marker_length", settings->value("marker/direction_marker_length", 20));
-	settings->setValue("marker/font_size", settings->value("marker/font_size", 24));
-	settings->setValue("marker/font_offset_x", settings->value("marker/font_offset_x", 8));
-	settings->setValue("marker/font_offset_y", settings->value("marker/font_offset_y", 24));
-	settings->setValue("marker/time_up_limit", settings->value("marker/time_up_limit", 5));
+	settings.setValue("marker/pen_size", settings.value("marker/pen_size", 3));
+	settings.setValue("marker/robot_size", settings.value("marker/robot_size", 15));
+	settings.setValue("marker/ball_size", settings.value("marker/ball_size", 6));
+	settings.setValue("marker/goal_pole_size", settings.value("marker/goal_pole_size", 5));
+	settings.setValue("marker/direction_marker_length", settings.value("marker/direction_marker_length", 20));
+	settings.setValue("marker/font_size", settings.value("marker/font_size", 24));
+	settings.setValue("marker/font_offset_x", settings.value("marker/font_offset_x", 8));
+	settings.setValue("marker/font_offset_y", settings.value("marker/font_offset_y", 24));
+	settings.setValue("marker/time_up_limit", settings.value("marker/time_up_limit", 5));
 	// size setting
-	settings->setValue("size/font_size", settings->value("size/font_size", 48));
-	settings->setValue("size/display_minimum_height", settings->value("size/display_minimum_height", 50));
+	settings.setValue("size/font_size", settings.value("size/font_size", 48));
+	settings.setValue("size/display_minimum_height", settings.value("size/display_minimum_height", 50));
+	// upper limit of map repaints per second, 0 repaints on every change
+	settings.setValue("render/max_fps", settings.value("render/max_fps", 30));
+	// length of robot and ball trails
+	settings.setValue("trail/seconds", settings.value("trail/seconds", 10));
+	// the game log is written out this often, and also synced to disk if
+	// fsync is true
+	settings.setValue("log/flush_interval_ms", settings.value("log/flush_interval_ms", 200));
+	settings.setValue("log/fsync", settings.value("log/fsync", false));
+	// "text" or "binary", the format of new log files
+	settings.setValue("log/format", settings.value("log/format", QString("text")));
+	// also write every received datagram to a .cap file for gm_capreplay;
+	// read at startup only
+	settings.setValue("capture/enable", settings.value("capture/enable", false));
 	// using UDP communication port offset
-	settings->setValue("network/port", settings->value("network/port", 7110));
+	settings.setValue("network/port", settings.value("network/port", 7110));
+	// number of consecutive ports listened to, robots may use any of them
+	settings.setValue("network/port_count", settings.value("network/port_count", 6));
+	// GameController host to follow, empty accepts every GameController
+	settings.setValue("network/gc_address", settings.value("network/gc_address", QString()));
+	// number of fields monitored in this process, field N > 1 takes its
+	// network settings from the fieldN group
+	settings.setValue("fields/count", settings.value("fields/count", 1));
+	if(field_index > 0) {
+		const int port_count = settings.value("network/port_count").toInt();
+		const int default_port = settings.value("network/port").toInt() + field_index * port_count;
+		settings.setValue(network_group + "/port", settings.value(network_group + "/port", default_port));
+		settings.setValue(network_group + "/port_count", settings.value(network_group + "/port_count", port_count));
+		settings.setValue(network_group + "/gc_address", settings.value(network_group + "/gc_address", QString()));
+	}
 }
 
 void Interface::createWindow(void)
@@ -132,16 +226,18 @@ void Interface::createWindow(void)
 	label_secondary_time = new QLabel("Secondary time");
 	label_game_state = new QLabel("Game state");
 	label_score = new QLabel("Score (Blue - Red)");
+	label_link_quality = new QLabel;
+	label_render_stats = new QLabel;
 	label_game_state_display = new QLabel("Initial");
 	QFont font = label_game_state_display->font();
-	const int font_size = settings->value("size/font_size").toInt();
+	const int font_size = config->font_size;
 	font.setPointSize(font_size);
 	label_game_state_display->setFont(font);
 	log_slider = new QSlider(Qt::Horizontal);
 	log_slider->setRange(0, 0);
 	time_display = new QLCDNumber();
 	time_display->display(QString("10:00"));
-	const int display_minimum_height = settings->value("size/display_minimum_height").toInt();
+	const int display_minimum_height = config->display_minimum_height;
 	time_display->setMinimumHeight(display_minimum_height);
 	secondary_time_display = new QLCDNumber;
 	secondary_time_display->display(QString(" 0:00"));
@@ -167,6 +263,8 @@ void Interface::createWindow(void)
 	checkLayout->addWidget(label_score);
 	checkLayout->addWidget(score_display);
 	checkLayout->addWidget(reverse);
+	checkLayout->addWidget(label_link_quality);
+	checkLayout->addWidget(label_render_stats);
 
 	logLayout->addWidget(log_step);
 	logLayout->addWidget(log_slider);
@@ -191,59 +289,57 @@ void Interface::createWindow(void)
 	setCentralWidget(window);
 }
 
+/*
+ * All layers are rendered at the size the label shows them, field
+ * coordinates are mapped to it by scene_transform.
+ */
 void Interface::drawField()
 {
-	const int field_w = settings->value("field_image/width").toInt();
-	const int field_h = settings->value("field_image/height").toInt();
-	origin_map = QPixmap(field_w, field_h);
+	const int field_w = config->field_image_width;
+	const int field_h = config->field_image_height;
+	image->setSceneSize(QSize(field_w, field_h));
+	layer_size = image->targetSize();
+	if(layer_size.isEmpty())
+		layer_size = QSize(field_w, field_h);
+	scene_transform = QTransform::fromScale(static_cast<qreal>(layer_size.width()) / field_w, static_cast<qreal>(layer_size.height()) / field_h);
+	// sprites are rendered at device resolution as well
+	robot_sprites.clear();
+	sprite_half_size = 0;
+	origin_map = QPixmap(layer_size);
 	origin_map.fill(Qt::black);
 	QPainter p;
 	p.begin(&origin_map);
-	const int line_width = settings->value("field_size/line_width").toInt();
-	QPen pen(Qt::white, line_width);
-	p.setPen(pen);
-	// draw field lines, center circle and penalty marks
-	const int field_left = field_param.border_strip_width;
-	const int field_right = field_param.border_strip_width + field_param.field_length;
-	const int field_top = field_param.border_strip_width;
-	const int field_bottom = field_param.border_strip_width + field_param.field_width;
-	p.drawLine(field_left, field_top, field_right, field_top);
-	p.drawLine(field_left, field_top, field_left, field_bottom);
-	p.drawLine(field_right, field_bottom, field_left, field_bottom);
-	p.drawLine(field_right, field_top, field_right, field_bottom);
-	const int center_line_pos = field_left + field_param.field_length / 2;
-	p.drawLine(center_line_pos, field_top, center_line_pos, field_bottom);
-	const int left_goal_x = field_left - field_param.goal_depth;
-	const int right_goal_x = field_right + field_param.goal_depth;
-	const int goal_top = field_param.field_width / 2 - field_param.goal_width / 2 + field_top;
-	const int goal_bottom = goal_top + field_param.goal_width;
-	p.drawLine(left_goal_x, goal_top, left_goal_x, goal_bottom);
-	p.drawLine(left_goal_x, goal_top, field_left, goal_top);
-	p.drawLine(left_goal_x, goal_bottom, field_left, goal_bottom);
-	p.drawLine(right_goal_x, goal_top, right_goal_x, goal_bottom);
-	p.drawLine(right_goal_x, goal_top, field_right, goal_top);
-	p.drawLine(right_goal_x, goal_bottom, field_right, goal_bottom);
-	const int left_goal_area_x = field_left + field_param.goal_area_length;
-	const int right_goal_area_x = field_right - field_param.goal_area_length;
-	const int goal_area_top = field_param.field_width / 2 - field_param.goal_area_width / 2 + field_top;
-	const int goal_area_bottom = goal_area_top + field_param.goal_area_width;
-	p.drawLine(left_goal_area_x, goal_area_top, left_goal_area_x, goal_area_bottom);
-	p.drawLine(left_goal_area_x, goal_area_top, field_left, goal_area_top);
-	p.drawLine(left_goal_area_x, goal_area_bottom, field_left, goal_area_bottom);
-	p.drawLine(right_goal_area_x, goal_area_top, right_goal_area_x, goal_area_bottom);
-	p.drawLine(right_goal_area_x, goal_area_top, field_right, goal_area_top);
-	p.drawLine(right_goal_area_x, goal_area_bottom, field_right, goal_area_bottom);
-	const int center_of_field_y = field_top + field_param.field_width / 2;
-	const int &dia = field_param.center_circle_diameter;
-	const int radius = dia / 2; // radius of center circle
-	p.drawEllipse(center_line_pos - radius, center_of_field_y - radius, dia, dia);
-	p.drawPoint(field_left + field_param.penalty_mark_distance, center_of_field_y);
-	p.drawPoint(field_right - field_param.penalty_mark_distance, center_of_field_y);
+	p.setRenderHint(QPainter::Antialiasing);
+	p.setTransform(scene_transform);
+	fieldPainter().drawField(p, field_param);
 	p.end();
-	map = origin_map;
+	updateBackground();
+	map = background;
 	image->setPixmap(map);
 }
 
+/*
+ * The field and the team marker only change with the field settings and
+ * the field direction, so they are kept as one pre-composited layer.
+ */
+void Interface::updateBackground(void)
+{
+	background = origin_map;
+	QPainter paint(&background);
+	paint.setRenderHint(QPainter::Antialiasing);
+	paint.setTransform(scene_transform);
+	fieldPainter().drawTeamMarker(paint, field_param);
+}
+
+/*
+ * Fields in hidden tabs skip drawing, bring the map up to date when the
+ * tab is shown again.
+ */
+void Interface::showEvent(QShowEvent *)
+{
+	render_scheduler->requestRender();
+}
+
 void Interface::dragEnterEvent(QDragEnterEvent *e)
 {
 	if(e->mimeData()->hasFormat("text/uri-list")) {
@@ -258,69 +354,71 @@ void Interface::dropEvent(QDropEvent *e)
 
 void Interface::connection(void)
 {
-	connect(th[0], SIGNAL(receiveData(struct comm_info_T)), this, SLOT(decodeData1(struct comm_info_T)));
-	connect(th[1], SIGNAL(receiveData(struct comm_info_T)), this, SLOT(decodeData2(struct comm_info_T)));
-	connect(th[2], SIGNAL(receiveData(struct comm_info_T)), this, SLOT(decodeData3(struct comm_info_T)));
-	connect(th[3], SIGNAL(receiveData(struct comm_info_T)), this, SLOT(decodeData4(struct comm_info_T)));
-	connect(th[4], SIGNAL(receiveData(struct comm_info_T)), this, SLOT(decodeData5(struct comm_info_T)));
-	connect(th[5], SIGNAL(receiveData(struct comm_info_T)), this, SLOT(decodeData6(struct comm_info_T)));
+	connect(udp_server, SIGNAL(dataArrived()), this, SLOT(processReceivedData()));
+	connect(render_scheduler, SIGNAL(render()), this, SLOT(updateMap()));
+	connect(image, SIGNAL(resized()), render_scheduler, SLOT(requestRender()));
+	connect(config_watcher, SIGNAL(fileChanged(const QString &)), this, SLOT(configFileChanged()));
 	connect(reverse, SIGNAL(stateChanged(int)), this, SLOT(reverseField(int)));
 	connect(log1Button, SIGNAL(clicked(void)), this, SLOT(logSpeed1(void)));
 	connect(log2Button, SIGNAL(clicked(void)), this, SLOT(logSpeed2(void)));
 	connect(log5Button, SIGNAL(clicked(void)), this, SLOT(logSpeed5(void)));
 	connect(log_slider, SIGNAL(sliderPressed(void)), this, SLOT(pausePlayingLog(void)));
 	connect(log_slider, SIGNAL(sliderReleased(void)), this, SLOT(changeLogPosition(void)));
-	connect(gc_thread, SIGNAL(remainingTimeChanged(int)), this, SLOT(setRemainingTime(int)));
-	connect(gc_thread, SIGNAL(secondaryTimeChanged(int)), this, SLOT(setSecondaryTime(int)));
-	connect(gc_thread, SIGNAL(scoreChanged1(int)), this, SLOT(setScore1(int)));
-	connect(gc_thread, SIGNAL(scoreChanged2(int)), this, SLOT(setScore2(int)));
+	connect(gc_thread, SIGNAL(stateChanged(unsigned int, GameStateData)), this, SLOT(updateGameState(unsigned int, GameStateData)));
+	connect(QCoreApplication::instance(), SIGNAL(aboutToQuit()), this, SLOT(shutdown()));
 }
 
-void Interface::decodeData1(struct comm_info_T comm_info)
+void Interface::processReceivedData(void)
 {
-	decodeUdp(comm_info, 0);
-	statusBar->showMessage(QString("Receive data from Robot 1"));
-}
-
-void Interface::decodeData2(struct comm_info_T comm_info)
-{
-	decodeUdp(comm_info, 1);
-	statusBar->showMessage(QString("Receive data from Robot 2"));
-}
-
-void Interface::decodeData3(struct comm_info_T comm_info)
-{
-	decodeUdp(comm_info, 2);
-	statusBar->showMessage(QString("Receive data from Robot 3"));
-}
-
-void Interface::decodeData4(struct comm_info_T comm_info)
-{
-	decodeUdp(comm_info, 3);
-	statusBar->showMessage(QString("Receive data from Robot 4"));
+	// acknowledge first, so that packets arriving from now on notify again
+	udp_server->acknowledge();
+	int last_robot = -1;
+	struct comm_info_T comm_info;
+	const int slot_count = udp_server->slotCount();
+	for(int i = 0; i < slot_count; i++) {
+		const int num = robotSlot(udp_server->robotKey(i));
+		if(udp_server->takeLatest(i, comm_info)) {
+			decodeUdp(comm_info, num);
+			last_robot = num;
+		}
+		udp_server->takeLinkQuality(i, link_stats[num]);
+	}
+	udp_server->takeProbeStats(probe_stats);
+	if(last_robot < 0)
+		return;
+	render_scheduler->requestRender();
+	statusBar->showMessage(QString("Receive data from ") + robotName(robots.keyOf(last_robot)));
 }
 
-void Interface::decodeData5(struct comm_info_T comm_info)
+/*
+ * Slot of a robot in positions and link_stats, registering it on first
+ * contact.
+ */
+int Interface::robotSlot(const unsigned char key)
 {
-	decodeUdp(comm_info, 4);
-	statusBar->showMessage(QString("Receive data from Robot 5"));
+	const int slot = robots.slotOf(key);
+	if(slot >= static_cast<int>(positions.size())) {
+		positions.resize(slot + 1);
+		link_stats.resize(slot + 1);
+		positions[slot].colornum = RobotRegistry::colorOf(key);
+		positions[slot].robot_id = RobotRegistry::idOf(key);
+	}
+	return slot;
 }
 
-void Interface::decodeData6(struct comm_info_T comm_info)
+QString Interface::robotName(const unsigned char key)
 {
-	decodeUdp(comm_info, 5);
-	statusBar->showMessage(QString("Receive data from Robot 6"));
+	QString color_str;
+	if(RobotRegistry::colorOf(key) == MAGENTA)
+		color_str = QString("MAGENTA");
+	else
+		color_str = QString("CYAN");
+	return color_str + QString(" ") + QString::number(RobotRegistry::idOf(key));
 }
 
 void Interface::decodeUdp(struct comm_info_T comm_info, int num)
 {
-	int color, id;
-
-	// MAGENTA, CYAN
-	color = (int)(comm_info.id & 0x80) >> 7;
-	id    = (int)(comm_info.id & 0x7F);
-	positions[num].colornum = color;
-
+	ScopedTimer decode_timer(decode_time);
 	// record time of receive data
 	time_t timer;
 	struct tm *local_time;
@@ -328,14 +426,6 @@ void Interface::decodeUdp(struct comm_info_T comm_info, int num)
 	local_time = localtime(&timer);
 	positions[num].lastReceiveTime = *local_time;
 
-	// ID and Color
-	QString color_str;
-	if(color == MAGENTA)
-		color_str = QString("MAGENTA");
-	else
-		color_str = QString("CYAN");
-	color_str = color_str + QString(" ") + QString::number(id);
-	//robot_data->name->setText(color_str);
 	// Self-position confidence
 	positions[num].self_conf = comm_info.cf_own;
 	// Ball position confidence
@@ -364,38 +454,65 @@ void Interface::decodeUdp(struct comm_info_T comm_info, int num)
 	positions[num].enable_goal_pole[0] = false;
 	positions[num].enable_goal_pole[1] = false;
 	int goal_pole_index = 0;
+	CommInfoObjects objs;
+	decodeCommInfoObjects(comm_info.object, objs);
 	for(int i = 0; i < MAX_COMM_INFO_OBJ; i++) {
-		Object obj;
-		bool exist = getCommInfoObject(comm_info.object[i], &obj);
-		if(!exist) continue;
-		if(obj.type == NONE) continue;
-		if(obj.type == SELF_POS) {
-			positions[num].pos = globalPosToImagePos(obj.pos);
+		const int type = objs.type[i];
+		if(type == NONE) continue;
+		if(type == SELF_POS) {
+			positions[num].pos = globalPosToImagePos(objs.pos(i));
 			positions[num].enable_pos  = true;
 		}
-		if(obj.type == BALL) {
-			positions[num].ball = globalPosToImagePos(obj.pos);
+		if(type == BALL) {
+			positions[num].ball = globalPosToImagePos(objs.pos(i));
 			positions[num].enable_ball = true;
 		}
-		if(obj.type == GOAL_POLE) {
+		if(type == GOAL_POLE) {
 			if(goal_pole_index >= 2) continue;
-			positions[num].goal_pole[goal_pole_index] = globalPosToImagePos(obj.pos);
+			positions[num].goal_pole[goal_pole_index] = globalPosToImagePos(objs.pos(i));
 			positions[num].enable_goal_pole[goal_pole_index] = true;
 			goal_pole_index++;
 		}
 	}
-	updateMap();
 	// Voltage
 	const double voltage = (comm_info.voltage << 3) / 100.0;
 	positions[num].voltage = voltage;
 	positions[num].temperature = comm_info.temperature;
-	log_writer.setEnable(false);
-	log_writer.write(num + 1, color_str.toStdString().c_str(), (int)comm_info.fps, (double)voltage,
-		(int)positions[num].pos.x, (int)positions[num].pos.y, (float)positions[num].pos.th,
-		(int)positions[num].ball.x, (int)positions[num].ball.y,
-		(int)positions[num].goal_pole[0].x, (int)positions[num].goal_pole[0].y,
-		(int)positions[num].goal_pole[1].x, (int)positions[num].goal_pole[1].y,
-		(const char *)comm_info.command, (int)comm_info.cf_own, (int)comm_info.cf_ball);
+	recordTrails(num);
+}
+
+/*
+ * Append the current positions of a robot to its trails and the heatmap.
+ * The heatmap is kept in the unreversed view, where CYAN robots are
+ * mirrored, and mirrored as a whole when the field is reversed.
+ */
+void Interface::recordTrails(const int num)
+{
+	const PositionMarker &marker = positions[num];
+	const long long now = trail_clock.elapsed();
+	if(marker.enable_pos) {
+		positions[num].trail.add(marker.pos.x, marker.pos.y, now);
+		if(marker.colornum == 1)
+			heatmap->add(config->field_image_width - marker.pos.x, config->field_image_height - marker.pos.y);
+		else
+			heatmap->add(marker.pos.x, marker.pos.y);
+	}
+	if(marker.enable_ball)
+		positions[num].ball_trail.add(marker.ball.x, marker.ball.y, now);
+}
+
+void Interface::updateGameState(unsigned int dirty, GameStateData data)
+{
+	if(dirty & GS_GAME_STATE)
+		setGameState(data.game_state);
+	if(dirty & GS_REMAINING_TIME)
+		setRemainingTime(data.remaining_time);
+	if(dirty & GS_SECONDARY_TIME)
+		setSecondaryTime(data.secondary_time);
+	if(dirty & GS_SCORE1)
+		setScore1(data.score1);
+	if(dirty & GS_SCORE2)
+		setScore2(data.score2);
 }
 
 void Interface::setGameState(int game_state)
@@ -491,214 +608,87 @@ void Interface::setScore2(int score2)
 Pos Interface::globalPosToImagePos(Pos gpos)
 {
 	Pos ret_pos;
-	const int field_image_width = settings->value("field_image/width").toInt();
-	const int field_image_height = settings->value("field_image/height").toInt();
-	const int field_size_x = settings->value("field_size/x").toInt();
-	const int field_size_y = settings->value("field_size/y").toInt();
+	const int field_image_width = config->field_image_width;
+	const int field_image_height = config->field_image_height;
 	ret_pos.x =
-		field_image_width - (int)((double)gpos.x * ((double)field_image_width / (double)field_size_x) + ((double)field_image_width / 2));
+		field_image_width - (int)((double)gpos.x * config->image_scale_x + ((double)field_image_width / 2));
 	ret_pos.y =
-		                    (int)((double)gpos.y * ((double)field_image_height / (double)field_size_y) + ((double)field_image_height / 2));
+		                    (int)((double)gpos.y * config->image_scale_y + ((double)field_image_height / 2));
 	ret_pos.th = -gpos.th + M_PI;
 	return ret_pos;
 }
 
-void Interface::setParamFromFile(std::vector<std::string> lines)
+/*
+ * Start the timer for the entry after log_count and move on to it. The
+ * entries are due at their log time on a replay clock, so that timer
+ * delays do not add up and entries keep their recorded spacing. The clock
+ * restarts at the current entry after a pause, a jump or a speed change.
+ */
+void Interface::scheduleNextLogEntry(void)
 {
-	if(lines[0].find("Game Monitor") == std::string::npos) {
-		// version: 1.0
-		setParamFromFileV1(lines);
-	} else {
-		// version: 2.0
-		lines.erase(lines.begin()); // erase first element, it's version signature
-		setParamFromFileV2(lines);
+	const long long current_ms = logEntryTimeMs(log_count);
+	const long long next_ms = logEntryTimeMs(log_count + 1);
+	log_count++;
+	// also restart when the log time went back
+	if(!replay_clock.isValid() || current_ms < replay_origin_ms || next_ms < current_ms) {
+		replay_clock.start();
+		replay_origin_ms = current_ms;
 	}
+	const long long due = (next_ms - replay_origin_ms) / log_speed - replay_clock.elapsed();
+	QTimer::singleShot(static_cast<int>(std::max(0LL, due)), Qt::PreciseTimer, this, SLOT(updateLog()));
 }
 
-void Interface::setParamFromFileV1(std::vector<std::string> lines)
+void Interface::updateLog(void)
 {
-	for(auto line : lines) {
-		LogDataRobotComm buf;
-		QString qstr = QString(line.c_str());
-		QStringList list = qstr.split(QChar(','));
-
-		int size = list.size();
-		if(size == 17) {
-			strcpy(buf.time_str, list.at(0).toStdString().c_str());
-			buf.id = list.at(1).toInt();
-			strcpy(buf.color_str, list.at(2).toStdString().c_str());
-			buf.fps = list.at(3).toInt();
-			buf.voltage = list.at(4).toDouble();
-			buf.x = list.at(5).toInt();
-			buf.y = list.at(6).toInt();
-			buf.theta = list.at(7).toDouble();
-			buf.ball_x = list.at(8).toInt();
-			buf.ball_y = list.at(9).toInt();
-			buf.goal_pole_x1 = list.at(10).toInt();
-			buf.goal_pole_y1 = list.at(11).toInt();
-			buf.goal_pole_x2 = list.at(12).toInt();
-			buf.goal_pole_y2 = list.at(13).toInt();
-			buf.cf_own = list.at(14).toInt();
-			buf.cf_ball = list.at(15).toInt();
-			strcpy(buf.msg, list.at(16).toStdString().c_str());
-			LogData ldata;
-			ldata.type = LOG_TYPE_ROBOTINFO;
-			ldata.robot_comm = buf;
-			strcpy(ldata.time_str, list.at(0).toStdString().c_str());
-			log_data.push_back(ldata);
-		} else if(size == 2) {
-			LogData ldata;
-			ldata.type = LOG_TYPE_REMAININGTIME;
-			strcpy(ldata.time_str, list.at(0).toStdString().c_str());
-			ldata.remaining_time = list.at(1).toInt();
-			log_data.push_back(ldata);
-		} else if(size == 3) {
-			LogData ldata;
-			strcpy(ldata.time_str, list.at(0).toStdString().c_str());
-			int team_no = list.at(1).toInt();
-			if(team_no == 0) {
-				ldata.type = LOG_TYPE_SCORE1;
-				ldata.score1 = list.at(2).toInt();
-			} else if(team_no == 1) {
-				ldata.type = LOG_TYPE_SCORE2;
-				ldata.score2 = list.at(2).toInt();
-			} else {
-				continue;
-			}
-			log_data.push_back(ldata);
-		}
-	}
-	if(log_data.size() == 0) return;
-	log_count = 0;
-	setData(log_data[log_count]);
-	QString before = QString(log_data[log_count++].time_str);
-	QString after = QString(log_data[log_count].time_str);
-	int interval = getInterval(before, after) / log_speed;
-	if(interval < 0) interval = 0;
-	QTimer::singleShot(interval, this, SLOT(updateLog()));
+	if(fPauseLog)
+		return;
+	setData(logEntry(log_count));
+	if(log_count + 1 >= logEntryCount()) return;
+	QString step, str_log_count, str_log_total;
+	str_log_count.setNum(log_count+1);
+	str_log_total.setNum(logEntryCount());
+	step += str_log_count + " / " + str_log_total;
+	log_slider->setValue(log_count);
+	log_step->setText(step);
+	scheduleNextLogEntry();
 }
 
-void Interface::setParamFromFileV2(std::vector<std::string> lines)
+size_t Interface::logEntryCount(void) const
 {
-	for(auto line : lines) {
-		LogDataRobotComm buf;
-		QString qstr = QString(line.c_str());
-		QStringList list = qstr.split(QChar(','));
-
-		int size = list.size();
-		if(size == 1) continue;
-		if(list[0] == "RobotInfo" && size == 18) {
-			strcpy(buf.time_str, list.at(1).toStdString().c_str());
-			buf.id = list.at(2).toInt();
-			strcpy(buf.color_str, list.at(3).toStdString().c_str());
-			buf.fps = list.at(4).toInt();
-			buf.voltage = list.at(5).toDouble();
-			buf.x = list.at(6).toInt();
-			buf.y = list.at(7).toInt();
-			buf.theta = list.at(8).toDouble();
-			buf.ball_x = list.at(9).toInt();
-			buf.ball_y = list.at(10).toInt();
-			buf.goal_pole_x1 = list.at(11).toInt();
-			buf.goal_pole_y1 = list.at(12).toInt();
-			buf.goal_pole_x2 = list.at(13).toInt();
-			buf.goal_pole_y2 = list.at(14).toInt();
-			buf.cf_own = list.at(15).toInt();
-			buf.cf_ball = list.at(16).toInt();
-			strcpy(buf.msg, list.at(17).toStdString().c_str());
-			LogData ldata;
-			ldata.type = LOG_TYPE_ROBOTINFO;
-			ldata.robot_comm = buf;
-			strcpy(ldata.time_str, list.at(1).toStdString().c_str());
-			log_data.push_back(ldata);
-		} else if(list[0] == "Score" && size == 4) {
-			LogData ldata;
-			strcpy(ldata.time_str, list.at(1).toStdString().c_str());
-			int team_no = list.at(2).toInt();
-			if(team_no == 0) {
-				ldata.type = LOG_TYPE_SCORE1;
-				ldata.score1 = list.at(3).toInt();
-			} else if(team_no == 1) {
-				ldata.type = LOG_TYPE_SCORE2;
-				ldata.score2 = list.at(3).toInt();
-			} else {
-				continue;
-			}
-			log_data.push_back(ldata);
-		} else if(list[0] == "RemainingTime" && size == 3) {
-			LogData ldata;
-			ldata.type = LOG_TYPE_REMAININGTIME;
-			strcpy(ldata.time_str, list.at(1).toStdString().c_str());
-			ldata.remaining_time = list.at(2).toInt();
-			log_data.push_back(ldata);
-		} else if(list[0] == "SecondaryTime" && size == 3) {
-			LogData ldata;
-			ldata.type = LOG_TYPE_SECONDARYTIME;
-			strcpy(ldata.time_str, list.at(1).toStdString().c_str());
-			ldata.secondary_time = list.at(2).toInt();
-			log_data.push_back(ldata);
-		} else if(list[0] == "GameState" && size == 3) {
-			LogData ldata;
-			ldata.type = LOG_TYPE_GAMESTATE;
-			strcpy(ldata.time_str, list.at(1).toStdString().c_str());
-			ldata.game_state = list.at(2).toInt();
-			log_data.push_back(ldata);
-		} else {
-			continue;
-		}
-	}
-	if(log_data.size() == 0) return;
-	log_count = 0;
-	setData(log_data[log_count]);
-	QString before = QString(log_data[log_count++].time_str);
-	QString after = QString(log_data[log_count].time_str);
-	int interval = getInterval(before, after) / log_speed;
-	if(interval < 0) interval = 0;
-	QTimer::singleShot(interval, this, SLOT(updateLog()));
+	return binary_log.size() > 0 ? binary_log_records.size() : log_data.size();
 }
 
-int Interface::getInterval(QString before, QString after)
+LogData Interface::logEntry(const size_t index) const
 {
-	QStringList list_before = before.split(QChar(':'));
-	QStringList list_after = after.split(QChar(':'));
-	if(list_before.size() != 3 || list_after.size() != 3) {
-		std::cerr << "Found invalid log data (ignored)" << std::endl;
-		std::cerr << before.toStdString() << ", " << after.toStdString() << std::endl;
-		return 0;
-	}
-	int h = list_after.at(0).toInt() - list_before.at(0).toInt();
-	int m = list_after.at(1).toInt() - list_before.at(1).toInt();
-	int s = list_after.at(2).toInt() - list_before.at(2).toInt();
-	return ((h * 60 + m) * 60 + s) * 1000;
+	if(binary_log.size() == 0)
+		return log_data[index];
+	LogData ldata;
+	binaryLogData(binary_log, binary_log_records[index], ldata);
+	return ldata;
 }
 
-void Interface::updateLog(void)
+/*
+ * Log time of an entry in milliseconds. Binary records are indexed by
+ * their own time, text times were parsed once when the log was loaded.
+ */
+long long Interface::logEntryTimeMs(const size_t index) const
 {
-	if(fPauseLog)
-		return;
-	setData(log_data[log_count]);
-	if(log_count + 1 >= log_data.size()) return;
-	QString step, str_log_count, str_log_total;
-	str_log_count.setNum(log_count+1);
-	str_log_total.setNum(log_data.size());
-	step += str_log_count + " / " + str_log_total;
-	log_slider->setValue(log_count);
-	log_step->setText(step);
-	QString before = QString(log_data[log_count++].time_str);
-	QString after = QString(log_data[log_count].time_str);
-	int interval = getInterval(before, after) / log_speed;
-	if(interval < 0) interval = 0;
-	QTimer::singleShot(interval, this, SLOT(updateLog()));
+	if(binary_log.size() == 0)
+		return log_times_ms[index];
+	return binary_log.record(binary_log_records[index]).time_us / 1000;
 }
 
 void Interface::pausePlayingLog(void)
 {
 	fPauseLog = true;
+	replay_clock.invalidate();
 }
 
 void Interface::changeLogPosition(void)
 {
 	fPauseLog = false;
 	log_count = log_slider->value();
+	replay_clock.invalidate();
 	updateLog();
 }
 
@@ -722,344 +712,279 @@ void Interface::setData(LogData log_data)
 	} else if(log_data.type == LOG_TYPE_ROBOTINFO) {
 		LogDataRobotComm data = log_data.robot_comm;
 
-		int num = data.id - 1;
-		// Role and message
-		char *msg = data.msg;
-		if(strstr((const char *)msg, "Attacker")) {
-			// Red
-			strcpy(positions[num].color, "red");
-		} else if(strstr((const char *)msg, "Neutral")) {
-			// Green
-			strcpy(positions[num].color, "green");
-		} else if(strstr((const char *)msg, "Defender")) {
-			// Blue
-			strcpy(positions[num].color, "blue");
-		} else if(strstr((const char *)msg, "Keeper")) {
-			// Orange
-			strcpy(positions[num].color, "orange");
-		} else {
-			// Black
-			strcpy(positions[num].color, "black");
-		}
-		positions[num].message = std::string(msg);
+		// older logs carry the port number in the id field, which is unique
+		// per robot as well
+		const int color = strncmp(data.color_str, "CYAN", 4) == 0 ? CYAN : MAGENTA;
+		const int num = robotSlot(RobotRegistry::makeKey(color, data.id));
+		positions[num].setFromLog(data);
 
 		time_t timer;
 		timer = time(NULL);
 		positions[num].lastReceiveTime = *localtime(&timer);
-		positions[num].enable_pos  = true;
-		positions[num].enable_ball = true;
-		positions[num].enable_goal_pole[0] = true;
-		positions[num].enable_goal_pole[1] = true;
-
-		positions[num].pos.x = data.x;
-		positions[num].pos.y = data.y;
-		positions[num].pos.th = data.theta;
-		positions[num].ball.x = data.ball_x;
-		positions[num].ball.y = data.ball_y;
-		positions[num].goal_pole[0].x = data.goal_pole_x1;
-		positions[num].goal_pole[0].y = data.goal_pole_y1;
-		positions[num].goal_pole[1].x = data.goal_pole_x2;
-		positions[num].goal_pole[1].y = data.goal_pole_y2;
-		positions[num].self_conf = data.cf_own;
-		positions[num].ball_conf = data.cf_ball;
-		positions[num].voltage = data.voltage;
-		positions[num].temperature = data.temperature;
-
-		updateMap();
+		recordTrails(num);
+
+		render_scheduler->requestRender();
 	}
 }
 
-void Interface::drawTeamMarker(QPainter &painter, const int pos_x, const int pos_y)
+/*
+ * Robot bodies are drawn from pre-rendered sprites, one for every
+ * combination of color and heading (in HEADING_BUCKETS steps), so the
+ * cache holds all of them. A sprite is only rendered when that
+ * combination appears for the first time. The number and the confidence
+ * bar are drawn by FieldPainter on top.
+ */
+void Interface::drawRobotSprite(QPainter &painter, const int self_x, const int self_y, const double theta, const QColor marker_color)
 {
-	painter.setPen(QPen(Qt::white));
-	QFont font = painter.font();
-	constexpr int team_marker_font_size = 32;
-	font.setPointSize(team_marker_font_size);
-	painter.setFont(font);
-	painter.drawText(pos_x, pos_y, QString("CIT Brains"));
+	constexpr double two_pi = 2.0 * M_PI;
+	const int heading = ((static_cast<int>(std::lround(theta / two_pi * HEADING_BUCKETS)) % HEADING_BUCKETS) + HEADING_BUCKETS) % HEADING_BUCKETS;
+	const quint64 key = static_cast<quint64>(marker_color.rgb() & 0xFFFFFF) << 32 | static_cast<quint64>(heading);
+	QPixmap *sprite = robot_sprites.object(key);
+	if(sprite == nullptr) {
+		if(sprite_half_size == 0)
+			sprite_half_size = std::max(config->marker_robot_size, config->marker_direction_marker_length) + config->marker_pen_size + 2;
+		sprite = new QPixmap(static_cast<int>(std::ceil(sprite_half_size * 2 * scene_transform.m11())), static_cast<int>(std::ceil(sprite_half_size * 2 * scene_transform.m22())));
+		sprite->fill(Qt::transparent);
+		QPainter sprite_painter(sprite);
+		sprite_painter.setRenderHint(QPainter::Antialiasing);
+		sprite_painter.setTransform(QTransform::fromScale(scene_transform.m11(), scene_transform.m22()));
+		fieldPainter().drawRobotBody(sprite_painter, sprite_half_size, sprite_half_size, heading * two_pi / HEADING_BUCKETS, marker_color);
+		sprite_painter.end();
+		robot_sprites.insert(key, sprite);
+	}
+	// draw in device pixels, so the sprite is not resampled
+	const QPointF center = scene_transform.map(QPointF(self_x, self_y));
+	painter.save();
+	painter.resetTransform();
+	painter.drawPixmap(qRound(center.x() - sprite_half_size * scene_transform.m11()), qRound(center.y() - sprite_half_size * scene_transform.m22()), *sprite);
+	painter.restore();
 }
 
-void Interface::drawRobotMarker(QPainter &painter, const int self_x, const int self_y, const double theta, const int robot_id, const QColor marker_color, const double self_conf)
+void Interface::updateMap(void)
 {
-	// set marker color according to robot role
-	const int robot_pen_size = settings->value("marker/pen_size").toInt();
-	painter.setPen(QPen(marker_color, robot_pen_size));
-
-	// draw robot marker
-	painter.drawPoint(self_x, self_y);
-	const int robot_marker_radius = settings->value("marker/robot_size").toInt();
-	painter.drawEllipse(self_x - robot_marker_radius, self_y - robot_marker_radius, robot_marker_radius * 2, robot_marker_radius * 2);
-	const int robot_marker_direction_length = settings->value("marker/direction_marker_length").toInt();
-	const int direction_x = self_x + robot_marker_direction_length * std::cos(theta);
-	const int direction_y = self_y + robot_marker_direction_length * std::sin(theta);
-	painter.drawLine(self_x, self_y, direction_x, direction_y);
-
-	// draw robot number
-	QString id_str = QString::number(robot_id);
-	const int font_offset_x = settings->value("marker/font_offset_x").toInt();
-	const int font_offset_y = settings->value("marker/font_offset_y").toInt();
-	painter.drawText(QPoint(self_x - font_offset_x, self_y - font_offset_y), id_str);
-
-	// draw self position confidence
-	if(fViewSelfPosConf) {
-		constexpr int bar_width = 80;
-		constexpr int bar_height = 12;
-		const int bar_left = self_x - bar_width / 2;
-		const int bar_top = self_y + 35;
-		QPainterPath path_frame, path_conf;
-		path_frame.addRect(bar_left - 2, bar_top - 2, bar_width + 4, bar_height + 4);
-		painter.fillPath(path_frame, Qt::white);
-		const auto conf = self_conf;
-		const int conf_width = static_cast<int>(conf / 100.0 * bar_width);
-		QPen pen = painter.pen();
-		constexpr int pen_size = 1;
-		painter.setPen(QPen(QColor(0, 0, 0), pen_size));
-		painter.setRenderHint(QPainter::NonCosmeticDefaultPen);
-		painter.drawRect(bar_left, bar_top, bar_width, bar_height);
-		painter.setRenderHint(QPainter::Antialiasing);
-		painter.setPen(pen);
-		path_conf.addRect(bar_left, bar_top, conf_width, bar_height);
-		QColor color;
-		// change color by self-position confidence (red, orange or green)
-		if(conf < 30) {
-			color = Qt::red;
-		} else if(conf < 70) {
-			color = QColor(0xFF, 0xA5, 0x00); // orange
-		} else {
-			color = Qt::green;
+	time_t timer;
+	struct tm *local_time;
+	timer = time(NULL);
+	local_time = localtime(&timer);
+
+	// nothing is painted for a hidden tab or a minimized window, so such
+	// frames are not timed or counted either
+	if(!isVisible() || QWidget::window()->isMinimized())
+		return;
+	ScopedTimer render_timer(render_time);
+
+	// the label was resized, render the layers at the new size
+	if(image->targetSize() != layer_size)
+		drawField();
+
+	const int time_limit = config->marker_time_up_limit;
+	for(size_t i = 0; i < positions.size(); i++) {
+		const int elapsed = (local_time->tm_min - positions[i].lastReceiveTime.tm_min) * 60 + (local_time->tm_sec - positions[i].lastReceiveTime.tm_sec);
+		if(positions[i].enable_pos && elapsed > time_limit) {
+			positions[i].enable_pos = false;
+			positions[i].enable_ball = false;
 		}
-		painter.fillPath(path_conf, color);
 	}
-}
-
-void Interface::drawRobotInformation(QPainter &painter, const int self_x, const int self_y, const double theta, const int robot_id, const QColor marker_color, const double self_conf, const double ball_conf, const std::string msg, const double voltage, const double temperature)
-{
-	constexpr int frame_width = 200;
-	constexpr int frame_height = 80;
-	int frame_x, frame_y;
-	bool success = field_space.getEmptySpace(frame_x, frame_y, frame_width, frame_height, self_x, self_y);
-	if(!success) {
-		frame_x = self_x;
-		frame_y = self_y + 120;
+	const FieldPainter field_painter = fieldPainter();
+	{
+		ScopedTimer field_space_timer(field_space_time);
+		field_painter.placeInformation(positions, *field_space);
 	}
-	const int frame_left = frame_x - frame_width / 2;
-	const int frame_top = frame_y - frame_height / 2;
-	constexpr int pen_size = 3;
-	painter.setPen(QPen(Qt::red, pen_size));
-	painter.drawLine(frame_x, frame_y, self_x, self_y);
-	QPainterPath path_frame;
-	path_frame.addRect(frame_left, frame_top, frame_width, frame_height);
-	const QColor frame_color(0xE6, 0xE6, 0xFA); // lavender
-	painter.fillPath(path_frame, frame_color);
-	const QColor frame_border_color(0x80, 0x00, 0x80); // purple
-	painter.setPen(QPen(frame_border_color, pen_size));
-	painter.drawRect(frame_left, frame_top, frame_width, frame_height);
-
-	painter.setPen(QPen(Qt::red));
-	QFont font = painter.font();
-	constexpr int font_size = 20;
-	font.setPointSize(font_size);
-	painter.setFont(font);
-	constexpr int font_offset_x = 12;
-	constexpr int font_offset_y = 20 + font_size / 2;
-	std::string s(msg); // message without role name
-	s.erase(s.begin(), s.begin() + s.find(" "));
-	painter.drawText(frame_left + font_offset_x, frame_top + font_offset_y, QString(s.c_str()));
-	QString voltage_str = QString::number(voltage) + "[V] / " + QString::number(temperature) + "[C]";
-	constexpr int font_offset_2y = 20 + font_size / 2 + font_size + 15;
-	painter.drawText(frame_left + font_offset_x, frame_top + font_offset_2y, voltage_str);
-
-	constexpr int bar_width = 8;
-	constexpr int bar_height = frame_height - 4;
-	QColor bar_color(0xFF, 0xA5, 0x00); // orange
-	painter.setPen(QPen(bar_color, 2));
-	painter.drawRect(frame_left + 2, frame_top + 2, bar_width, bar_height - 2);
-	QPainterPath path_bar;
-	const int bar_left = frame_left + 2;
-	const int bar_fill_height = static_cast<int>(ball_conf / 100.0 * bar_height);
-	const int bar_fill_top = frame_top + 2 + (bar_height - bar_fill_height);
-	path_bar.addRect(bar_left, bar_fill_top, bar_width, bar_fill_height);
-	painter.fillPath(path_bar, bar_color);
-}
 
-void Interface::drawBallMarker(QPainter &painter, const int ball_x, const int ball_y, const int owner_id, const int distance_ball_and_robot, const int self_x, const int self_y)
-{
-	// draw ball position as orange
-	const int ball_marker_size = settings->value("marker/ball_size").toInt();
-	QColor orange(0xFF, 0xA5, 0x00);
-	painter.setPen(QPen(orange, ball_marker_size));
-	painter.drawPoint(ball_x, ball_y);
-	constexpr int ball_near_threshold = 50; // Do not draw robot number if the ball is near the robot.
-	if(distance_ball_and_robot > ball_near_threshold) {
-		QString id_str = QString::number(owner_id);
-		const int font_offset_x = settings->value("marker/font_offset_x").toInt();
-		const int font_offset_y = settings->value("marker/font_offset_y").toInt();
-		painter.drawText(QPoint(ball_x - font_offset_x, ball_y - font_offset_y), id_str);
+	// Create new image for erase previous position marker
+	map = background;
+	QPainter paint(&map);
+	paint.setRenderHint(QPainter::Antialiasing);
+	paint.setTransform(scene_transform);
+
+	if(fViewHeatmap) {
+		const int field_w = config->field_image_width;
+		const int field_h = config->field_image_height;
+		paint.save();
+		if(fReverse) {
+			paint.translate(field_w, field_h);
+			paint.scale(-1, -1);
+		}
+		paint.drawImage(QRect(0, 0, field_w, field_h), heatmap->image());
+		paint.restore();
 	}
-	painter.setPen(QPen(orange, 1));
-	painter.drawLine(self_x, self_y, ball_x, ball_y);
+	const long long trail_since = trail_clock.elapsed() - config->trail_seconds * 1000LL;
+	using namespace std::placeholders;
+	field_painter.drawMarkers(paint, positions, trail_since, std::bind(&Interface::drawRobotSprite, this, _1, _2, _3, _4, _5));
+	if(fViewPerformance)
+		drawPerformanceOverlay(paint);
+	image->setPixmap(map);
 }
 
-void Interface::drawGoalPostMarker(QPainter &painter, const int goal_x, const int goal_y, const int self_x, const int self_y)
+FieldPainter Interface::fieldPainter(void)
 {
-	QColor goal_post_color = Qt::red;
-	const int goal_post_marker_size = settings->value("marker/goal_pole_size").toInt();
-	painter.setPen(QPen(goal_post_color, goal_post_marker_size));
-	painter.drawPoint(goal_x, goal_y);
-	painter.setPen(QPen(goal_post_color, 1));
-	painter.drawLine(self_x, self_y, goal_x, goal_y);
+	FieldView view;
+	view.reverse = fReverse;
+	view.goal_post = fViewGoalpost;
+	view.robot_information = fViewRobotInformation;
+	view.self_pos_conf = fViewSelfPosConf;
+	view.trails = fViewTrails;
+	return FieldPainter(config, view, &text_cache);
 }
 
-void Interface::drawHighlightCircle(QPainter &painter, const int center_x, const int center_y)
+void Interface::timerEvent(QTimerEvent *e)
 {
-	QColor circle_color = Qt::red;
-	QPen pen = painter.pen();
-	const int pen_size = 2;
-	int circle_size;
-	painter.setPen(QPen(circle_color, pen_size));
-	circle_size = 200;
-	painter.drawEllipse(center_x - (circle_size / 2), center_y - (circle_size / 2), circle_size, circle_size);
-	painter.setPen(QPen(circle_color, pen_size));
-	circle_size = 100;
-	painter.drawEllipse(center_x - (circle_size / 2), center_y - (circle_size / 2), circle_size, circle_size);
-	painter.setPen(pen);
+	if(e->timerId() == updateMapTimerId) {
+		render_scheduler->requestRender();
+		updateLinkQuality();
+		updatePerformance();
+	}
 }
 
-void Interface::updateMap(void)
+void Interface::updateLinkQuality(void)
 {
-	time_t timer;
-	struct tm *local_time;
-	timer = time(NULL);
-	local_time = localtime(&timer);
-
-	// Create new image for erase previous position marker
-	field_space.clear();
-	map = origin_map;
-	QPainter paint(&map);
-	paint.setRenderHint(QPainter::Antialiasing);
-	drawTeamMarker(paint, logo_pos_x, logo_pos_y);
-
-	QFont font = paint.font();
-	const int font_size = settings->value("marker/font_size").toInt();
-	font.setPointSize(font_size);
-	paint.setFont(font);
-
-	const int field_w = settings->value("field_image/width").toInt();
-	const int field_h = settings->value("field_image/height").toInt();
-	for(int i = 0; i < max_robot_num; i++) {
-		if(positions[i].enable_pos) {
-			bool flag_reverse = false;
-			if((positions[i].colornum == 0 && fReverse) ||
-					(positions[i].colornum == 1 && !fReverse)) {
-				flag_reverse = true;
-			}
-			int self_x = positions[i].pos.x;
-			int self_y = positions[i].pos.y;
-			int ball_x = positions[i].ball.x;
-			int ball_y = positions[i].ball.y;
-			if(flag_reverse) {
-				self_x = field_w - self_x;
-				self_y = field_h - self_y;
-				ball_x = field_w - ball_x;
-				ball_y = field_h - ball_y;
-			}
-			field_space.setObjectPos(self_x, self_y, 200, 200);
-			field_space.setObjectPos(ball_x, ball_y, 50, 50);
-			const int time_limit = settings->value("marker/time_up_limit").toInt();
-			const int elapsed = (local_time->tm_min - positions[i].lastReceiveTime.tm_min) * 60 + (local_time->tm_sec - positions[i].lastReceiveTime.tm_sec);
-			if(elapsed > time_limit) {
-				positions[i].enable_pos = false;
-				positions[i].enable_ball = false;
-				continue;
-			}
-		}
+	QString text("Link quality (pkt/s, jitter, longest gap, drops)");
+	for(size_t i = 0; i < link_stats.size(); i++) {
+		const LinkQuality &quality = link_stats[i];
+		if(quality.packetCount() == 0)
+			continue;
+		const QString name = robotName(robots.keyOf(i));
+		text += QString("\n%1: %2/s, %3 ms, %4 ms, %5")
+			.arg(name)
+			.arg(quality.packetsPerSecond(), 0, 'f', 1)
+			.arg(quality.jitterMs(), 0, 'f', 1)
+			.arg(quality.longestGapMs(), 0, 'f', 0)
+			.arg(quality.socketDrops());
+		log_writer.writeLinkQuality(positions[i].robot_id, name.toStdString().c_str(), quality.packetsPerSecond(), quality.jitterMs(), quality.longestGapMs(), quality.socketDrops());
 	}
-	for(int i = 0; i < max_robot_num; i++) {
-		if(positions[i].enable_pos) {
-			int self_x = positions[i].pos.x;
-			int self_y = positions[i].pos.y;
-			double theta = positions[i].pos.th;
-			bool flag_reverse = false;
-			if((positions[i].colornum == 0 && fReverse) ||
-					(positions[i].colornum == 1 && !fReverse)) {
-				flag_reverse = true;
-			}
-			if(flag_reverse) {
-				self_x = field_w - self_x;
-				self_y = field_h - self_y;
-				theta = theta + M_PI;
-			}
-			const int robot_id = i + 1;
-			const QColor color = getColor(positions[i].color);
-			if(fViewRobotInformation)
-				drawRobotInformation(paint, self_x, self_y, theta, robot_id, color, positions[i].self_conf, positions[i].ball_conf, positions[i].message, positions[i].voltage, positions[i].temperature);
-			drawRobotMarker(paint, self_x, self_y, theta, robot_id, color, positions[i].self_conf);
-
-			if(positions[i].enable_ball && positions[i].ball_conf > 0) {
-				int ball_x = positions[i].ball.x;
-				int ball_y = positions[i].ball.y;
-				if(flag_reverse) {
-					ball_x = field_w - ball_x;
-					ball_y = field_h - ball_y;
-				}
-				const int distance_ball_and_robot = distance(ball_x, ball_y, self_x, self_y);
-				const int owner_id = i + 1;
-				drawBallMarker(paint, ball_x, ball_y, owner_id, distance_ball_and_robot, self_x, self_y);
-			}
-			// draw goal posts
-			if(fViewGoalpost) {
-				for(int j = 0; j < 2; j++) {
-					if(positions[i].enable_goal_pole[j]) {
-						int goal_pole_x = positions[i].goal_pole[j].x;
-						int goal_pole_y = positions[i].goal_pole[j].y;
-						bool flag_reverse = false;
-						if(flag_reverse) {
-							goal_pole_x = field_w - goal_pole_x;
-							goal_pole_y = field_h - goal_pole_y;
-						}
-						drawGoalPostMarker(paint, goal_pole_x, goal_pole_y, self_x, self_y);
-					}
-				}
-			}
-		}
+	// packets from gm_trafficgen carry a probe for end-to-end measurement
+	if(probe_stats.packetCount() > 0) {
+		text += QString("\nProbe: %1 received, %2 lost (%3 %), latency %4 / %5 ms")
+			.arg(probe_stats.packetCount())
+			.arg(probe_stats.lostCount())
+			.arg(probe_stats.lossRate() * 100.0, 0, 'f', 2)
+			.arg(probe_stats.meanLatencyMs(), 0, 'f', 2)
+			.arg(probe_stats.maxLatencyMs(), 0, 'f', 2);
 	}
-	image->setPixmap(map);
+	label_link_quality->setText(text);
 }
 
-QColor Interface::getColor(const char *color_name)
+/*
+ * Refresh the performance panel once a second. Percentiles and rates
+ * cover the second since the last refresh.
+ */
+void Interface::updatePerformance(void)
 {
-	if(!strcmp(color_name, "red")) {
-		return QColor(0xFF, 0x8E, 0x8E);
-	} else if(!strcmp(color_name, "black")) {
-		return QColor(0x00, 0x00, 0x00);
-	} else if(!strcmp(color_name, "green")) {
-		return QColor(0x8E, 0xFF, 0x8E);
-	} else if(!strcmp(color_name, "blue")) {
-		return QColor(0x8E, 0x8E, 0xFF);
-	} else if(!strcmp(color_name, "orange")) {
-		return QColor(0xFF, 0xA5, 0xA0);
-	} else {
-		return QColor(0x00, 0x00, 0x00);
+	// frames actually drawn, not frames the scheduler asked for
+	const unsigned long long render_count = render_time.count();
+	const unsigned long long gc_packet_count = gc_thread->packetCount();
+	const LatencyHistogram &gc_time = gc_thread->processTime();
+	const LatencyHistogram &log_write_time = log_writer.writeTime();
+	QString text("Performance (p50 / p99)");
+	text += QString("\nRender: %1 / %2 ms, %3 repaints/s, %4 avoided")
+		.arg(render_time.percentileUs(0.5, &shown_render_time) / 1000.0, 0, 'f', 2)
+		.arg(render_time.percentileUs(0.99, &shown_render_time) / 1000.0, 0, 'f', 2)
+		.arg(render_count - shown_render_time.count())
+		.arg(render_scheduler->avoidedCount());
+	text += QString("\nInformation layout: %1 / %2 ms")
+		.arg(field_space_time.percentileUs(0.5, &shown_field_space_time) / 1000.0, 0, 'f', 2)
+		.arg(field_space_time.percentileUs(0.99, &shown_field_space_time) / 1000.0, 0, 'f', 2);
+	text += QString("\nRobot decode: %1 / %2 us, %3 datagrams rejected")
+		.arg(decode_time.percentileUs(0.5, &shown_decode_time), 0, 'f', 0)
+		.arg(decode_time.percentileUs(0.99, &shown_decode_time), 0, 'f', 0)
+		.arg(udp_server->rejectedCount());
+	text += QString("\nGameController: %1 packets/s, %2 / %3 us, %4 rejected, %5 unsupported version")
+		.arg(gc_packet_count - shown_gc_packet_count)
+		.arg(gc_time.percentileUs(0.5, &shown_gc_time), 0, 'f', 0)
+		.arg(gc_time.percentileUs(0.99, &shown_gc_time), 0, 'f', 0)
+		.arg(gc_thread->rejectedCount())
+		.arg(gc_thread->unsupportedCount());
+	for(size_t i = 0; i < link_stats.size(); i++) {
+		if(link_stats[i].packetCount() == 0)
+			continue;
+		text += QString("\n%1: %2 packets/s")
+			.arg(robotName(robots.keyOf(i)))
+			.arg(link_stats[i].packetsPerSecond(), 0, 'f', 1);
 	}
+	text += QString("\nLog queue: %1 packets (%2 dropped), %3 records (max %4, %5 dropped)")
+		.arg(log_writer.packetQueueDepth())
+		.arg(log_writer.droppedPacketCount())
+		.arg(log_writer.queueDepth())
+		.arg(log_writer.maxQueueDepth())
+		.arg(log_writer.droppedCount());
+	text += QString("\nLog batch write: %1 / %2 us")
+		.arg(log_write_time.percentileUs(0.5, &shown_log_write_time), 0, 'f', 0)
+		.arg(log_write_time.percentileUs(0.99, &shown_log_write_time), 0, 'f', 0);
+	if(packet_capture)
+		text += QString("\nCapture: %1 packets, %2 dropped")
+			.arg(packet_capture->capturedCount())
+			.arg(packet_capture->droppedCount());
+	performance_text = text;
+	label_render_stats->setText(performance_text);
+
+	shown_render_time.copyFrom(render_time);
+	shown_decode_time.copyFrom(decode_time);
+	shown_field_space_time.copyFrom(field_space_time);
+	shown_gc_time.copyFrom(gc_time);
+	shown_log_write_time.copyFrom(log_write_time);
+	shown_gc_packet_count = gc_packet_count;
 }
 
-void Interface::timerEvent(QTimerEvent *e)
+void Interface::drawPerformanceOverlay(QPainter &painter)
 {
-	if(e->timerId() == updateMapTimerId) {
-		updateMap();
+	const QStringList lines = performance_text.split(QChar('\n'));
+	painter.save();
+	painter.resetTransform();
+	QFont font = painter.font();
+	font.setPointSize(10);
+	painter.setFont(font);
+	const int line_height = QFontMetrics(font).height();
+	painter.fillRect(QRect(0, 0, 420, line_height * lines.size() + 8), QColor(0, 0, 0, 160));
+	painter.setPen(QPen(Qt::white));
+	for(int i = 0; i < lines.size(); i++)
+		text_cache.drawText(painter, 6, 4 + line_height * i + QFontMetrics(font).ascent(), lines.at(i));
+	painter.restore();
+}
+
+/*
+ * Write all counters since the start, with the full histograms, to
+ * log/perf-<date>.txt for offline comparison.
+ */
+void Interface::dumpPerformance(void)
+{
+	time_t timer = time(NULL);
+	struct tm *local_time = localtime(&timer);
+	const std::string suffix = field_index == 0 ? std::string() : "-field" + std::to_string(field_index + 1);
+	char filename[1024];
+	sprintf(filename, "log/perf-%d-%d-%d-%d-%d-%d%s.txt", local_time->tm_year + 1900, local_time->tm_mon + 1, local_time->tm_mday, local_time->tm_hour, local_time->tm_min, local_time->tm_sec, suffix.c_str());
+	FILE *fp = fopen(filename, "w");
+	if(fp == NULL) {
+		std::cerr << "cannot open " << filename << std::endl;
+		return;
 	}
+	fprintf(fp, "%s\n", performance_text.toStdString().c_str());
+	fprintf(fp, "repaints,%llu\n", render_time.count());
+	fprintf(fp, "scheduled_frames,%llu\n", render_scheduler->renderCount());
+	fprintf(fp, "avoided_repaints,%llu\n", render_scheduler->avoidedCount());
+	fprintf(fp, "gc_packets,%llu\n", gc_thread->packetCount());
+	fprintf(fp, "gc_rejected_packets,%u\n", gc_thread->rejectedCount());
+	fprintf(fp, "gc_unsupported_packets,%u\n", gc_thread->unsupportedCount());
+	fprintf(fp, "robot_rejected_datagrams,%u\n", udp_server->rejectedCount());
+	fprintf(fp, "log_queue_dropped_packets,%llu\n", log_writer.droppedPacketCount());
+	fprintf(fp, "# histogram,count,total_us,bucket_lower_us:count...\n");
+	render_time.dump(fp, "render");
+	field_space_time.dump(fp, "information_layout");
+	decode_time.dump(fp, "robot_decode");
+	gc_thread->processTime().dump(fp, "gc_process");
+	log_writer.writeTime().dump(fp, "log_write");
+	fclose(fp);
+	statusBar->showMessage(QString("Performance counters written to ") + filename);
 }
 
 void Interface::reverseField(int state)
 {
 	if(state == Qt::Checked) {
 		fReverse = true;
-		logo_pos_x = field_param.field_length / 2 - field_param.field_length / 4;
 	} else {
 		fReverse = false;
-		logo_pos_x = field_param.field_length / 2 + field_param.field_length / 4;
 	}
-	updateMap();
+	updateBackground();
+	render_scheduler->requestRender();
 }
 
 void Interface::viewGoalpost(bool checked)
@@ -1069,7 +994,7 @@ void Interface::viewGoalpost(bool checked)
 	} else {
 		fViewGoalpost = false;
 	}
-	updateMap();
+	render_scheduler->requestRender();
 }
 
 void Interface::viewRobotInformation(bool checked)
@@ -1079,7 +1004,25 @@ void Interface::viewRobotInformation(bool checked)
 	} else {
 		fViewRobotInformation = false;
 	}
-	updateMap();
+	render_scheduler->requestRender();
+}
+
+void Interface::viewTrails(bool checked)
+{
+	fViewTrails = checked;
+	render_scheduler->requestRender();
+}
+
+void Interface::viewHeatmap(bool checked)
+{
+	fViewHeatmap = checked;
+	render_scheduler->requestRender();
+}
+
+void Interface::viewPerformance(bool checked)
+{
+	fViewPerformance = checked;
+	render_scheduler->requestRender();
 }
 
 void Interface::viewSelfPosConf(bool checked)
@@ -1089,31 +1032,52 @@ void Interface::viewSelfPosConf(bool checked)
 	} else {
 		fViewSelfPosConf = false;
 	}
-	updateMap();
+	render_scheduler->requestRender();
 }
 
 void Interface::loadLogFile(void)
 {
-	QString fileName = QFileDialog::getOpenFileName(this, "log file", "./log", "*.log");
-	std::ifstream ifs(fileName.toStdString());
-	if(ifs.fail()) {
-		std::cerr << "file open error" << std::endl;
-		return;
-	}
-	std::string line;
-	std::vector<std::string> lines;
-	while(getline(ifs, line)) {
-		lines.push_back(line);
+	QString fileName = QFileDialog::getOpenFileName(this, "log file", "./log", "Game logs (*.log *.bin *.logz)");
+	const std::string file_name = fileName.toStdString();
+	log_data.clear();
+	log_times_ms.clear();
+	binary_log.close();
+	binary_log_records.clear();
+	if(isBinaryLog(file_name)) {
+		if(!binary_log.open(fileName))
+			return;
+		for(size_t i = 0; i < binary_log.size(); i++) {
+			if(isBinaryLogEntry(binary_log.record(i)))
+				binary_log_records.push_back(i);
+		}
+		if(binary_log_records.empty())
+			binary_log.close();
+	} else {
+		if(!readLogFile(file_name, log_data))
+			return;
+		logTimesMs(log_data, log_times_ms);
 	}
-	log_slider->setMaximum(lines.size()-1);
+	if(logEntryCount() == 0)
+		return;
+	log_slider->setMaximum(logEntryCount() - 1);
 	log_writer.setEnable(false);
+	for(size_t i = 0; i < positions.size(); i++) {
+		positions[i].trail.clear();
+		positions[i].ball_trail.clear();
+	}
+	heatmap->clear();
 	statusBar->showMessage(QString("Playing game from log"));
-	setParamFromFile(lines);
+	log_count = 0;
+	setData(logEntry(log_count));
+	if(logEntryCount() == 1) return;
+	replay_clock.invalidate();
+	scheduleNextLogEntry();
 }
 
 void Interface::logSpeed1(void)
 {
 	log_speed = 1;
+	replay_clock.invalidate();
 	log1Button->setEnabled(false);
 	log2Button->setEnabled(true);
 	log5Button->setEnabled(true);
@@ -1122,6 +1086,7 @@ void Interface::logSpeed1(void)
 void Interface::logSpeed2(void)
 {
 	log_speed = 2;
+	replay_clock.invalidate();
 	log1Button->setEnabled(true);
 	log2Button->setEnabled(false);
 	log5Button->setEnabled(true);
@@ -1130,6 +1095,7 @@ void Interface::logSpeed2(void)
 void Interface::logSpeed5(void)
 {
 	log_speed = 5;
+	replay_clock.invalidate();
 	log1Button->setEnabled(true);
 	log2Button->setEnabled(true);
 	log5Button->setEnabled(false);
@@ -1141,6 +1107,7 @@ void Interface::gameStateFontSizeChanged(int value)
 	font.setPointSize(value);
 	label_game_state_display->setFont(font);
 	settings->setValue("size/font_size", value);
+	reloadConfig();
 }
 
 void Interface::displaySizeChanged(int value)
@@ -1149,14 +1116,75 @@ void Interface::displaySizeChanged(int value)
 	secondary_time_display->setMinimumHeight(value);
 	score_display->setMinimumHeight(value);
 	settings->setValue("size/display_minimum_height", value);
+	reloadConfig();
+}
+
+/*
+ * Publish a new configuration snapshot after config.ini or the setting
+ * dialog changed it. Only the GUI thread replaces the snapshot, other
+ * threads have to read it with std::atomic_load().
+ */
+void Interface::reloadConfig(void)
+{
+	settings->sync();
+	config_file_data = readConfigFile();
+	const std::shared_ptr<const MonitorConfig> old_config = config;
+	std::atomic_store(&config, MonitorConfig::load(*settings));
+	robot_sprites.clear();
+	sprite_half_size = 0;
+	render_scheduler->setMaxFps(config->render_max_fps);
+	log_writer.setFlushPolicy(config->log_flush_interval_ms, config->log_fsync);
+	log_writer.setBinary(config->log_binary);
+	log_writer.setImageScale(config->field_image_width, config->field_image_height, config->image_scale_x, config->image_scale_y);
+	if(config->field_image_width != old_config->field_image_width ||
+			config->field_image_height != old_config->field_image_height)
+		createFieldGrids();
+	if(config->field_image_width != old_config->field_image_width ||
+			config->field_image_height != old_config->field_image_height ||
+			config->field_line_width != old_config->field_line_width)
+		drawField();
+	render_scheduler->requestRender();
+}
+
+/*
+ * The heatmap and the information box grid cover the field image, so
+ * they are made again when its size changes. The heatmap starts empty.
+ */
+void Interface::createFieldGrids(void)
+{
+	const int field_w = config->field_image_width;
+	const int field_h = config->field_image_height;
+	heatmap.reset(new OccupancyHeatmap(field_w, field_h, 10));
+	field_space.reset(new FieldSpaceManager(field_w, field_h, std::max(1, field_w / 20), std::max(1, field_h / 20)));
+}
+
+/*
+ * The watcher also reports our own writes, which reloadConfig() has
+ * loaded already; only reload when the file differs from that.
+ */
+void Interface::configFileChanged(void)
+{
+	// editors that replace the file make the watcher forget it
+	if(!config_watcher->files().contains(settings->fileName()))
+		config_watcher->addPath(settings->fileName());
+	if(readConfigFile() != config_file_data)
+		reloadConfig();
+}
+
+QByteArray Interface::readConfigFile(void) const
+{
+	QFile file(settings->fileName());
+	if(!file.open(QIODevice::ReadOnly))
+		return QByteArray();
+	return file.readAll();
 }
 
 void Interface::openSettingWindow(void)
 {
 	statusBar->showMessage(QString("setting"));
 	SettingDialog dialog(this);
-	const int font_size = settings->value("size/font_size").toInt();
-	const int display_minimum_height = settings->value("size/display_minimum_height").toInt();
+	const int font_size = config->font_size;
+	const int display_minimum_height = config->display_minimum_height;
 	dialog.setDefaultParameters(font_size, display_minimum_height);
 	connect(&dialog, SIGNAL(fontSizeChanged(int)), this, SLOT(gameStateFontSizeChanged(int)));
 	connect(&dialog, SIGNAL(displaySizeChanged(int)), this, SLOT(displaySizeChanged(int)));
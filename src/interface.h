@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <string>
+#include <memory>
 
 #include <QtGui>
 #include <QtCore>
@@ -30,14 +31,29 @@
 #include <QStatusBar>
 #include <QAction>
 #include <QMenuBar>
+#include <QThread>
+#include <QFileSystemWatcher>
+#include <QCache>
 
 #include "udp_thread.h"
 #include "log_writer.h"
+#include "log_reader.h"
+#include "binary_log.h"
 #include "pos_types.h"
 #include "aspect_ratio_pixmap_label.h"
 #include "gcreceiver.h"
 #include "field_space_manager.h"
+#include "field_painter.h"
 #include "setting_dialog.h"
+#include "link_quality.h"
+#include "robot_registry.h"
+#include "traffic_probe.h"
+#include "render_scheduler.h"
+#include "monitor_config.h"
+#include "trail.h"
+#include "occupancy_heatmap.h"
+#include "perf_counters.h"
+#include "packet_capture.h"
 
 static constexpr int STATE_IMPOSSIBLE = -1;
 static constexpr int STATE_INITIAL = 0;
@@ -46,142 +62,17 @@ static constexpr int STATE_SET = 2;
 static constexpr int STATE_PLAYING = 3;
 static constexpr int STATE_FINISHED = 4;
 
-static const int LOG_TYPE_ROBOTINFO = 0;
-static const int LOG_TYPE_SCORE1 = 1;
-static const int LOG_TYPE_SCORE2 = 2;
-static const int LOG_TYPE_REMAININGTIME = 3;
-static const int LOG_TYPE_SECONDARYTIME = 4;
-static const int LOG_TYPE_GAMESTATE = 5;
-
-/*
- * Field parameters.
- * See Law 1 of rule book(2018) at http://www.robocuphumanoid.org/wp-content/uploads/RCHL-2018-Rules-Proposal_changesMarked_final.pdf
- */
-class FieldParameter
-{
-	// unit: meter
-public:
-	FieldParameter() :
-		field_length(9.0),
-		field_width(6.0),
-		goal_depth(0.6),
-		goal_width(2.6),
-		goal_height(1.8),
-		goal_area_length(1.0),
-		goal_area_width(5.0),
-		penalty_mark_distance(2.1),
-		center_circle_diameter(1.5),
-		border_strip_width(0.7)
-	{
-	}
-	~FieldParameter() {};
-	const double field_length;
-	const double field_width;
-	const double goal_depth;
-	const double goal_width;
-	const double goal_height;
-	const double goal_area_length;
-	const double goal_area_width;
-	const double penalty_mark_distance;
-	const double center_circle_diameter;
-	const double border_strip_width;
-};
-
-class FieldParameterInt
-{
-	// unit: centimeter
-public:
-	FieldParameterInt(FieldParameter param) :
-		field_length(static_cast<int>(param.field_length * 100)),
-		field_width(static_cast<int>(param.field_width * 100)),
-		goal_depth(static_cast<int>(param.goal_depth * 100)),
-		goal_width(static_cast<int>(param.goal_width * 100)),
-		goal_height(static_cast<int>(param.goal_height * 100)),
-		goal_area_length(static_cast<int>(param.goal_area_length * 100)),
-		goal_area_width(static_cast<int>(param.goal_area_width * 100)),
-		penalty_mark_distance(static_cast<int>(param.penalty_mark_distance * 100)),
-		center_circle_diameter(static_cast<int>(param.center_circle_diameter * 100)),
-		border_strip_width(static_cast<int>(param.border_strip_width * 100))
-	{
-	}
-	~FieldParameterInt() {};
-	const int field_length;
-	const int field_width;
-	const int goal_depth;
-	const int goal_width;
-	const int goal_height;
-	const int goal_area_length;
-	const int goal_area_width;
-	const int penalty_mark_distance;
-	const int center_circle_diameter;
-	const int border_strip_width;
-};
-
-class PositionMarker {
-public:
-	PositionMarker() : self_conf(0.0), ball_conf(0.0), voltage(0.0), temperature(0.0), colornum(0), enable_pos(false), enable_ball(false), enable_goal_pole{false, false} { color[0] = '\0'; }
-	double self_conf;
-	double ball_conf;
-	double voltage;
-	double temperature;
-	int colornum;
-	bool enable_pos;
-	bool enable_ball;
-	bool enable_goal_pole[2];
-	struct tm lastReceiveTime;
-	char color[20];
-	Pos pos; /* self position */
-	Pos ball; /* ball position */
-	Pos goal_pole[2]; /* goal pole position */
-	std::string message;
-};
-
-class LogDataRobotComm {
-public:
-	LogDataRobotComm() : temperature(0.0) { }
-	char time_str[100];
-	int id;
-	char color_str[100];
-	int fps;
-	double voltage;
-	double temperature;
-	int x;
-	int y;
-	double theta;
-	int ball_x;
-	int ball_y;
-	int goal_pole_x1;
-	int goal_pole_y1;
-	int goal_pole_x2;
-	int goal_pole_y2;
-	int cf_own;
-	int cf_ball;
-	char msg[100];
-};
-
-class LogData
-{
-public:
-	LogData() : type(0), score1(0), score2(0), remaining_time(0), secondary_time(0), game_state(0) { }
-	~LogData() { }
-	int type;
-	LogDataRobotComm robot_comm;
-	int score1;
-	int score2;
-	int remaining_time;
-	int secondary_time;
-	int game_state;
-	char time_str[100];
-};
-
 class Interface : public QMainWindow
 {
 	Q_OBJECT
 
 private:
 	LogWriter log_writer;
-	std::vector<UdpServer *> th;
+	QThread *network_thread;
+	UdpServer *udp_server;
 	GCReceiver *gc_thread;
+	std::unique_ptr<PacketCapture> packet_capture; // null unless capture/enable
+	RenderScheduler *render_scheduler;
 	QMenu *fileMenu;
 	QMenu *viewMenu;
 	QMenu *videoMenu;
@@ -190,10 +81,17 @@ private:
 	QAction *viewGoalPostAction;
 	QAction *viewRobotInformationAction;
 	QAction *viewSelfPosConfAction;
+	QAction *viewTrailsAction;
+	QAction *viewHeatmapAction;
+	QAction *viewPerformanceAction;
+	QAction *dumpPerformanceAction;
 	QStatusBar *statusBar;
 	QCheckBox *reverse;
 	QPushButton *log1Button, *log2Button, *log5Button;
 	QSettings *settings;
+	QFileSystemWatcher *config_watcher;
+	QByteArray config_file_data; // config.ini as the snapshot was last loaded
+	std::shared_ptr<const MonitorConfig> config;
 	QString filenameDrag;
 	QWidget *window;
 	AspectRatioPixmapLabel *image;
@@ -203,11 +101,20 @@ private:
 	QLabel *label_game_state;
 	QLabel *label_game_state_display;
 	QLabel *label_score;
+	QLabel *label_link_quality;
+	QLabel *label_render_stats;
 	QLCDNumber *time_display;
 	QLCDNumber *secondary_time_display;
 	QLCDNumber *score_display;
 	QPixmap map;
 	QPixmap origin_map;
+	QPixmap background; // origin_map with the team marker
+	QCache<quint64, QPixmap> robot_sprites;
+	int sprite_half_size;
+	TextCache text_cache;
+	QSize layer_size; // device size of the layers above
+	QTransform scene_transform; // field image coordinates to layer pixels
+	static const int HEADING_BUCKETS = 128;
 	QSlider *log_slider;
 	QGridLayout *mainLayout;
 	QVBoxLayout *checkLayout;
@@ -220,7 +127,29 @@ private:
 	QPalette pal_black;
 	QPalette pal_orange;
 	std::vector<PositionMarker> positions;
+	std::unique_ptr<OccupancyHeatmap> heatmap; // sized from config->field_image_*
+	QElapsedTimer trail_clock;
+	QElapsedTimer replay_clock; // invalid until the replay (re)starts
+	long long replay_origin_ms; // log time at the start of replay_clock
+	std::vector<LinkQuality> link_stats;
+	TrafficProbeStats probe_stats;
+	LatencyHistogram render_time; // updateMap()
+	LatencyHistogram decode_time; // decodeUdp()
+	LatencyHistogram field_space_time; // information box layout
+	// counters at the last update of the performance panel
+	LatencyHistogram shown_render_time;
+	LatencyHistogram shown_decode_time;
+	LatencyHistogram shown_field_space_time;
+	LatencyHistogram shown_gc_time;
+	LatencyHistogram shown_log_write_time;
+	unsigned long long shown_gc_packet_count;
+	QString performance_text;
+	// the log being played: a binary log stays mapped and only the records
+	// to show are indexed, other logs are read into log_data
 	std::vector<LogData> log_data;
+	std::vector<long long> log_times_ms; // of log_data, since its first entry
+	BinaryLogFile binary_log;
+	std::vector<size_t> binary_log_records;
 	bool fLogging;
 	bool fReverse;
 	bool fViewGoalpost;
@@ -228,50 +157,58 @@ private:
 	bool fPauseLog;
 	bool fRecording;
 	bool fViewSelfPosConf;
+	bool fViewTrails;
+	bool fViewHeatmap;
+	bool fViewPerformance;
 	int updateMapTimerId;
 	int score_team1;
 	int score_team2;
 	unsigned int log_count;
-	const int max_robot_num;
-	int logo_pos_x, logo_pos_y;
+	RobotRegistry robots;
 	int log_speed;
+	const int field_index;
+	const QString network_group;
 	FieldParameterInt field_param;
-	FieldSpaceManager field_space;
-	void initializeConfig(void);
+	std::unique_ptr<FieldSpaceManager> field_space; // sized from config->field_image_*
 	void createWindow(void);
+	void createFieldGrids(void);
+	void showEvent(QShowEvent *);
 	void connection(void);
-	int getInterval(QString, QString);
+	void scheduleNextLogEntry(void);
+	size_t logEntryCount(void) const;
+	LogData logEntry(const size_t) const;
+	long long logEntryTimeMs(const size_t) const;
 	Pos globalPosToImagePos(Pos);
 	void timerEvent(QTimerEvent *);
-	void setParamFromFile(std::vector<std::string>);
-	void setParamFromFileV1(std::vector<std::string>);
-	void setParamFromFileV2(std::vector<std::string>);
+	void updateLinkQuality(void);
 	void setData(LogData);
-	QColor getColor(const char *);
 	void createMenus(void);
-	void drawTeamMarker(QPainter &, const int, const int);
-	void drawRobotMarker(QPainter &, const int, const int, const double, const int, const QColor, const double);
-	void drawRobotInformation(QPainter &, const int, const int, const double, const int, const QColor, const double, const double, const std::string, const double, const double);
-	void drawBallMarker(QPainter &, const int, const int, const int, const int, const int, const int);
-	void drawGoalPostMarker(QPainter &, const int, const int, const int, const int);
-	void drawHighlightCircle(QPainter &, const int, const int);
+	void drawRobotSprite(QPainter &, const int, const int, const double, const QColor);
+	FieldPainter fieldPainter(void);
+	void recordTrails(const int);
+	void updatePerformance(void);
+	void drawPerformanceOverlay(QPainter &);
+	QByteArray readConfigFile(void) const;
 
 public:
-	Interface();
+	Interface(const int = 0);
 	~Interface();
 	void drawField(void);
+	void updateBackground(void);
 	void dragEnterEvent(QDragEnterEvent *);
 	void dropEvent(QDropEvent *);
 	void decodeUdp(struct comm_info_T, int num);
+	int robotSlot(const unsigned char);
+	static QString robotName(const unsigned char);
+	static void initializeConfig(QSettings &, const int = 0);
+
+public slots:
 	void updateMap(void);
 
 private slots:
-	void decodeData1(struct comm_info_T);
-	void decodeData2(struct comm_info_T);
-	void decodeData3(struct comm_info_T);
-	void decodeData4(struct comm_info_T);
-	void decodeData5(struct comm_info_T);
-	void decodeData6(struct comm_info_T);
+	void shutdown(void);
+	void processReceivedData(void);
+	void updateGameState(unsigned int, GameStateData);
 	void setGameState(int);
 	void setRemainingTime(int);
 	void setSecondaryTime(int);
@@ -281,6 +218,10 @@ private slots:
 	void viewGoalpost(bool);
 	void viewRobotInformation(bool);
 	void viewSelfPosConf(bool);
+	void viewTrails(bool);
+	void viewHeatmap(bool);
+	void viewPerformance(bool);
+	void dumpPerformance(void);
 	void loadLogFile(void);
 	void updateLog(void);
 	void logSpeed1(void);
@@ -291,6 +232,8 @@ private slots:
 	void openSettingWindow(void);
 	void gameStateFontSizeChanged(int);
 	void displaySizeChanged(int);
+	void reloadConfig(void);
+	void configFileChanged(void);
 };
 
 #endif // INTERFACE_H
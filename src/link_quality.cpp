@@ -0,0 +1,74 @@
+#include <cstdlib>
+
+#include "link_quality.h"
+
+LinkQuality::LinkQuality() : last_time_us(0), last_interval_us(0), mean_interval_us(0.0), jitter_us(0.0), longest_gap_us(0), packet_count(0), socket_drops(0), bins()
+{
+}
+
+void LinkQuality::addPacket(const long long receive_time_us)
+{
+	packet_count++;
+	if(packet_count == 1) {
+		last_time_us = receive_time_us;
+		return;
+	}
+	const long long interval = receive_time_us - last_time_us;
+	last_time_us = receive_time_us;
+	if(packet_count == 2) {
+		mean_interval_us = interval;
+	} else {
+		constexpr double gain = 1.0 / 16.0;
+		mean_interval_us += (interval - mean_interval_us) * gain;
+		jitter_us += (std::llabs(interval - last_interval_us) - jitter_us) * gain;
+	}
+	last_interval_us = interval;
+	if(interval > longest_gap_us)
+		longest_gap_us = interval;
+	int bin = 0;
+	for(long long ms = interval / 1000; ms > 0 && bin < NUM_BINS - 1; ms >>= 1)
+		bin++;
+	bins[bin]++;
+}
+
+void LinkQuality::setSocketDrops(const unsigned int drops)
+{
+	socket_drops = drops;
+}
+
+unsigned int LinkQuality::packetCount(void) const
+{
+	return packet_count;
+}
+
+double LinkQuality::packetsPerSecond(void) const
+{
+	if(mean_interval_us <= 0.0)
+		return 0.0;
+	return 1000000.0 / mean_interval_us;
+}
+
+double LinkQuality::jitterMs(void) const
+{
+	return jitter_us / 1000.0;
+}
+
+double LinkQuality::longestGapMs(void) const
+{
+	return longest_gap_us / 1000.0;
+}
+
+unsigned int LinkQuality::socketDrops(void) const
+{
+	return socket_drops;
+}
+
+unsigned int LinkQuality::histogram(const int bin) const
+{
+	return bins[bin];
+}
+
+long long LinkQuality::lastReceiveTime(void) const
+{
+	return last_time_us;
+}
@@ -0,0 +1,39 @@
+#ifndef LINK_QUALITY_H
+#define LINK_QUALITY_H
+
+/*
+ * Link statistics of one robot. addPacket() is O(1) and the object has a
+ * fixed size, so it can be updated for every packet on the receive path
+ * and copied to the GUI as a snapshot.
+ *
+ * The packet rate is derived from a moving average of the inter-arrival
+ * time and the jitter is the RFC 3550 estimator applied to consecutive
+ * inter-arrival times. The histogram bins inter-arrival times on a log2
+ * scale in milliseconds: [0,1), [1,2), [2,4), ... and everything above.
+ */
+class LinkQuality
+{
+public:
+	static const int NUM_BINS = 12;
+	LinkQuality();
+	void addPacket(const long long receive_time_us);
+	void setSocketDrops(const unsigned int drops);
+	unsigned int packetCount(void) const;
+	double packetsPerSecond(void) const;
+	double jitterMs(void) const;
+	double longestGapMs(void) const;
+	unsigned int socketDrops(void) const;
+	unsigned int histogram(const int bin) const;
+	long long lastReceiveTime(void) const;
+private:
+	long long last_time_us;
+	long long last_interval_us;
+	double mean_interval_us;
+	double jitter_us;
+	long long longest_gap_us;
+	unsigned int packet_count;
+	unsigned int socket_drops;
+	unsigned int bins[NUM_BINS];
+};
+
+#endif // LINK_QUALITY_H
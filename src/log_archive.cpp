@@ -0,0 +1,525 @@
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <set>
+
+#include <QDir>
+#include <QFileInfo>
+#include <QRunnable>
+#include <QThreadPool>
+
+#include "log_archive.h"
+
+// per robot columns, in this order
+enum {
+	ROBOT_FPS,
+	ROBOT_VOLTAGE,  // 1/100 V
+	ROBOT_X,
+	ROBOT_Y,
+	ROBOT_THETA,    // 1e-6 rad
+	ROBOT_BALL_X,
+	ROBOT_BALL_Y,
+	ROBOT_GOAL_POLE_X1,
+	ROBOT_GOAL_POLE_Y1,
+	ROBOT_GOAL_POLE_X2,
+	ROBOT_GOAL_POLE_Y2,
+	ROBOT_CF_OWN,
+	ROBOT_CF_BALL,
+	ROBOT_FIELDS,
+};
+
+static void putVarint(std::string &out, uint64_t value)
+{
+	while(value >= 0x80) {
+		out.push_back(static_cast<char>(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back(static_cast<char>(value));
+}
+
+// zigzag, so that small negative deltas stay short
+static void putSigned(std::string &out, const long long value)
+{
+	putVarint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+static void putSection(std::string &out, const std::string &section)
+{
+	putVarint(out, section.size());
+	out += section;
+}
+
+/*
+ * Reads varints from a column. Reading past the end, or a malformed
+ * varint, clears ok and returns 0.
+ */
+class ColumnReader
+{
+public:
+	ColumnReader() : p(nullptr), end(nullptr), ok(true) {}
+	ColumnReader(const unsigned char *data, const size_t size) : p(data), end(data + size), ok(true) {}
+	uint64_t varint(void)
+	{
+		uint64_t value = 0;
+		for(int shift = 0; shift < 64; shift += 7) {
+			if(p >= end)
+				break;
+			const unsigned char byte = *p++;
+			value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+			if(!(byte & 0x80))
+				return value;
+		}
+		ok = false;
+		return 0;
+	}
+	long long signedVarint(void)
+	{
+		const uint64_t value = varint();
+		return static_cast<long long>(value >> 1) ^ -static_cast<long long>(value & 1);
+	}
+	ColumnReader section(void)
+	{
+		const uint64_t size = varint();
+		if(!ok || size > static_cast<uint64_t>(end - p)) {
+			ok = false;
+			return ColumnReader();
+		}
+		ColumnReader column(p, size);
+		p += size;
+		return column;
+	}
+	std::string bytes(const size_t size)
+	{
+		if(size > static_cast<size_t>(end - p)) {
+			ok = false;
+			return std::string();
+		}
+		std::string value(reinterpret_cast<const char *>(p), size);
+		p += size;
+		return value;
+	}
+	const unsigned char *p;
+	const unsigned char *end;
+	bool ok;
+};
+
+static void robotFields(const LogDataRobotComm &buf, long long fields[ROBOT_FIELDS])
+{
+	fields[ROBOT_FPS] = buf.fps;
+	fields[ROBOT_VOLTAGE] = std::llround(buf.voltage * 100);
+	fields[ROBOT_X] = buf.x;
+	fields[ROBOT_Y] = buf.y;
+	fields[ROBOT_THETA] = std::llround(buf.theta * 1e6);
+	fields[ROBOT_BALL_X] = buf.ball_x;
+	fields[ROBOT_BALL_Y] = buf.ball_y;
+	fields[ROBOT_GOAL_POLE_X1] = buf.goal_pole_x1;
+	fields[ROBOT_GOAL_POLE_Y1] = buf.goal_pole_y1;
+	fields[ROBOT_GOAL_POLE_X2] = buf.goal_pole_x2;
+	fields[ROBOT_GOAL_POLE_Y2] = buf.goal_pole_y2;
+	fields[ROBOT_CF_OWN] = buf.cf_own;
+	fields[ROBOT_CF_BALL] = buf.cf_ball;
+}
+
+static void setRobotFields(LogDataRobotComm &buf, const long long fields[ROBOT_FIELDS])
+{
+	buf.fps = static_cast<int>(fields[ROBOT_FPS]);
+	buf.voltage = fields[ROBOT_VOLTAGE] / 100.0;
+	buf.x = static_cast<int>(fields[ROBOT_X]);
+	buf.y = static_cast<int>(fields[ROBOT_Y]);
+	buf.theta = fields[ROBOT_THETA] / 1e6;
+	buf.ball_x = static_cast<int>(fields[ROBOT_BALL_X]);
+	buf.ball_y = static_cast<int>(fields[ROBOT_BALL_Y]);
+	buf.goal_pole_x1 = static_cast<int>(fields[ROBOT_GOAL_POLE_X1]);
+	buf.goal_pole_y1 = static_cast<int>(fields[ROBOT_GOAL_POLE_Y1]);
+	buf.goal_pole_x2 = static_cast<int>(fields[ROBOT_GOAL_POLE_X2]);
+	buf.goal_pole_y2 = static_cast<int>(fields[ROBOT_GOAL_POLE_Y2]);
+	buf.cf_own = static_cast<int>(fields[ROBOT_CF_OWN]);
+	buf.cf_ball = static_cast<int>(fields[ROBOT_CF_BALL]);
+}
+
+static long long eventValue(const LogData &ldata)
+{
+	switch(ldata.type) {
+	case LOG_TYPE_SCORE1:
+		return ldata.score1;
+	case LOG_TYPE_SCORE2:
+		return ldata.score2;
+	case LOG_TYPE_REMAININGTIME:
+		return ldata.remaining_time;
+	case LOG_TYPE_SECONDARYTIME:
+		return ldata.secondary_time;
+	case LOG_TYPE_GAMESTATE:
+		return ldata.game_state;
+	}
+	return 0;
+}
+
+static void setEventValue(LogData &ldata, const int value)
+{
+	switch(ldata.type) {
+	case LOG_TYPE_SCORE1:
+		ldata.score1 = value;
+		break;
+	case LOG_TYPE_SCORE2:
+		ldata.score2 = value;
+		break;
+	case LOG_TYPE_REMAININGTIME:
+		ldata.remaining_time = value;
+		break;
+	case LOG_TYPE_SECONDARYTIME:
+		ldata.secondary_time = value;
+		break;
+	case LOG_TYPE_GAMESTATE:
+		ldata.game_state = value;
+		break;
+	}
+}
+
+/*
+ * Columns of one robot within a block, while writing.
+ */
+struct RobotColumns {
+	int id;
+	std::string color;
+	long long previous[ROBOT_FIELDS];
+	std::string columns[ROBOT_FIELDS];
+	std::string previous_message;
+	std::string messages; // length + 1 and the text, 0 for the previous text
+};
+
+/*
+ * The same, while reading.
+ */
+struct RobotColumnReaders {
+	int id;
+	std::string color;
+	long long previous[ROBOT_FIELDS];
+	ColumnReader columns[ROBOT_FIELDS];
+	std::string previous_message;
+	ColumnReader messages;
+};
+
+LogArchive::LogArchive()
+{
+	memset(&header, 0, sizeof(header));
+}
+
+bool LogArchive::open(const QString &file_name)
+{
+	close();
+	file.setFileName(file_name);
+	if(!file.open(QIODevice::ReadOnly)) {
+		std::cerr << "file open error" << std::endl;
+		return false;
+	}
+	if(file.read(reinterpret_cast<char *>(&header), sizeof(header)) != sizeof(header) ||
+			memcmp(header.magic, LOG_ARCHIVE_MAGIC, sizeof(LOG_ARCHIVE_MAGIC)) != 0 || header.version != LOG_ARCHIVE_VERSION) {
+		std::cerr << "unsupported log archive: " << file_name.toStdString() << std::endl;
+		close();
+		return false;
+	}
+	const qint64 index_size = static_cast<qint64>(header.block_count) * sizeof(log_archive_block_T);
+	index.resize(header.block_count);
+	if(header.index_offset < static_cast<qint64>(sizeof(header)) || header.index_offset + index_size > file.size() ||
+			!file.seek(header.index_offset) || file.read(reinterpret_cast<char *>(index.data()), index_size) != index_size) {
+		std::cerr << "broken log archive index: " << file_name.toStdString() << std::endl;
+		close();
+		return false;
+	}
+	for(const auto &block : index) {
+		if(block.offset < static_cast<qint64>(sizeof(header)) || block.size < 0 || block.offset + block.size > header.index_offset) {
+			std::cerr << "broken log archive index: " << file_name.toStdString() << std::endl;
+			close();
+			return false;
+		}
+	}
+	return true;
+}
+
+void LogArchive::close(void)
+{
+	file.close();
+	index.clear();
+	memset(&header, 0, sizeof(header));
+}
+
+long long LogArchive::startMs(void) const
+{
+	return header.start_ms;
+}
+
+long long LogArchive::endMs(void) const
+{
+	return index.empty() ? header.start_ms : index.back().last_ms;
+}
+
+size_t LogArchive::blockCount(void) const
+{
+	return index.size();
+}
+
+/*
+ * Append the entries from from_ms to to_ms (log times, inclusive),
+ * decompressing only the blocks that overlap the range.
+ */
+bool LogArchive::read(const long long from_ms, const long long to_ms, std::vector<LogData> &log_data)
+{
+	for(const auto &block : index) {
+		if(block.last_ms < from_ms || block.first_ms > to_ms)
+			continue;
+		QByteArray compressed(block.size, '\0');
+		if(!file.seek(block.offset) || file.read(compressed.data(), block.size) != block.size) {
+			std::cerr << "cannot read log archive block" << std::endl;
+			return false;
+		}
+		if(!decodeBlock(block, qUncompress(compressed), from_ms, to_ms, log_data)) {
+			std::cerr << "broken log archive block" << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+bool LogArchive::readAll(std::vector<LogData> &log_data)
+{
+	return read(startMs(), endMs(), log_data);
+}
+
+/*
+ * Columns of the entries first to last - 1, see log_archive.h.
+ */
+QByteArray LogArchive::encodeBlock(const std::vector<LogData> &log_data, const std::vector<long long> &times, const size_t first, const size_t last)
+{
+	std::string rows;   // type, and the robot for robot entries
+	std::string deltas; // time since the previous entry
+	std::string events; // values of the other entries
+	std::vector<RobotColumns> robots;
+	long long previous_time = times[first];
+	for(size_t i = first; i < last; i++) {
+		const LogData &ldata = log_data[i];
+		putVarint(rows, ldata.type);
+		putSigned(deltas, times[i] - previous_time);
+		previous_time = times[i];
+		if(ldata.type != LOG_TYPE_ROBOTINFO) {
+			putSigned(events, eventValue(ldata));
+			continue;
+		}
+		const LogDataRobotComm &buf = ldata.robot_comm;
+		size_t r = 0;
+		while(r < robots.size() && (robots[r].id != buf.id || robots[r].color != buf.color_str))
+			r++;
+		if(r == robots.size()) {
+			robots.push_back(RobotColumns());
+			robots[r].id = buf.id;
+			robots[r].color = buf.color_str;
+			std::fill(robots[r].previous, robots[r].previous + ROBOT_FIELDS, 0);
+		}
+		putVarint(rows, r);
+		RobotColumns &robot = robots[r];
+		long long fields[ROBOT_FIELDS];
+		robotFields(buf, fields);
+		for(int f = 0; f < ROBOT_FIELDS; f++) {
+			putSigned(robot.columns[f], fields[f] - robot.previous[f]);
+			robot.previous[f] = fields[f];
+		}
+		if(buf.msg == robot.previous_message) {
+			putVarint(robot.messages, 0);
+		} else {
+			robot.previous_message = buf.msg;
+			putVarint(robot.messages, robot.previous_message.size() + 1);
+			robot.messages += robot.previous_message;
+		}
+	}
+
+	std::string payload;
+	putVarint(payload, last - first);
+	putSection(payload, rows);
+	putSection(payload, deltas);
+	putSection(payload, events);
+	putVarint(payload, robots.size());
+	for(const auto &robot : robots) {
+		putSigned(payload, robot.id);
+		putSection(payload, robot.color);
+		for(int f = 0; f < ROBOT_FIELDS; f++)
+			putSection(payload, robot.columns[f]);
+		putSection(payload, robot.messages);
+	}
+	return qCompress(reinterpret_cast<const unsigned char *>(payload.data()), static_cast<int>(payload.size()));
+}
+
+bool LogArchive::decodeBlock(const log_archive_block_T &block, const QByteArray &payload, const long long from_ms, const long long to_ms, std::vector<LogData> &log_data) const
+{
+	ColumnReader reader(reinterpret_cast<const unsigned char *>(payload.constData()), payload.size());
+	const uint64_t entries = reader.varint();
+	ColumnReader rows = reader.section();
+	ColumnReader deltas = reader.section();
+	ColumnReader events = reader.section();
+	const uint64_t robot_count = reader.varint();
+	if(!reader.ok || entries != static_cast<uint64_t>(block.entries) || robot_count > entries)
+		return false;
+	std::vector<RobotColumnReaders> robots(robot_count);
+	for(auto &robot : robots) {
+		robot.id = static_cast<int>(reader.signedVarint());
+		ColumnReader color = reader.section();
+		robot.color = color.bytes(color.end - color.p);
+		std::fill(robot.previous, robot.previous + ROBOT_FIELDS, 0);
+		for(int f = 0; f < ROBOT_FIELDS; f++)
+			robot.columns[f] = reader.section();
+		robot.messages = reader.section();
+	}
+	if(!reader.ok)
+		return false;
+
+	long long time = block.first_ms;
+	for(uint64_t i = 0; i < entries; i++) {
+		LogData ldata;
+		ldata.type = static_cast<int>(rows.varint());
+		time += deltas.signedVarint();
+		logTimeString(ldata.time_str, sizeof(ldata.time_str), time);
+		if(ldata.type != LOG_TYPE_ROBOTINFO) {
+			setEventValue(ldata, static_cast<int>(events.signedVarint()));
+		} else {
+			const uint64_t r = rows.varint();
+			if(r >= robots.size())
+				return false;
+			RobotColumnReaders &robot = robots[r];
+			LogDataRobotComm &buf = ldata.robot_comm;
+			for(int f = 0; f < ROBOT_FIELDS; f++) {
+				robot.previous[f] += robot.columns[f].signedVarint();
+				if(!robot.columns[f].ok)
+					return false;
+			}
+			setRobotFields(buf, robot.previous);
+			const uint64_t message_size = robot.messages.varint();
+			if(message_size > 0) {
+				if(message_size > sizeof(buf.msg))
+					return false;
+				robot.previous_message = robot.messages.bytes(message_size - 1);
+			}
+			if(!robot.messages.ok || robot.color.size() >= sizeof(buf.color_str))
+				return false;
+			buf.id = robot.id;
+			strcpy(buf.color_str, robot.color.c_str());
+			strcpy(buf.msg, robot.previous_message.c_str());
+			strcpy(buf.time_str, ldata.time_str);
+		}
+		if(!rows.ok || !deltas.ok || !events.ok)
+			return false;
+		if(time >= from_ms && time <= to_ms)
+			log_data.push_back(ldata);
+	}
+	return true;
+}
+
+bool LogArchive::write(const QString &file_name, const std::vector<LogData> &log_data)
+{
+	QFile out(file_name);
+	if(!out.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		std::cerr << "cannot open " << file_name.toStdString() << std::endl;
+		return false;
+	}
+	std::vector<long long> times;
+	const long long start = logTimesMs(log_data, times);
+	for(auto &t : times)
+		t += start;
+
+	log_archive_header_T archive_header;
+	memset(&archive_header, 0, sizeof(archive_header));
+	memcpy(archive_header.magic, LOG_ARCHIVE_MAGIC, sizeof(LOG_ARCHIVE_MAGIC));
+	archive_header.version = LOG_ARCHIVE_VERSION;
+	archive_header.start_ms = start;
+	bool ok = out.write(reinterpret_cast<const char *>(&archive_header), sizeof(archive_header)) == sizeof(archive_header);
+	std::vector<log_archive_block_T> blocks;
+	for(size_t first = 0; first < log_data.size() && ok; first += BLOCK_ENTRIES) {
+		const size_t last = std::min(log_data.size(), first + BLOCK_ENTRIES);
+		const QByteArray compressed = encodeBlock(log_data, times, first, last);
+		log_archive_block_T block;
+		block.first_ms = times[first];
+		block.last_ms = times[last - 1];
+		block.offset = out.pos();
+		block.size = compressed.size();
+		block.entries = static_cast<int32_t>(last - first);
+		blocks.push_back(block);
+		ok = out.write(compressed) == compressed.size();
+	}
+	archive_header.block_count = blocks.size();
+	archive_header.index_offset = out.pos();
+	const qint64 index_size = static_cast<qint64>(blocks.size() * sizeof(log_archive_block_T));
+	ok = ok && out.write(reinterpret_cast<const char *>(blocks.data()), index_size) == index_size;
+	ok = ok && out.seek(0) && out.write(reinterpret_cast<const char *>(&archive_header), sizeof(archive_header)) == sizeof(archive_header);
+	out.close();
+	if(!ok) {
+		std::cerr << "cannot write " << file_name.toStdString() << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool isLogArchive(const std::string &file_name)
+{
+	char magic[sizeof(LOG_ARCHIVE_MAGIC)];
+	FILE *fp = fopen(file_name.c_str(), "rb");
+	if(!fp)
+		return false;
+	const bool archive = fread(magic, sizeof(magic), 1, fp) == 1 && memcmp(magic, LOG_ARCHIVE_MAGIC, sizeof(magic)) == 0;
+	fclose(fp);
+	return archive;
+}
+
+bool readLogArchive(const std::string &file_name, std::vector<LogData> &log_data)
+{
+	LogArchive archive;
+	return archive.open(QString::fromStdString(file_name)) && archive.readAll(log_data);
+}
+
+/*
+ * Reads and archives one log on a pool thread.
+ */
+class ArchiveTask : public QRunnable
+{
+public:
+	ArchiveTask(const std::string &input_file, const QString &output_file, std::atomic<int> &failed_count) :
+		input(input_file), output(output_file), failed(failed_count)
+	{
+	}
+	void run()
+	{
+		std::vector<LogData> log_data;
+		if(!readLogFile(input, log_data) || !LogArchive::write(output, log_data)) {
+			std::cerr << "cannot archive " << input << std::endl;
+			failed++;
+		}
+	}
+private:
+	const std::string input;
+	const QString output;
+	std::atomic<int> &failed;
+};
+
+int archiveLogs(const std::vector<std::string> &inputs, const QString &output_dir)
+{
+	if(!QDir().mkpath(output_dir)) {
+		std::cerr << "cannot create " << output_dir.toStdString() << std::endl;
+		return static_cast<int>(inputs.size());
+	}
+	std::atomic<int> failed(0);
+	QThreadPool pool;
+	// logs of the same name from different directories would overwrite
+	// each other's archive, later ones get -2, -3 and so on. Case is
+	// ignored, not every file system tells names apart by it.
+	std::set<std::string> names;
+	for(const auto &input : inputs) {
+		const QString base = QFileInfo(QString::fromStdString(input)).completeBaseName();
+		QString name = base;
+		for(int n = 2; !names.insert(name.toLower().toStdString()).second; n++)
+			name = base + QString("-%1").arg(n);
+		if(name != base)
+			std::cerr << input << " archived as " << name.toStdString() << ".logz" << std::endl;
+		pool.start(new ArchiveTask(input, QDir(output_dir).filePath(name + ".logz"), failed));
+	}
+	pool.waitForDone();
+	return failed;
+}
@@ -0,0 +1,81 @@
+#ifndef LOG_ARCHIVE_H
+#define LOG_ARCHIVE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+#include "log_reader.h"
+
+/*
+ * Compressed archive of a finished game, for keeping whole seasons of
+ * logs ("game_monitor --archive").
+ *
+ * The entries are stored in blocks of up to BLOCK_ENTRIES. Inside a block
+ * the values are stored by column: the entry types, the time deltas, the
+ * game events, and for every robot one column per field (fps, voltage,
+ * position, theta, ball, goal poles, confidences, message). Numbers are
+ * delta and varint encoded, then the block is compressed with qCompress.
+ * The index at the end of the file holds the time range of every block,
+ * so reading a time range only decompresses the blocks it touches.
+ *
+ * Times are log times in milliseconds: the time of day of the first entry
+ * plus the time since then, so they grow past one day after midnight.
+ * Entries keep everything LogData holds; theta is kept to 1e-6 and the
+ * voltage to 0.01, the precision of the text logs.
+ */
+static const char LOG_ARCHIVE_MAGIC[8] = { 'H', 'L', 'G', 'M', 'A', 'R', 'C', '\0' };
+static const uint32_t LOG_ARCHIVE_VERSION = 1;
+
+struct log_archive_header_T {
+	char magic[8];
+	uint32_t version;
+	uint32_t block_count;
+	int64_t start_ms; // log time of the first entry
+	int64_t index_offset;
+};
+
+struct log_archive_block_T {
+	int64_t first_ms;
+	int64_t last_ms;
+	int64_t offset;
+	int32_t size; // compressed
+	int32_t entries;
+};
+
+class LogArchive
+{
+public:
+	static const int BLOCK_ENTRIES = 4096;
+	LogArchive();
+	bool open(const QString &);
+	void close(void);
+	long long startMs(void) const;
+	long long endMs(void) const;
+	size_t blockCount(void) const;
+	bool read(const long long, const long long, std::vector<LogData> &);
+	bool readAll(std::vector<LogData> &);
+	static bool write(const QString &, const std::vector<LogData> &);
+private:
+	static QByteArray encodeBlock(const std::vector<LogData> &, const std::vector<long long> &, const size_t, const size_t);
+	bool decodeBlock(const log_archive_block_T &, const QByteArray &, const long long, const long long, std::vector<LogData> &) const;
+	QFile file;
+	log_archive_header_T header;
+	std::vector<log_archive_block_T> index;
+};
+
+bool isLogArchive(const std::string &);
+bool readLogArchive(const std::string &, std::vector<LogData> &);
+
+/*
+ * Archive every log into the output directory as <name>.logz, one file
+ * per pool thread. Logs of the same name are archived as <name>-2.logz,
+ * <name>-3.logz and so on. Returns the number of logs that failed.
+ */
+int archiveLogs(const std::vector<std::string> &, const QString &);
+
+#endif // LOG_ARCHIVE_H
@@ -0,0 +1,273 @@
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+
+#include <QBuffer>
+#include <QDir>
+#include <QFontMetrics>
+#include <QPainter>
+#include <QRunnable>
+#include <QThreadPool>
+
+#include "comm_info.h"
+#include "robot_registry.h"
+#include "log_exporter.h"
+
+/*
+ * Draws and encodes one frame on a pool thread. Holds its own copy of the
+ * markers, the replay has moved on when it runs.
+ */
+class ExportFrameTask : public QRunnable
+{
+public:
+	ExportFrameTask(LogExporter *log_exporter, const int frame_index, const std::vector<PositionMarker> &frame_positions, const ExportScoreboard &frame_scoreboard, const long long frame_trail_since) :
+		exporter(log_exporter), frame(frame_index), positions(frame_positions), scoreboard(frame_scoreboard), trail_since(frame_trail_since)
+	{
+	}
+	void run()
+	{
+		exporter->renderFrame(frame, positions, scoreboard, trail_since);
+	}
+private:
+	LogExporter *exporter;
+	const int frame;
+	const std::vector<PositionMarker> positions;
+	const ExportScoreboard scoreboard;
+	const long long trail_since;
+};
+
+static QString timeString(int time)
+{
+	QString sign;
+	if(time < 0) {
+		time = -time;
+		sign = "-";
+	}
+	return sign + QString("%1:%2").arg(time / 60).arg(time % 60, 2, 10, QChar('0'));
+}
+
+static QString gameStateString(const int game_state)
+{
+	static const char *names[] = { "Initial", "Ready", "Set", "Playing", "Finished" };
+	if(game_state < 0 || game_state > 4)
+		return QString("Impossible");
+	return QString(names[game_state]);
+}
+
+LogExporter::LogExporter(const std::shared_ptr<const MonitorConfig> &monitor_config, const FieldView &field_view) : config(monitor_config), view(field_view), field_param(FieldParameter()), format(FORMAT_PNG), next_write(0)
+{
+}
+
+/*
+ * Export the whole log at fps frames per second and the given frame size,
+ * the field image size if it is empty. Returns false if the output could
+ * not be written.
+ */
+bool LogExporter::exportLog(const std::vector<LogData> &log_data, const QString &output_path, const Format output_format, const int fps, const QSize &frame_size)
+{
+	if(log_data.empty() || fps <= 0) {
+		std::cerr << "nothing to export" << std::endl;
+		return false;
+	}
+	format = output_format;
+	output = output_path;
+	next_write = 0;
+	done_frames.clear();
+	if(format == FORMAT_PNG) {
+		if(!QDir().mkpath(output)) {
+			std::cerr << "cannot create " << output.toStdString() << std::endl;
+			return false;
+		}
+	} else {
+		raw_file.setFileName(output);
+		if(!raw_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+			std::cerr << "cannot open " << output.toStdString() << std::endl;
+			return false;
+		}
+	}
+
+	const int field_w = config->field_image_width;
+	const int field_h = config->field_image_height;
+	const QSize size = frame_size.isEmpty() ? QSize(field_w, field_h) : frame_size;
+	scene_transform = QTransform::fromScale(static_cast<qreal>(size.width()) / field_w, static_cast<qreal>(size.height()) / field_h);
+	const FieldPainter field_painter(config, view);
+	background = QImage(size, QImage::Format_RGB32);
+	background.fill(Qt::black);
+	QPainter paint(&background);
+	paint.setRenderHint(QPainter::Antialiasing);
+	paint.setTransform(scene_transform);
+	field_painter.drawField(paint, field_param);
+	field_painter.drawTeamMarker(paint, field_param);
+	paint.end();
+
+	// Logs before format 2.1 have times in whole seconds. Entries with the
+	// same time are spread evenly up to the next time, so that robots move
+	// smoothly instead of once a second.
+	std::vector<long long> times;
+	logTimesMs(log_data, times);
+	for(size_t first = 0; first < times.size(); ) {
+		size_t last = first + 1;
+		while(last < times.size() && times[last] == times[first])
+			last++;
+		const long long span = (last < times.size() ? times[last] : times[first] + 1000) - times[first];
+		for(size_t i = first + 1; i < last; i++)
+			times[i] += span * static_cast<long long>(i - first) / static_cast<long long>(last - first);
+		first = last;
+	}
+
+	const long long start = times.front();
+	const int frame_count = static_cast<int>((times.back() - start) * fps / 1000) + 1;
+	QThreadPool pool;
+	const int max_pending = pool.maxThreadCount() * 2;
+	RobotRegistry robots;
+	std::vector<PositionMarker> positions;
+	std::vector<long long> last_received;
+	FieldSpaceManager field_space(field_w, field_h, std::max(1, field_w / 20), std::max(1, field_h / 20));
+	ExportScoreboard scoreboard;
+	size_t next_entry = 0;
+	bool ok = true;
+	for(int frame = 0; frame < frame_count && ok; frame++) {
+		const long long now = start + static_cast<long long>(frame) * 1000 / fps;
+		for(; next_entry < log_data.size() && times[next_entry] <= now; next_entry++) {
+			const LogData &entry = log_data[next_entry];
+			if(entry.type == LOG_TYPE_REMAININGTIME) {
+				scoreboard.remaining_time = entry.remaining_time;
+			} else if(entry.type == LOG_TYPE_SECONDARYTIME) {
+				scoreboard.secondary_time = entry.secondary_time;
+			} else if(entry.type == LOG_TYPE_SCORE1) {
+				scoreboard.score1 = entry.score1;
+			} else if(entry.type == LOG_TYPE_SCORE2) {
+				scoreboard.score2 = entry.score2;
+			} else if(entry.type == LOG_TYPE_GAMESTATE) {
+				scoreboard.game_state = entry.game_state;
+			} else if(entry.type == LOG_TYPE_ROBOTINFO) {
+				const LogDataRobotComm &data = entry.robot_comm;
+				const int color = strncmp(data.color_str, "CYAN", 4) == 0 ? CYAN : MAGENTA;
+				const unsigned char key = RobotRegistry::makeKey(color, data.id);
+				const int num = robots.slotOf(key);
+				if(num >= static_cast<int>(positions.size())) {
+					positions.resize(num + 1);
+					last_received.resize(num + 1);
+					positions[num].colornum = RobotRegistry::colorOf(key);
+					positions[num].robot_id = RobotRegistry::idOf(key);
+				}
+				PositionMarker &marker = positions[num];
+				marker.setFromLog(data);
+				marker.trail.add(marker.pos.x, marker.pos.y, times[next_entry]);
+				marker.ball_trail.add(marker.ball.x, marker.ball.y, times[next_entry]);
+				last_received[num] = times[next_entry];
+			}
+		}
+		const long long time_limit = config->marker_time_up_limit * 1000LL;
+		for(size_t i = 0; i < positions.size(); i++) {
+			if(positions[i].enable_pos && now - last_received[i] > time_limit) {
+				positions[i].enable_pos = false;
+				positions[i].enable_ball = false;
+			}
+		}
+		field_painter.placeInformation(positions, field_space);
+		ok = writeReadyFrames(frame, max_pending);
+		if(ok)
+			pool.start(new ExportFrameTask(this, frame, positions, scoreboard, now - config->trail_seconds * 1000LL));
+	}
+	if(ok)
+		ok = writeReadyFrames(frame_count, 1);
+	pool.waitForDone();
+	if(format == FORMAT_RAW)
+		raw_file.close();
+	if(!ok)
+		return false;
+	std::cout << frame_count << " frames of " << size.width() << "x" << size.height() << " written to " << output.toStdString() << std::endl;
+	if(format == FORMAT_RAW)
+		std::cout << "encode with: ffmpeg -f rawvideo -pix_fmt rgb24 -s " << size.width() << "x" << size.height() << " -r " << fps << " -i " << output.toStdString() << " out.mp4" << std::endl;
+	return true;
+}
+
+/*
+ * Runs on a pool thread, only reads members that exportLog() set up
+ * before the first frame was started.
+ */
+void LogExporter::renderFrame(const int frame, const std::vector<PositionMarker> &positions, const ExportScoreboard &scoreboard, const long long trail_since)
+{
+	QImage image = background.copy();
+	QPainter paint(&image);
+	paint.setRenderHint(QPainter::Antialiasing);
+	paint.setTransform(scene_transform);
+	// pool threads live for many frames, each keeps its own texts
+	static thread_local TextCache text_cache;
+	FieldPainter(config, view, &text_cache).drawMarkers(paint, positions, trail_since);
+
+	// game state, time and score in the top left corner
+	paint.resetTransform();
+	QFont font = paint.font();
+	font.setPointSize(std::max(8, image.height() / 40));
+	paint.setFont(font);
+	paint.setPen(QPen(Qt::white));
+	const QString caption = QString("%1  %2  %3  %4 - %5")
+		.arg(gameStateString(scoreboard.game_state))
+		.arg(timeString(scoreboard.remaining_time))
+		.arg(timeString(scoreboard.secondary_time))
+		.arg(scoreboard.score1)
+		.arg(scoreboard.score2);
+	paint.drawText(QPoint(10, 10 + QFontMetrics(font).ascent()), caption);
+	paint.end();
+
+	QByteArray data;
+	if(format == FORMAT_PNG) {
+		QBuffer buffer(&data);
+		buffer.open(QIODevice::WriteOnly);
+		image.save(&buffer, "PNG");
+	} else {
+		const QImage rgb = image.convertToFormat(QImage::Format_RGB888);
+		const int line_size = rgb.width() * 3;
+		data.reserve(line_size * rgb.height());
+		for(int y = 0; y < rgb.height(); y++)
+			data.append(reinterpret_cast<const char *>(rgb.constScanLine(y)), line_size);
+	}
+	mutex.lock();
+	done_frames[frame] = data;
+	mutex.unlock();
+	frame_done.wakeAll();
+}
+
+/*
+ * Write finished frames in frame order until fewer than max_pending of
+ * the submitted frames are unwritten, waiting for the workers if needed.
+ */
+bool LogExporter::writeReadyFrames(const int submitted, const int max_pending)
+{
+	mutex.lock();
+	while(submitted - next_write >= max_pending) {
+		std::map<int, QByteArray>::iterator it = done_frames.find(next_write);
+		if(it == done_frames.end()) {
+			frame_done.wait(&mutex);
+			continue;
+		}
+		const QByteArray data = it->second;
+		done_frames.erase(it);
+		mutex.unlock();
+		if(!writeFrame(next_write, data))
+			return false;
+		mutex.lock();
+		next_write++;
+	}
+	mutex.unlock();
+	return true;
+}
+
+bool LogExporter::writeFrame(const int frame, const QByteArray &data)
+{
+	if(format == FORMAT_PNG) {
+		QFile file(QDir(output).filePath(QString("frame_%1.png").arg(frame, 6, 10, QChar('0'))));
+		if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(data) != data.size()) {
+			std::cerr << "cannot write " << file.fileName().toStdString() << std::endl;
+			return false;
+		}
+		return true;
+	}
+	if(raw_file.write(data) != data.size()) {
+		std::cerr << "cannot write " << output.toStdString() << std::endl;
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,71 @@
+#ifndef LOG_EXPORTER_H
+#define LOG_EXPORTER_H
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <QByteArray>
+#include <QFile>
+#include <QImage>
+#include <QMutex>
+#include <QSize>
+#include <QString>
+#include <QTransform>
+#include <QWaitCondition>
+
+#include "log_reader.h"
+#include "monitor_config.h"
+#include "field_painter.h"
+
+/*
+ * Game state shown in the caption of exported frames.
+ */
+struct ExportScoreboard {
+	ExportScoreboard() : score1(0), score2(0), remaining_time(0), secondary_time(0), game_state(0) {}
+	int score1;
+	int score2;
+	int remaining_time;
+	int secondary_time;
+	int game_state;
+};
+
+/*
+ * Renders a log to a sequence of frames without a window.
+ *
+ * The log is replayed on the calling thread at a fixed frame rate; for
+ * every frame the information boxes are laid out there and the markers
+ * are copied. Drawing and encoding run on a QThreadPool with FieldPainter,
+ * the code that draws the monitor window. The calling thread writes the
+ * finished frames in frame order, either as numbered PNG files into a
+ * directory or as one stream of raw RGB24 frames. Only a few frames per
+ * worker are in flight, so memory use does not grow with the log.
+ */
+class LogExporter
+{
+public:
+	enum Format {
+		FORMAT_PNG,
+		FORMAT_RAW,
+	};
+	LogExporter(const std::shared_ptr<const MonitorConfig> &, const FieldView &);
+	bool exportLog(const std::vector<LogData> &, const QString &, const Format, const int, const QSize &);
+	void renderFrame(const int, const std::vector<PositionMarker> &, const ExportScoreboard &, const long long);
+private:
+	bool writeFrame(const int, const QByteArray &);
+	bool writeReadyFrames(const int, const int);
+	const std::shared_ptr<const MonitorConfig> config;
+	const FieldView view;
+	const FieldParameterInt field_param;
+	Format format;
+	QString output;
+	QImage background;
+	QTransform scene_transform;
+	QFile raw_file;
+	QMutex mutex;
+	QWaitCondition frame_done;
+	std::map<int, QByteArray> done_frames; // encoded, waiting for their turn
+	int next_write;
+};
+
+#endif // LOG_EXPORTER_H
@@ -0,0 +1,232 @@
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+
+#include <QString>
+#include <QStringList>
+
+#include "log_reader.h"
+#include "binary_log.h"
+#include "log_archive.h"
+
+static const long long DAY_MS = 24LL * 60 * 60 * 1000;
+
+static void parseLogLinesV1(const std::vector<std::string> &lines, std::vector<LogData> &log_data)
+{
+	for(const auto &line : lines) {
+		LogDataRobotComm buf;
+		QString qstr = QString(line.c_str());
+		QStringList list = qstr.split(QChar(','));
+
+		int size = list.size();
+		if(size == 17) {
+			strcpy(buf.time_str, list.at(0).toStdString().c_str());
+			buf.id = list.at(1).toInt();
+			strcpy(buf.color_str, list.at(2).toStdString().c_str());
+			buf.fps = list.at(3).toInt();
+			buf.voltage = list.at(4).toDouble();
+			buf.x = list.at(5).toInt();
+			buf.y = list.at(6).toInt();
+			buf.theta = list.at(7).toDouble();
+			buf.ball_x = list.at(8).toInt();
+			buf.ball_y = list.at(9).toInt();
+			buf.goal_pole_x1 = list.at(10).toInt();
+			buf.goal_pole_y1 = list.at(11).toInt();
+			buf.goal_pole_x2 = list.at(12).toInt();
+			buf.goal_pole_y2 = list.at(13).toInt();
+			buf.cf_own = list.at(14).toInt();
+			buf.cf_ball = list.at(15).toInt();
+			strcpy(buf.msg, list.at(16).toStdString().c_str());
+			LogData ldata;
+			ldata.type = LOG_TYPE_ROBOTINFO;
+			ldata.robot_comm = buf;
+			strcpy(ldata.time_str, list.at(0).toStdString().c_str());
+			log_data.push_back(ldata);
+		} else if(size == 2) {
+			LogData ldata;
+			ldata.type = LOG_TYPE_REMAININGTIME;
+			strcpy(ldata.time_str, list.at(0).toStdString().c_str());
+			ldata.remaining_time = list.at(1).toInt();
+			log_data.push_back(ldata);
+		} else if(size == 3) {
+			LogData ldata;
+			strcpy(ldata.time_str, list.at(0).toStdString().c_str());
+			int team_no = list.at(1).toInt();
+			if(team_no == 0) {
+				ldata.type = LOG_TYPE_SCORE1;
+				ldata.score1 = list.at(2).toInt();
+			} else if(team_no == 1) {
+				ldata.type = LOG_TYPE_SCORE2;
+				ldata.score2 = list.at(2).toInt();
+			} else {
+				continue;
+			}
+			log_data.push_back(ldata);
+		}
+	}
+}
+
+static void parseLogLinesV2(const std::vector<std::string> &lines, std::vector<LogData> &log_data)
+{
+	for(const auto &line : lines) {
+		LogDataRobotComm buf;
+		QString qstr = QString(line.c_str());
+		QStringList list = qstr.split(QChar(','));
+
+		int size = list.size();
+		if(size == 1) continue;
+		if(list[0] == "RobotInfo" && size == 18) {
+			strcpy(buf.time_str, list.at(1).toStdString().c_str());
+			buf.id = list.at(2).toInt();
+			strcpy(buf.color_str, list.at(3).toStdString().c_str());
+			buf.fps = list.at(4).toInt();
+			buf.voltage = list.at(5).toDouble();
+			buf.x = list.at(6).toInt();
+			buf.y = list.at(7).toInt();
+			buf.theta = list.at(8).toDouble();
+			buf.ball_x = list.at(9).toInt();
+			buf.ball_y = list.at(10).toInt();
+			buf.goal_pole_x1 = list.at(11).toInt();
+			buf.goal_pole_y1 = list.at(12).toInt();
+			buf.goal_pole_x2 = list.at(13).toInt();
+			buf.goal_pole_y2 = list.at(14).toInt();
+			buf.cf_own = list.at(15).toInt();
+			buf.cf_ball = list.at(16).toInt();
+			strcpy(buf.msg, list.at(17).toStdString().c_str());
+			LogData ldata;
+			ldata.type = LOG_TYPE_ROBOTINFO;
+			ldata.robot_comm = buf;
+			strcpy(ldata.time_str, list.at(1).toStdString().c_str());
+			log_data.push_back(ldata);
+		} else if(list[0] == "Score" && size == 4) {
+			LogData ldata;
+			strcpy(ldata.time_str, list.at(1).toStdString().c_str());
+			int team_no = list.at(2).toInt();
+			if(team_no == 0) {
+				ldata.type = LOG_TYPE_SCORE1;
+				ldata.score1 = list.at(3).toInt();
+			} else if(team_no == 1) {
+				ldata.type = LOG_TYPE_SCORE2;
+				ldata.score2 = list.at(3).toInt();
+			} else {
+				continue;
+			}
+			log_data.push_back(ldata);
+		} else if(list[0] == "RemainingTime" && size == 3) {
+			LogData ldata;
+			ldata.type = LOG_TYPE_REMAININGTIME;
+			strcpy(ldata.time_str, list.at(1).toStdString().c_str());
+			ldata.remaining_time = list.at(2).toInt();
+			log_data.push_back(ldata);
+		} else if(list[0] == "SecondaryTime" && size == 3) {
+			LogData ldata;
+			ldata.type = LOG_TYPE_SECONDARYTIME;
+			strcpy(ldata.time_str, list.at(1).toStdString().c_str());
+			ldata.secondary_time = list.at(2).toInt();
+			log_data.push_back(ldata);
+		} else if(list[0] == "GameState" && size == 3) {
+			LogData ldata;
+			ldata.type = LOG_TYPE_GAMESTATE;
+			strcpy(ldata.time_str, list.at(1).toStdString().c_str());
+			ldata.game_state = list.at(2).toInt();
+			log_data.push_back(ldata);
+		} else {
+			continue;
+		}
+	}
+}
+
+void parseLogLines(std::vector<std::string> lines, std::vector<LogData> &log_data)
+{
+	if(lines.empty())
+		return;
+	if(lines[0].find("Game Monitor") == std::string::npos) {
+		// version: 1.0
+		parseLogLinesV1(lines, log_data);
+	} else {
+		// version: 2.0, 2.1
+		lines.erase(lines.begin()); // erase first element, it's version signature
+		parseLogLinesV2(lines, log_data);
+	}
+}
+
+bool readLogFile(const std::string &file_name, std::vector<LogData> &log_data)
+{
+	if(isBinaryLog(file_name))
+		return readBinaryLog(file_name, log_data);
+	if(isLogArchive(file_name))
+		return readLogArchive(file_name, log_data);
+	std::ifstream ifs(file_name);
+	if(ifs.fail()) {
+		std::cerr << "file open error" << std::endl;
+		return false;
+	}
+	std::string line;
+	std::vector<std::string> lines;
+	while(getline(ifs, line)) {
+		lines.push_back(line);
+	}
+	parseLogLines(lines, log_data);
+	return true;
+}
+
+long long logTimeMs(const char *time_str)
+{
+	int h, m, s, n = 0;
+	if(sscanf(time_str, "%d:%d:%d%n", &h, &m, &s, &n) != 3)
+		return -1;
+	// milliseconds since format 2.1
+	int ms = 0;
+	if(time_str[n] == '.') {
+		int scale = 100;
+		for(const char *p = time_str + n + 1; *p >= '0' && *p <= '9' && scale > 0; p++, scale /= 10)
+			ms += (*p - '0') * scale;
+	}
+	return ((h * 60LL + m) * 60 + s) * 1000 + ms;
+}
+
+/*
+ * Format a log time as "h:m:s.mmm", wrapping it into one day.
+ */
+void logTimeString(char *time_str, const size_t size, long long time_ms)
+{
+	time_ms = (time_ms % DAY_MS + DAY_MS) % DAY_MS;
+	const long long seconds = time_ms / 1000;
+	snprintf(time_str, size, "%d:%d:%d.%03d", static_cast<int>(seconds / 3600), static_cast<int>(seconds / 60 % 60), static_cast<int>(seconds % 60), static_cast<int>(time_ms % 1000));
+}
+
+/*
+ * Times of all entries in milliseconds since the first valid one, whose
+ * time of day is returned (0 if there is none). A time before the
+ * previous one is taken to be past midnight, and times never go back, so
+ * entries without a valid time get the previous one.
+ */
+long long logTimesMs(const std::vector<LogData> &log_data, std::vector<long long> &times)
+{
+	long long start = -1;
+	for(size_t i = 0; i < log_data.size() && start < 0; i++)
+		start = logTimeMs(log_data[i].time_str);
+	if(start < 0)
+		start = 0;
+	times.resize(log_data.size());
+	long long previous = 0;
+	long long day_offset = 0;
+	for(size_t i = 0; i < log_data.size(); i++) {
+		long long t = logTimeMs(log_data[i].time_str);
+		if(t < 0) {
+			t = previous;
+		} else {
+			t += day_offset - start;
+			if(t < previous - DAY_MS / 2) {
+				day_offset += DAY_MS;
+				t += DAY_MS;
+			}
+			if(t < previous)
+				t = previous;
+		}
+		times[i] = t;
+		previous = t;
+	}
+	return start;
+}
@@ -0,0 +1,70 @@
+#ifndef LOG_READER_H
+#define LOG_READER_H
+
+#include <cstddef>
+#include <vector>
+#include <string>
+
+static const int LOG_TYPE_ROBOTINFO = 0;
+static const int LOG_TYPE_SCORE1 = 1;
+static const int LOG_TYPE_SCORE2 = 2;
+static const int LOG_TYPE_REMAININGTIME = 3;
+static const int LOG_TYPE_SECONDARYTIME = 4;
+static const int LOG_TYPE_GAMESTATE = 5;
+
+class LogDataRobotComm {
+public:
+	LogDataRobotComm() : temperature(0.0) { }
+	char time_str[100];
+	int id;
+	char color_str[100];
+	int fps;
+	double voltage;
+	double temperature;
+	int x;
+	int y;
+	double theta;
+	int ball_x;
+	int ball_y;
+	int goal_pole_x1;
+	int goal_pole_y1;
+	int goal_pole_x2;
+	int goal_pole_y2;
+	int cf_own;
+	int cf_ball;
+	char msg[100];
+};
+
+class LogData
+{
+public:
+	LogData() : type(0), score1(0), score2(0), remaining_time(0), secondary_time(0), game_state(0) { }
+	~LogData() { }
+	int type;
+	LogDataRobotComm robot_comm;
+	int score1;
+	int score2;
+	int remaining_time;
+	int secondary_time;
+	int game_state;
+	char time_str[100];
+};
+
+/*
+ * Reading of the text logs written by LogWriter, used by the log player
+ * of the monitor window and by the headless exporter. The text formats
+ * 1.0 (no header), 2.0 and 2.1 (times with milliseconds) are accepted, as
+ * well as binary logs (binary_log.h) and archives (log_archive.h).
+ */
+bool readLogFile(const std::string &, std::vector<LogData> &);
+void parseLogLines(std::vector<std::string>, std::vector<LogData> &);
+
+/*
+ * Milliseconds since midnight of a "hh:mm:ss" or "hh:mm:ss.mmm" log time,
+ * -1 if the string is not a log time.
+ */
+long long logTimeMs(const char *);
+void logTimeString(char *, const size_t, long long);
+long long logTimesMs(const std::vector<LogData> &, std::vector<long long> &);
+
+#endif // LOG_READER_H
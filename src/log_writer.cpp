@@ -1,163 +1,239 @@
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <cstdio>
+#include <cstring>
 #include <ctime>
+#ifdef __unix__
+#include <unistd.h>
+#endif
 
 #include "log_writer.h"
+#include "binary_log.h"
+#include "robot_registry.h"
 
-LogWriter::LogWriter() : opened(false), enable(false)
+// binary records keep the type and the field layout of the queued records
+enum {
+	LOG_RECORD_ROBOT = BINARY_LOG_ROBOT,
+	LOG_RECORD_SCORE = BINARY_LOG_SCORE,
+	LOG_RECORD_REMAINING_TIME = BINARY_LOG_REMAINING_TIME,
+	LOG_RECORD_SECONDARY_TIME = BINARY_LOG_SECONDARY_TIME,
+	LOG_RECORD_GAME_STATE = BINARY_LOG_GAME_STATE,
+	LOG_RECORD_LINK_QUALITY = BINARY_LOG_LINK_QUALITY,
+	LOG_RECORD_START = BINARY_LOG_RECORD_START,
+	LOG_RECORD_STOP = BINARY_LOG_RECORD_STOP,
+	LOG_RECORD_SEPARATE = BINARY_LOG_SEPARATE,
+};
+
+static const size_t FILE_BUFFER_SIZE = 1024 * 1024;
+
+static long long monotonicMicroseconds(void)
+{
+	using namespace std::chrono;
+	return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// localtime_r() is POSIX, Windows has localtime_s() with the arguments swapped
+static void localTime(const time_t timer, struct tm &local_time)
+{
+#ifdef _WIN32
+	localtime_s(&local_time, &timer);
+#else
+	localtime_r(&timer, &local_time);
+#endif
+}
+
+static void copyString(char *dst, const size_t size, const char *src)
 {
+	strncpy(dst, src, size - 1);
+	dst[size - 1] = '\0';
+}
+
+LogWriter::LogWriter(const std::string &name_suffix) : fp(nullptr), opened(false), file_binary(false), wall_offset_us(0), start_us(0), robot_objects(RobotRegistry::MAX_ROBOTS), enable(false), suffix(name_suffix), queue(QUEUE_SIZE), max_queue_depth(0), dropped(0), packet_queue(PACKET_QUEUE_SIZE), dropped_packets(0), image_width(0), image_height(0), image_scale_x(0.0), image_scale_y(0.0), flush_interval_ms(200), fsync_enabled(false), binary(false), stopping(false)
+{
+	writer = std::thread(&LogWriter::run, this);
 }
 
 LogWriter::~LogWriter()
 {
-	closeFile();
+	stop();
 }
 
-void LogWriter::openFileCurrentTime(void)
+/*
+ * Write out what is queued, close the file and end the writer thread.
+ * Records written after this are dropped.
+ */
+void LogWriter::stop(void)
+{
+	stop_mutex.lock();
+	stopping = true;
+	stop_mutex.unlock();
+	stop_condition.notify_one();
+	if(writer.joinable())
+		writer.join();
+}
+
+void LogWriter::openFileCurrentTime(const log_record_T &first)
 {
 	time_t timer;
-	struct tm *local_time;
+	struct tm local_time;
 	char filename[1024];
 	char logfile_path[] = "log/";
 
+	// runs on the writer thread
+	file_binary = binary;
+	wall_offset_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count() - monotonicMicroseconds();
 	timer = time(NULL);
-	local_time = localtime(&timer);
-	sprintf(filename, "%s%d-%d-%d-%d-%d.log", logfile_path, local_time->tm_year+1900, local_time->tm_mon+1, local_time->tm_mday, local_time->tm_hour, local_time->tm_min);
+	localTime(timer, local_time);
+	sprintf(filename, "%s%d-%d-%d-%d-%d%s.%s", logfile_path, local_time.tm_year+1900, local_time.tm_mon+1, local_time.tm_mday, local_time.tm_hour, local_time.tm_min, suffix.c_str(), file_binary ? "bin" : "log");
 	openFile(filename);
-	printVersionInfo();
+	if(!opened)
+		return;
+	if(file_binary) {
+		// time 0 is the first record, on a whole millisecond
+		start_us = first.time_us - (first.time_us + wall_offset_us) % 1000;
+		const long long start_wall_ms = (start_us + wall_offset_us) / 1000;
+		const time_t start_time = static_cast<time_t>(start_wall_ms / 1000);
+		localTime(start_time, local_time);
+		binary_log_header_T header;
+		initBinaryLogHeader(header, (local_time.tm_year + 1900) * 10000 + (local_time.tm_mon + 1) * 100 + local_time.tm_mday,
+			((local_time.tm_hour * 60 + local_time.tm_min) * 60 + local_time.tm_sec) * 1000 + static_cast<int>(start_wall_ms % 1000));
+		fwrite(&header, sizeof(header), 1, fp);
+	} else {
+		printVersionInfo();
+	}
 }
 
 int LogWriter::startRecord(const char *filename)
 {
-	time_t timer;
-	struct tm *local_time;
-
-	timer = time(NULL);
-	local_time = localtime(&timer);
-	if(enable && !opened)
-		openFileCurrentTime();
-	if(opened && enable) {
-		fprintf(fp, "RecordStart,%d:%d:%d,", local_time->tm_hour, local_time->tm_min, local_time->tm_sec);
-		fprintf(fp, "%s", "record,");
-		fprintf(fp, "%s", filename);
-		fprintf(fp, "\n");
-	}
+	if(!enable)
+		return 0;
+	log_record_T record = log_record_T();
+	record.type = LOG_RECORD_START;
+	copyString(record.text, sizeof(record.text), filename);
+	push(record);
 	return 0;
 }
 
 int LogWriter::stopRecord(void)
 {
-	time_t timer;
-	struct tm *local_time;
-
-	timer = time(NULL);
-	local_time = localtime(&timer);
-	if(opened && enable) {
-		fprintf(fp, "RecordStop,%d:%d:%d,", local_time->tm_hour, local_time->tm_min, local_time->tm_sec);
-		fprintf(fp, "%s", "stop");
-		fprintf(fp, "\n");
-	}
+	if(!enable)
+		return 0;
+	log_record_T record = log_record_T();
+	record.type = LOG_RECORD_STOP;
+	push(record);
 	return 0;
 }
 
 int LogWriter::write(int id, const char *color, int fps, double voltage,
 	int posx, int posy, float posth, int ballx, int bally,
 	int goal_pole_x1, int goal_pole_y1, int goal_pole_x2, int goal_pole_y2,
-	const char *str, int cf_own, int cf_ball)
+	const char *str, int cf_own, int cf_ball, const long long receive_time)
 {
-	time_t timer;
-	struct tm *local_time;
+	if(!enable)
+		return 0;
+	log_record_T record = log_record_T();
+	record.type = LOG_RECORD_ROBOT;
+	record.values[0] = id;
+	record.values[1] = fps;
+	record.values[2] = posx;
+	record.values[3] = posy;
+	record.values[4] = ballx;
+	record.values[5] = bally;
+	record.values[6] = goal_pole_x1;
+	record.values[7] = goal_pole_y1;
+	record.values[8] = goal_pole_x2;
+	record.values[9] = goal_pole_y2;
+	record.values[10] = cf_own;
+	record.values[11] = cf_ball;
+	record.reals[0] = voltage;
+	record.reals[1] = posth;
+	copyString(record.color, sizeof(record.color), color);
+	copyString(record.text, sizeof(record.text), str);
+	push(record, receive_time);
+	return 0;
+}
 
-	timer = time(NULL);
-	local_time = localtime(&timer);
-	if(enable && !opened)
-		openFileCurrentTime();
-	if(opened && enable) {
-		fprintf(fp, "RobotInfo,%d:%d:%d,", local_time->tm_hour, local_time->tm_min, local_time->tm_sec);
-		fprintf(fp, "%d,", id);
-		fprintf(fp, "%s,", color);
-		fprintf(fp, "%d,", fps);
-		fprintf(fp, "%.2lf,", voltage);
-		fprintf(fp, "%d,%d,%f,", posx, posy, posth);
-		fprintf(fp, "%d,%d,", ballx, bally);
-		fprintf(fp, "%d,%d,", goal_pole_x1, goal_pole_y1);
-		fprintf(fp, "%d,%d,", goal_pole_x2, goal_pole_y2);
-		fprintf(fp, "%d,%d,", cf_own, cf_ball);
-		fprintf(fp, "%s", str);
-		fprintf(fp, "\n");
+/*
+ * Queue a received robot packet, to be decoded on the writer thread. Has
+ * to be called from one thread, the network thread; false if the packet
+ * was dropped.
+ */
+bool LogWriter::writePacket(const comm_packet_T &packet)
+{
+	if(!enable)
+		return true;
+	if(!packet_queue.push(packet)) {
+		dropped_packets.fetch_add(1, std::memory_order_relaxed);
+		return false;
 	}
-	return 0;
+	return true;
 }
 
 void LogWriter::writeScore(const int team_no, const int score)
 {
-	time_t timer;
-	struct tm *local_time;
-
-	timer = time(NULL);
-	local_time = localtime(&timer);
-	if(enable && !opened)
-		openFileCurrentTime();
-	if(opened && enable) {
-		fprintf(fp, "Score,%d:%d:%d,", local_time->tm_hour, local_time->tm_min, local_time->tm_sec);
-		fprintf(fp, "%d,%d", team_no, score);
-		fprintf(fp, "\n");
-	}
+	if(!enable)
+		return;
+	log_record_T record = log_record_T();
+	record.type = LOG_RECORD_SCORE;
+	record.values[0] = team_no;
+	record.values[1] = score;
+	push(record);
 }
 
 void LogWriter::writeRemainingTime(const int remaining_time)
 {
-	time_t timer;
-	struct tm *local_time;
-
-	timer = time(NULL);
-	local_time = localtime(&timer);
-	if(enable && !opened)
-		openFileCurrentTime();
-	if(opened && enable) {
-		fprintf(fp, "RemainingTime,%d:%d:%d,", local_time->tm_hour, local_time->tm_min, local_time->tm_sec);
-		fprintf(fp, "%d", remaining_time);
-		fprintf(fp, "\n");
-	}
+	if(!enable)
+		return;
+	log_record_T record = log_record_T();
+	record.type = LOG_RECORD_REMAINING_TIME;
+	record.values[0] = remaining_time;
+	push(record);
 }
 
 void LogWriter::writeSecondaryTime(const int secondary_time)
 {
-	time_t timer;
-	struct tm *local_time;
-
-	timer = time(NULL);
-	local_time = localtime(&timer);
-	if(enable && !opened)
-		openFileCurrentTime();
-	if(opened && enable) {
-		fprintf(fp, "SecondaryTime,%d:%d:%d,", local_time->tm_hour, local_time->tm_min, local_time->tm_sec);
-		fprintf(fp, "%d", secondary_time);
-		fprintf(fp, "\n");
-	}
+	if(!enable)
+		return;
+	log_record_T record = log_record_T();
+	record.type = LOG_RECORD_SECONDARY_TIME;
+	record.values[0] = secondary_time;
+	push(record);
 }
 
 void LogWriter::writeGameState(const int game_state)
 {
-	time_t timer;
-	struct tm *local_time;
+	if(!enable)
+		return;
+	log_record_T record = log_record_T();
+	record.type = LOG_RECORD_GAME_STATE;
+	record.values[0] = game_state;
+	push(record);
+}
 
-	timer = time(NULL);
-	local_time = localtime(&timer);
-	if(enable && !opened)
-		openFileCurrentTime();
-	if(opened && enable) {
-		fprintf(fp, "GameState,%d:%d:%d,", local_time->tm_hour, local_time->tm_min, local_time->tm_sec);
-		fprintf(fp, "%d", game_state);
-		fprintf(fp, "\n");
-	}
+void LogWriter::writeLinkQuality(const int id, const char *color_str, const double packets_per_second, const double jitter_ms, const double longest_gap_ms, const unsigned int socket_drops)
+{
+	if(!enable)
+		return;
+	log_record_T record = log_record_T();
+	record.type = LOG_RECORD_LINK_QUALITY;
+	record.values[0] = id;
+	record.values[1] = static_cast<int>(socket_drops);
+	record.reals[0] = packets_per_second;
+	record.reals[1] = jitter_ms;
+	record.reals[2] = longest_gap_ms;
+	copyString(record.color, sizeof(record.color), color_str);
+	push(record);
 }
 
 int LogWriter::separate(void)
 {
-	if(opened && enable) {
-		fprintf(fp, "\n---\n");
-	}
+	if(!enable)
+		return 0;
+	log_record_T record = log_record_T();
+	record.type = LOG_RECORD_SEPARATE;
+	push(record);
 	return 0;
 }
 
@@ -166,20 +242,295 @@ void LogWriter::setEnable(bool benable)
 	enable = benable;
 }
 
+/*
+ * Whether the next log file is a binary log. The current file keeps its
+ * format.
+ */
+void LogWriter::setBinary(const bool binary_format)
+{
+	binary = binary_format;
+}
+
+/*
+ * Size of the field image and field millimeters per pixel, for the
+ * positions of robot packets. May be called from any thread.
+ */
+void LogWriter::setImageScale(const int width, const int height, const double scale_x, const double scale_y)
+{
+	std::lock_guard<std::mutex> lock(scale_mutex);
+	image_width = width;
+	image_height = height;
+	image_scale_x = scale_x;
+	image_scale_y = scale_y;
+}
+
+/*
+ * How often the writer thread writes out the queued records, and whether
+ * they are also synced to disk then. May be called from any thread.
+ */
+void LogWriter::setFlushPolicy(const int interval_ms, const bool fsync)
+{
+	flush_interval_ms = interval_ms > 0 ? interval_ms : 1;
+	fsync_enabled = fsync;
+}
+
+size_t LogWriter::queueDepth(void) const
+{
+	return queue.size();
+}
+
+size_t LogWriter::maxQueueDepth(void) const
+{
+	return max_queue_depth;
+}
+
+unsigned long long LogWriter::droppedCount(void) const
+{
+	return dropped;
+}
+
+size_t LogWriter::packetQueueDepth(void) const
+{
+	return packet_queue.size();
+}
+
+unsigned long long LogWriter::droppedPacketCount(void) const
+{
+	return dropped_packets.load(std::memory_order_relaxed);
+}
+
+const LatencyHistogram &LogWriter::writeTime(void) const
+{
+	return write_time;
+}
+
+/*
+ * Writer thread: decode a robot packet into a robot record, in field image
+ * pixels as the monitor draws it. Objects the packet does not carry keep
+ * the position this robot sent last.
+ */
+void LogWriter::packetRecord(const comm_packet_T &packet, log_record_T &record)
+{
+	const struct comm_info_T &comm_info = packet.comm_info;
+	int width, height;
+	double scale_x, scale_y;
+	{
+		std::lock_guard<std::mutex> lock(scale_mutex);
+		width = image_width;
+		height = image_height;
+		scale_x = image_scale_x;
+		scale_y = image_scale_y;
+	}
+	robot_objects_T &objects = robot_objects[comm_info.id];
+	int goal_pole_index = 0;
+	CommInfoObjects objs;
+	decodeCommInfoObjects(comm_info.object, objs);
+	for(int i = 0; i < MAX_COMM_INFO_OBJ; i++) {
+		int *xy;
+		if(objs.type[i] == SELF_POS)
+			xy = &objects.values[0];
+		else if(objs.type[i] == BALL)
+			xy = &objects.values[2];
+		else if(objs.type[i] == GOAL_POLE && goal_pole_index < 2)
+			xy = &objects.values[4 + 2 * goal_pole_index++];
+		else
+			continue;
+		xy[0] = width - static_cast<int>(objs.x[i] * scale_x + width / 2.0);
+		xy[1] = static_cast<int>(objs.y[i] * scale_y + height / 2.0);
+		if(objs.type[i] == SELF_POS)
+			objects.theta = static_cast<float>(-objs.th[i] + M_PI);
+	}
+
+	record = log_record_T();
+	record.type = LOG_RECORD_ROBOT;
+	record.time_us = packet.receive_time;
+	record.values[0] = RobotRegistry::idOf(comm_info.id);
+	record.values[1] = comm_info.fps;
+	for(int i = 0; i < 8; i++)
+		record.values[2 + i] = objects.values[i];
+	record.values[10] = comm_info.cf_own;
+	record.values[11] = comm_info.cf_ball;
+	record.reals[0] = (comm_info.voltage << 3) / 100.0;
+	record.reals[1] = objects.theta;
+	snprintf(record.color, sizeof(record.color), "%s %d", RobotRegistry::colorOf(comm_info.id) == MAGENTA ? "MAGENTA" : "CYAN", RobotRegistry::idOf(comm_info.id));
+	copyString(record.text, std::min(sizeof(record.text), sizeof(comm_info.command) + 1), reinterpret_cast<const char *>(comm_info.command));
+}
+
+/*
+ * Producer side: stamps the record with the given monotonic time, or the
+ * current one if it is negative, and queues it.
+ */
+bool LogWriter::push(log_record_T &record, const long long time_us)
+{
+	record.time_us = time_us < 0 ? monotonicMicroseconds() : time_us;
+	if(!queue.push(record)) {
+		dropped++;
+		return false;
+	}
+	// only the producer raises the maximum
+	const size_t depth = queue.size();
+	if(depth > max_queue_depth)
+		max_queue_depth = depth;
+	return true;
+}
+
+/*
+ * Writer thread: every flush interval, write out everything that was
+ * queued in batches and flush it. Records and robot packets come from two
+ * queues and are merged by time, each queue being in time order. On
+ * shutdown the queues are drained once more.
+ */
+void LogWriter::run(void)
+{
+	for(;;) {
+		bool stop;
+		{
+			std::unique_lock<std::mutex> lock(stop_mutex);
+			stop_condition.wait_for(lock, std::chrono::milliseconds(flush_interval_ms.load()), [this] { return stopping; });
+			stop = stopping;
+		}
+		log_record_T record, packet_record;
+		comm_packet_T packet;
+		bool has_record = queue.pop(record);
+		bool has_packet = packet_queue.pop(packet);
+		if(has_packet)
+			packetRecord(packet, packet_record);
+		bool written = false;
+		while(has_record || has_packet) {
+			ScopedTimer batch_timer(write_time);
+			for(int count = 0; count < BATCH_SIZE && (has_record || has_packet); count++) {
+				if(has_record && (!has_packet || record.time_us <= packet_record.time_us)) {
+					writeRecord(record);
+					has_record = queue.pop(record);
+				} else {
+					writeRecord(packet_record);
+					has_packet = packet_queue.pop(packet);
+					if(has_packet)
+						packetRecord(packet, packet_record);
+				}
+			}
+			written = true;
+		}
+		if(written && opened) {
+			fflush(fp);
+#ifdef __unix__
+			if(fsync_enabled)
+				fsync(fileno(fp));
+#endif
+		}
+		if(stop && queue.size() == 0 && packet_queue.size() == 0)
+			break;
+	}
+	closeFile();
+}
+
+void LogWriter::writeRecord(const log_record_T &record)
+{
+	if(record.type == LOG_RECORD_SEPARATE || record.type == LOG_RECORD_STOP) {
+		if(!opened)
+			return;
+	} else if(!opened) {
+		openFileCurrentTime(record);
+		if(!opened)
+			return;
+	}
+	if(file_binary) {
+		writeBinaryRecord(record);
+		return;
+	}
+	const long long wall_ms = (record.time_us + wall_offset_us) / 1000;
+	const time_t timer = static_cast<time_t>(wall_ms / 1000);
+	const int ms = static_cast<int>(wall_ms % 1000);
+	struct tm local_time;
+	localTime(timer, local_time);
+	const int *v = record.values;
+	switch(record.type) {
+	case LOG_RECORD_ROBOT:
+		fprintf(fp, "RobotInfo,%d:%d:%d.%03d,", local_time.tm_hour, local_time.tm_min, local_time.tm_sec, ms);
+		fprintf(fp, "%d,", v[0]);
+		fprintf(fp, "%s,", record.color);
+		fprintf(fp, "%d,", v[1]);
+		fprintf(fp, "%.2lf,", record.reals[0]);
+		fprintf(fp, "%d,%d,%f,", v[2], v[3], record.reals[1]);
+		fprintf(fp, "%d,%d,", v[4], v[5]);
+		fprintf(fp, "%d,%d,", v[6], v[7]);
+		fprintf(fp, "%d,%d,", v[8], v[9]);
+		fprintf(fp, "%d,%d,", v[10], v[11]);
+		fprintf(fp, "%s", record.text);
+		fprintf(fp, "\n");
+		break;
+	case LOG_RECORD_SCORE:
+		fprintf(fp, "Score,%d:%d:%d.%03d,", local_time.tm_hour, local_time.tm_min, local_time.tm_sec, ms);
+		fprintf(fp, "%d,%d", v[0], v[1]);
+		fprintf(fp, "\n");
+		break;
+	case LOG_RECORD_REMAINING_TIME:
+		fprintf(fp, "RemainingTime,%d:%d:%d.%03d,", local_time.tm_hour, local_time.tm_min, local_time.tm_sec, ms);
+		fprintf(fp, "%d", v[0]);
+		fprintf(fp, "\n");
+		break;
+	case LOG_RECORD_SECONDARY_TIME:
+		fprintf(fp, "SecondaryTime,%d:%d:%d.%03d,", local_time.tm_hour, local_time.tm_min, local_time.tm_sec, ms);
+		fprintf(fp, "%d", v[0]);
+		fprintf(fp, "\n");
+		break;
+	case LOG_RECORD_GAME_STATE:
+		fprintf(fp, "GameState,%d:%d:%d.%03d,", local_time.tm_hour, local_time.tm_min, local_time.tm_sec, ms);
+		fprintf(fp, "%d", v[0]);
+		fprintf(fp, "\n");
+		break;
+	case LOG_RECORD_LINK_QUALITY:
+		fprintf(fp, "LinkQuality,%d:%d:%d.%03d,", local_time.tm_hour, local_time.tm_min, local_time.tm_sec, ms);
+		fprintf(fp, "%d,%s,%.2lf,%.2lf,%.0lf,%u", v[0], record.color, record.reals[0], record.reals[1], record.reals[2], static_cast<unsigned int>(v[1]));
+		fprintf(fp, "\n");
+		break;
+	case LOG_RECORD_START:
+		fprintf(fp, "RecordStart,%d:%d:%d.%03d,", local_time.tm_hour, local_time.tm_min, local_time.tm_sec, ms);
+		fprintf(fp, "%s", "record,");
+		fprintf(fp, "%s", record.text);
+		fprintf(fp, "\n");
+		break;
+	case LOG_RECORD_STOP:
+		fprintf(fp, "RecordStop,%d:%d:%d.%03d,", local_time.tm_hour, local_time.tm_min, local_time.tm_sec, ms);
+		fprintf(fp, "%s", "stop");
+		fprintf(fp, "\n");
+		break;
+	case LOG_RECORD_SEPARATE:
+		fprintf(fp, "\n---\n");
+		break;
+	}
+}
+
+void LogWriter::writeBinaryRecord(const log_record_T &record)
+{
+	static_assert(sizeof(log_record_T::color) == sizeof(binary_log_record_T::color) && sizeof(log_record_T::text) == sizeof(binary_log_record_T::text), "record string sizes");
+	binary_log_record_T binary_record;
+	binary_record.type = record.type;
+	binary_record.time_us = record.time_us - start_us;
+	memcpy(binary_record.values, record.values, sizeof(binary_record.values));
+	for(int i = 0; i < 3; i++)
+		binary_record.reals[i] = static_cast<float>(record.reals[i]);
+	memcpy(binary_record.color, record.color, sizeof(binary_record.color));
+	memcpy(binary_record.text, record.text, sizeof(binary_record.text));
+	fwrite(&binary_record, sizeof(binary_record), 1, fp);
+}
+
 void LogWriter::openFile(char *filename)
 {
 	closeFile();
-	fp = fopen(filename, "w");
+	fp = fopen(filename, file_binary ? "wb" : "w");
 	if(fp) {
+		// records are written in batches, buffer a whole batch
+		file_buffer.resize(FILE_BUFFER_SIZE);
+		setvbuf(fp, file_buffer.data(), _IOFBF, file_buffer.size());
 		opened = true;
-		enable = true;
 	}
 }
 
 void LogWriter::printVersionInfo(void)
 {
 	constexpr int MAJOR_VERSION = 2;
-	constexpr int MINOR_VERSION = 0;
+	constexpr int MINOR_VERSION = 1;
 	fprintf(fp, "Game Monitor, version: %d.%d\n", MAJOR_VERSION, MINOR_VERSION);
 }
 
@@ -188,7 +539,5 @@ void LogWriter::closeFile(void)
 	if(opened) {
 		fclose(fp);
 	}
-	enable = false;
 	opened = false;
 }
-
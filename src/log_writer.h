@@ -1,28 +1,131 @@
 #ifndef LOG_H
 #define LOG_H
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "comm_info.h"
+#include "perf_counters.h"
+#include "spsc_queue.h"
+
+/*
+ * One log line as pushed by the producer, formatted on the writer thread.
+ * The meaning of the fields depends on the type.
+ */
+struct log_record_T {
+	int type;
+	long long time_us; // monotonic clock (std::chrono::steady_clock)
+	int values[12];
+	double reals[3];
+	char color[16];
+	char text[80];
+};
+
+/*
+ * Writes the game log. All write*() calls only copy a record into a
+ * lock-free queue and return; a writer thread opens the file, formats the
+ * records and writes them in batches. The batches are flushed every
+ * flush interval, and also synced to disk if fsync is enabled. The file
+ * is either a text log (format 2.1) or a binary log (binary_log.h).
+ *
+ * Records carry monotonic times, the receive time for robot data, so the
+ * log keeps the spacing of the packets even if the wall clock is set. The
+ * wall clock times in the file are those monotonic times moved by the
+ * offset of the two clocks when the file was opened.
+ *
+ * The write*() calls have to come from one thread. If the writer falls so
+ * far behind that the queue is full, new records are dropped and counted
+ * instead of waiting for the disk.
+ *
+ * Robot packets come straight from the network thread through a queue of
+ * their own, writePacket(), and are decoded and formatted on the writer
+ * thread, so logging every packet costs the GUI thread nothing. Positions
+ * are logged in field image pixels (setImageScale()); objects a packet
+ * does not carry keep the position the robot sent last. The packet queue
+ * holds PACKET_QUEUE_SIZE packets, over ten seconds of twelve robots at
+ * 100 packets per second, and the writer empties it every flush interval.
+ * It only fills up when the writer thread is stalled on the disk that
+ * long; then packets are dropped and counted like the other records,
+ * rather than blocking the receive path.
+ */
 class LogWriter {
 public:
-	LogWriter();
+	LogWriter(const std::string & = std::string());
 	~LogWriter();
 	int startRecord(const char *);
 	int stopRecord(void);
-	int write(int, const char *, int, double, int, int, float, int, int, int, int, int, int, const char *, int, int);
+	int write(int, const char *, int, double, int, int, float, int, int, int, int, int, int, const char *, int, int, const long long = -1);
 	void writeScore(const int, const int);
 	void writeRemainingTime(const int);
 	void writeSecondaryTime(const int);
 	void writeGameState(const int);
+	void writeLinkQuality(const int, const char *, const double, const double, const double, const unsigned int);
 	int separate(void);
 	void setEnable(bool = true);
+	void setFlushPolicy(const int, const bool);
+	void setBinary(const bool);
+	void setImageScale(const int, const int, const double, const double);
+	void stop(void);
+	// from the network thread
+	bool writePacket(const comm_packet_T &);
+	// backpressure, may be read from any thread
+	size_t queueDepth(void) const;
+	size_t maxQueueDepth(void) const;
+	unsigned long long droppedCount(void) const;
+	size_t packetQueueDepth(void) const;
+	unsigned long long droppedPacketCount(void) const;
+	const LatencyHistogram &writeTime(void) const;
 private:
-	void openFileCurrentTime(void);
+	static const int QUEUE_SIZE = 8192;
+	static const int BATCH_SIZE = 1024;
+	static const int PACKET_QUEUE_SIZE = 16384;
+	// last position a robot sent of each object, in field image pixels
+	struct robot_objects_T {
+		int values[8]; // x, y, ball x, ball y, goal poles x1 y1 x2 y2
+		float theta;
+	};
+	bool push(log_record_T &, const long long = -1);
+	void run(void);
+	void writeRecord(const log_record_T &);
+	void writeBinaryRecord(const log_record_T &);
+	void packetRecord(const comm_packet_T &, log_record_T &);
+	void openFileCurrentTime(const log_record_T &);
 	void openFile(char *);
 	void printVersionInfo(void);
 	void closeFile(void);
+	// writer thread only
 	FILE *fp;
 	bool opened;
-	bool enable;
+	bool file_binary;
+	long long wall_offset_us; // wall clock minus monotonic clock
+	long long start_us; // time 0 of a binary file
+	std::vector<char> file_buffer;
+	std::vector<robot_objects_T> robot_objects; // by comm_info_T::id
+	// shared
+	std::atomic<bool> enable;
+	const std::string suffix; // appended to the file name, e.g. "-field2"
+	SpscQueue<log_record_T> queue;
+	std::atomic<size_t> max_queue_depth;
+	std::atomic<unsigned long long> dropped;
+	SpscQueue<comm_packet_T> packet_queue;
+	std::atomic<unsigned long long> dropped_packets;
+	std::mutex scale_mutex;
+	int image_width;
+	int image_height;
+	double image_scale_x;
+	double image_scale_y;
+	std::atomic<int> flush_interval_ms;
+	std::atomic<bool> fsync_enabled;
+	std::atomic<bool> binary; // format of the next file
+	LatencyHistogram write_time; // per batch
+	std::mutex stop_mutex;
+	std::condition_variable stop_condition;
+	bool stopping;
+	std::thread writer;
 };
 
 #endif // LOG_H
-
@@ -1,13 +1,191 @@
+#include <iostream>
+#include <cstring>
+
 #include <QtGui>
+#include <QTabWidget>
+#include <QCommandLineParser>
 #include "interface.h"
+#include "log_exporter.h"
+#include "binary_log.h"
+#include "log_archive.h"
+
+/*
+ * game_monitor --export LOG --output PATH [--format png|raw] [--fps N]
+ *              [--size WxH] [--reverse] [--trails]
+ * renders a log file to image files or raw video frames without a window.
+ */
+static int exportLog(int argc, char **argv)
+{
+	// no window is shown, so do not depend on a display
+	if(qgetenv("QT_QPA_PLATFORM").isEmpty())
+		qputenv("QT_QPA_PLATFORM", "offscreen");
+	QGuiApplication app(argc, argv);
+	QCommandLineParser parser;
+	parser.addHelpOption();
+	parser.addOption(QCommandLineOption("export", "Log file to export.", "log"));
+	parser.addOption(QCommandLineOption("output", "Directory of the PNG files, or the raw video file.", "path"));
+	parser.addOption(QCommandLineOption("format", "png (default) or raw (RGB24 frames).", "format", "png"));
+	parser.addOption(QCommandLineOption("fps", "Frames per second of log time (30).", "fps", "30"));
+	parser.addOption(QCommandLineOption("size", "Frame size WxH, the field image size by default.", "size"));
+	parser.addOption(QCommandLineOption("reverse", "Reverse the field."));
+	parser.addOption(QCommandLineOption("trails", "Draw robot and ball trails."));
+	parser.process(app);
+
+	const QString output = parser.value("output");
+	if(output.isEmpty()) {
+		std::cerr << "--output is required" << std::endl;
+		return 1;
+	}
+	const QString format = parser.value("format");
+	if(format != "png" && format != "raw") {
+		std::cerr << "unknown format: " << format.toStdString() << std::endl;
+		return 1;
+	}
+	QSize size;
+	const QStringList size_list = parser.value("size").split(QChar('x'));
+	if(size_list.size() == 2)
+		size = QSize(size_list.at(0).toInt(), size_list.at(1).toInt());
+
+	QSettings settings("./config.ini", QSettings::IniFormat);
+	Interface::initializeConfig(settings);
+	settings.sync();
+	FieldView view;
+	view.reverse = parser.isSet("reverse");
+	view.trails = parser.isSet("trails");
+
+	std::vector<LogData> log_data;
+	if(!readLogFile(parser.value("export").toStdString(), log_data))
+		return 1;
+	LogExporter exporter(MonitorConfig::load(settings), view);
+	const LogExporter::Format output_format = format == "raw" ? LogExporter::FORMAT_RAW : LogExporter::FORMAT_PNG;
+	return exporter.exportLog(log_data, output, output_format, parser.value("fps").toInt(), size) ? 0 : 1;
+}
+
+/*
+ * game_monitor --convert LOG --output PATH [--from TIME] [--to TIME]
+ *              [--text-format VERSION]
+ * converts a text log (format 1.0, 2.0 or 2.1) to a binary log, or a
+ * binary log or an archive to a text log of format 2.1, or of the older
+ * format given by --text-format. Of an archive, only the entries from
+ * --from to --to (h:m:s log times) are read.
+ */
+static int convertLog(int argc, char **argv)
+{
+	QCoreApplication app(argc, argv);
+	QCommandLineParser parser;
+	parser.addHelpOption();
+	parser.addOption(QCommandLineOption("convert", "Log file to convert.", "log"));
+	parser.addOption(QCommandLineOption("output", "Converted log file.", "path"));
+	parser.addOption(QCommandLineOption("from", "First log time to convert from an archive.", "time"));
+	parser.addOption(QCommandLineOption("to", "Last log time to convert from an archive.", "time"));
+	parser.addOption(QCommandLineOption("text-format", "Text log format to write: 1.0, 2.0 or 2.1 (default).", "version", "2.1"));
+	parser.process(app);
+
+	const std::string input = parser.value("convert").toStdString();
+	const std::string output = parser.value("output").toStdString();
+	if(output.empty()) {
+		std::cerr << "--output is required" << std::endl;
+		return 1;
+	}
+	TextLogVersion text_version;
+	const QString text_format = parser.value("text-format");
+	if(text_format == "1.0") {
+		text_version = TEXT_LOG_1_0;
+	} else if(text_format == "2.0") {
+		text_version = TEXT_LOG_2_0;
+	} else if(text_format == "2.1") {
+		text_version = TEXT_LOG_2_1;
+	} else {
+		std::cerr << "unknown text format " << text_format.toStdString() << std::endl;
+		return 1;
+	}
+	std::vector<LogData> log_data;
+	if(isLogArchive(input)) {
+		LogArchive archive;
+		if(!archive.open(QString::fromStdString(input)))
+			return 1;
+		// times before the start are past midnight
+		constexpr long long day_ms = 24LL * 60 * 60 * 1000;
+		long long from = parser.isSet("from") ? logTimeMs(parser.value("from").toStdString().c_str()) : archive.startMs();
+		long long to = parser.isSet("to") ? logTimeMs(parser.value("to").toStdString().c_str()) : archive.endMs();
+		if(from < 0 || to < 0) {
+			std::cerr << "invalid time range" << std::endl;
+			return 1;
+		}
+		if(from < archive.startMs())
+			from += day_ms;
+		if(to < archive.startMs())
+			to += day_ms;
+		if(!archive.read(from, to, log_data) || !writeTextLog(output, log_data, text_version))
+			return 1;
+		std::cout << log_data.size() << " entries written to " << output << " as text" << std::endl;
+		return 0;
+	}
+	const bool binary = isBinaryLog(input);
+	if(!readLogFile(input, log_data))
+		return 1;
+	if(!(binary ? writeTextLog(output, log_data, text_version) : writeBinaryLog(output, log_data)))
+		return 1;
+	std::cout << log_data.size() << " entries written to " << output << (binary ? " as text" : " as binary") << std::endl;
+	return 0;
+}
+
+/*
+ * game_monitor --archive --output DIR LOG...
+ * archives finished logs of any format into DIR, one pool thread per log.
+ */
+static int archive(int argc, char **argv)
+{
+	QCoreApplication app(argc, argv);
+	QCommandLineParser parser;
+	parser.addHelpOption();
+	parser.addOption(QCommandLineOption("archive", "Archive the logs."));
+	parser.addOption(QCommandLineOption("output", "Directory of the archives.", "dir"));
+	parser.addPositionalArgument("logs", "Log files to archive.", "LOG...");
+	parser.process(app);
+
+	const QString output = parser.value("output");
+	const QStringList inputs = parser.positionalArguments();
+	if(output.isEmpty() || inputs.isEmpty()) {
+		std::cerr << "--output and at least one log are required" << std::endl;
+		return 1;
+	}
+	std::vector<std::string> files;
+	for(int i = 0; i < inputs.size(); i++)
+		files.push_back(inputs.at(i).toStdString());
+	const int failed = archiveLogs(files, output);
+	std::cout << (files.size() - failed) << " of " << files.size() << " logs archived to " << output.toStdString() << std::endl;
+	return failed == 0 ? 0 : 1;
+}
 
 int main(int argc, char **argv)
 {
+	for(int i = 1; i < argc; i++) {
+		if(strcmp(argv[i], "--export") == 0)
+			return exportLog(argc, argv);
+		if(strcmp(argv[i], "--convert") == 0)
+			return convertLog(argc, argv);
+		if(strcmp(argv[i], "--archive") == 0)
+			return archive(argc, argv);
+	}
+
 	QApplication app(argc, argv);
-	Interface *interface = new Interface;
+	QSettings settings("./config.ini", QSettings::IniFormat);
+	const int field_count = settings.value("fields/count", 1).toInt();
 
-	interface->show();
+	if(field_count <= 1) {
+		Interface interface;
+		interface.show();
+		return app.exec();
+	}
+
+	// one tab per field, only the visible one is drawn; the tab widget
+	// owns the pages and deletes them
+	QTabWidget tabs;
+	for(int i = 0; i < field_count; i++)
+		tabs.addTab(new Interface(i), QString("Field %1").arg(i + 1));
+	tabs.setWindowTitle("Humanoid League Game Monitor");
+	tabs.show();
 
 	return app.exec();
 }
-
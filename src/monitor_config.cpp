@@ -0,0 +1,30 @@
+#include "monitor_config.h"
+
+std::shared_ptr<const MonitorConfig> MonitorConfig::load(QSettings &settings)
+{
+	std::shared_ptr<MonitorConfig> config = std::make_shared<MonitorConfig>();
+	config->field_image_width = settings.value("field_image/width").toInt();
+	config->field_image_height = settings.value("field_image/height").toInt();
+	config->field_size_x = settings.value("field_size/x").toInt();
+	config->field_size_y = settings.value("field_size/y").toInt();
+	config->field_line_width = settings.value("field_size/line_width").toInt();
+	config->marker_pen_size = settings.value("marker/pen_size").toInt();
+	config->marker_robot_size = settings.value("marker/robot_size").toInt();
+	config->marker_ball_size = settings.value("marker/ball_size").toInt();
+	config->marker_goal_pole_size = settings.value("marker/goal_pole_size").toInt();
+	config->marker_direction_marker_length = settings.value("marker/direction_marker_length").toInt();
+	config->marker_font_size = settings.value("marker/font_size").toInt();
+	config->marker_font_offset_x = settings.value("marker/font_offset_x").toInt();
+	config->marker_font_offset_y = settings.value("marker/font_offset_y").toInt();
+	config->marker_time_up_limit = settings.value("marker/time_up_limit").toInt();
+	config->font_size = settings.value("size/font_size").toInt();
+	config->display_minimum_height = settings.value("size/display_minimum_height").toInt();
+	config->render_max_fps = settings.value("render/max_fps").toInt();
+	config->trail_seconds = settings.value("trail/seconds").toInt();
+	config->log_flush_interval_ms = settings.value("log/flush_interval_ms").toInt();
+	config->log_fsync = settings.value("log/fsync").toBool();
+	config->log_binary = settings.value("log/format").toString() == "binary";
+	config->image_scale_x = config->field_size_x > 0 ? static_cast<double>(config->field_image_width) / config->field_size_x : 0.0;
+	config->image_scale_y = config->field_size_y > 0 ? static_cast<double>(config->field_image_height) / config->field_size_y : 0.0;
+	return config;
+}
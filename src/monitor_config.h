@@ -0,0 +1,49 @@
+#ifndef MONITOR_CONFIG_H
+#define MONITOR_CONFIG_H
+
+#include <memory>
+
+#include <QSettings>
+
+/*
+ * Typed snapshot of the drawing related part of config.ini.
+ * A snapshot is never modified after load(); a changed configuration is
+ * published as a new snapshot, so a frame that holds one keeps consistent
+ * values while the next one is swapped in.
+ */
+struct MonitorConfig {
+	// field_image/*, pixel size of the drawing area
+	int field_image_width;
+	int field_image_height;
+	// field_size/*, in millimeters
+	int field_size_x;
+	int field_size_y;
+	int field_line_width;
+	// marker/*
+	int marker_pen_size;
+	int marker_robot_size;
+	int marker_ball_size;
+	int marker_goal_pole_size;
+	int marker_direction_marker_length;
+	int marker_font_size;
+	int marker_font_offset_x;
+	int marker_font_offset_y;
+	int marker_time_up_limit;
+	// size/*
+	int font_size;
+	int display_minimum_height;
+	// render/*
+	int render_max_fps;
+	// trail/*
+	int trail_seconds;
+	// log/*
+	int log_flush_interval_ms;
+	bool log_fsync;
+	bool log_binary;
+	// image pixels per millimeter, derived from the values above
+	double image_scale_x;
+	double image_scale_y;
+	static std::shared_ptr<const MonitorConfig> load(QSettings &);
+};
+
+#endif // MONITOR_CONFIG_H
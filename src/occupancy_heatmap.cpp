@@ -0,0 +1,57 @@
+#include <cmath>
+#include <algorithm>
+
+#include "occupancy_heatmap.h"
+
+OccupancyHeatmap::OccupancyHeatmap(const int width, const int height, const int cell) : cell_size(cell), grid_num_x((width + cell - 1) / cell), grid_num_y((height + cell - 1) / cell), counts(grid_num_x * grid_num_y, 0), max_count(0), dirty(true), heatmap(grid_num_x, grid_num_y, QImage::Format_ARGB32_Premultiplied)
+{
+}
+
+void OccupancyHeatmap::add(const int x, const int y)
+{
+	const int xi = x / cell_size;
+	const int yi = y / cell_size;
+	if(x < 0 || y < 0 || xi >= grid_num_x || yi >= grid_num_y)
+		return;
+	unsigned int &count = counts[yi * grid_num_x + xi];
+	if(count == 0xFFFFFFFF)
+		return;
+	count++;
+	max_count = std::max(max_count, count);
+	dirty = true;
+}
+
+void OccupancyHeatmap::clear(void)
+{
+	std::fill(counts.begin(), counts.end(), 0);
+	max_count = 0;
+	dirty = true;
+}
+
+/*
+ * One pixel per cell, from transparent blue for rarely visited cells to
+ * red for the most visited one on a logarithmic scale.
+ */
+const QImage &OccupancyHeatmap::image(void)
+{
+	if(!dirty)
+		return heatmap;
+	const double scale = max_count > 0 ? 1.0 / std::log1p(static_cast<double>(max_count)) : 0.0;
+	for(int y = 0; y < grid_num_y; y++) {
+		QRgb *line = reinterpret_cast<QRgb *>(heatmap.scanLine(y));
+		const unsigned int *row = &counts[y * grid_num_x];
+		for(int x = 0; x < grid_num_x; x++) {
+			if(row[x] == 0) {
+				line[x] = 0;
+				continue;
+			}
+			const double t = std::log1p(static_cast<double>(row[x])) * scale;
+			const int alpha = static_cast<int>(60 + 120 * t);
+			const int red = static_cast<int>(255 * t);
+			const int blue = 255 - red;
+			line[x] = qPremultiply(qRgba(red, 0, blue, alpha));
+		}
+	}
+	dirty = false;
+	return heatmap;
+}
@@ -0,0 +1,31 @@
+#ifndef OCCUPANCY_HEATMAP_H
+#define OCCUPANCY_HEATMAP_H
+
+#include <vector>
+
+#include <QImage>
+
+/*
+ * Counts how often robots were seen in each cell of a grid over the field
+ * image. Adding a position is O(1) and the grid never grows, however long
+ * the game or the replayed log is. The colored image is only rebuilt when
+ * image() is called after a change.
+ */
+class OccupancyHeatmap
+{
+public:
+	OccupancyHeatmap(const int, const int, const int);
+	void add(const int, const int);
+	void clear(void);
+	const QImage &image(void);
+private:
+	const int cell_size;
+	const int grid_num_x;
+	const int grid_num_y;
+	std::vector<unsigned int> counts;
+	unsigned int max_count;
+	bool dirty;
+	QImage heatmap;
+};
+
+#endif // OCCUPANCY_HEATMAP_H
@@ -0,0 +1,241 @@
+#include <iostream>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#ifdef __unix__
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#include "packet_capture.h"
+
+CaptureChannel::CaptureChannel(const int slot_size, const int slot_count, const int slab_count) : full(slab_count), free_slabs(slab_count), current(nullptr), dropped(0)
+{
+	for(int i = 0; i < slab_count; i++)
+		slabs.push_back(std::unique_ptr<CaptureSlab>(new CaptureSlab(slot_size, slot_count)));
+	current = slabs[0].get();
+	for(int i = 1; i < slab_count; i++)
+		free_slabs.push(slabs[i].get());
+}
+
+/*
+ * The slab the receiver reads into, never null.
+ */
+CaptureSlab *CaptureChannel::slab(void)
+{
+	return current;
+}
+
+/*
+ * Hand the datagrams of the current slab to the writer and continue with
+ * a free slab. False if there was no free slab; the datagrams are dropped
+ * then and the current slab is reused.
+ */
+bool CaptureChannel::submit(void)
+{
+	if(current->count == 0)
+		return true;
+	CaptureSlab *next;
+	if(!free_slabs.pop(next)) {
+		dropped += current->count;
+		current->count = 0;
+		return false;
+	}
+	// there are no more slabs than places in the queue
+	full.push(current);
+	current = next;
+	current->count = 0;
+	return true;
+}
+
+bool CaptureChannel::takeFull(CaptureSlab *&slab)
+{
+	return full.pop(slab);
+}
+
+void CaptureChannel::release(CaptureSlab *slab)
+{
+	free_slabs.push(slab);
+}
+
+unsigned long long CaptureChannel::droppedCount(void) const
+{
+	return dropped;
+}
+
+PacketCapture::PacketCapture(const std::string &name_suffix) : fd(-1), failed(false), suffix(name_suffix), captured(0), stopping(false)
+{
+}
+
+PacketCapture::~PacketCapture()
+{
+	stop();
+}
+
+/*
+ * Write out the filled slabs and end the writer thread. The channels must
+ * not be written to any more.
+ */
+void PacketCapture::stop(void)
+{
+	stop_mutex.lock();
+	stopping = true;
+	stop_mutex.unlock();
+	stop_condition.notify_one();
+	if(writer.joinable())
+		writer.join();
+}
+
+/*
+ * A channel whose slabs hold `slot_count' datagrams of up to `slot_size'
+ * bytes. Owned by the capture.
+ */
+CaptureChannel *PacketCapture::addChannel(const int slot_size, const int slot_count)
+{
+	channels.push_back(std::unique_ptr<CaptureChannel>(new CaptureChannel(slot_size, slot_count, SLABS_PER_CHANNEL)));
+	return channels.back().get();
+}
+
+void PacketCapture::start(void)
+{
+	writer = std::thread(&PacketCapture::run, this);
+}
+
+unsigned long long PacketCapture::capturedCount(void) const
+{
+	return captured;
+}
+
+unsigned long long PacketCapture::droppedCount(void) const
+{
+	unsigned long long count = 0;
+	for(const auto &channel : channels)
+		count += channel->droppedCount();
+	return count;
+}
+
+/*
+ * Writer thread: every write interval, write out the slabs the receivers
+ * handed over. On shutdown they are written once more.
+ */
+void PacketCapture::run(void)
+{
+	const std::chrono::milliseconds interval(static_cast<int>(WRITE_INTERVAL_MS));
+	for(;;) {
+		bool stop;
+		{
+			std::unique_lock<std::mutex> lock(stop_mutex);
+			stop_condition.wait_for(lock, interval, [this] { return stopping; });
+			stop = stopping;
+		}
+		for(const auto &channel : channels) {
+			CaptureSlab *slab;
+			while(channel->takeFull(slab)) {
+				if(!failed && !writeSlab(*slab)) {
+					std::cerr << "packet capture stopped: " << std::strerror(errno) << std::endl;
+					failed = true;
+				}
+				channel->release(slab);
+			}
+		}
+		if(stop)
+			break;
+	}
+#ifdef __unix__
+	if(fd >= 0)
+		close(fd);
+#endif
+}
+
+#ifdef __unix__
+static bool writeAll(const int fd, struct iovec *iov, int count)
+{
+	while(count > 0) {
+		const ssize_t written = writev(fd, iov, std::min(count, IOV_MAX));
+		if(written < 0) {
+			if(errno == EINTR)
+				continue;
+			return false;
+		}
+		size_t left = written;
+		while(count > 0 && left >= iov->iov_len) {
+			left -= iov->iov_len;
+			iov++;
+			count--;
+		}
+		if(count > 0) {
+			iov->iov_base = static_cast<char *>(iov->iov_base) + left;
+			iov->iov_len -= left;
+		}
+	}
+	return true;
+}
+
+/*
+ * Write the records and datagrams straight from the slab.
+ */
+bool PacketCapture::writeSlab(CaptureSlab &slab)
+{
+	static const unsigned char padding[8] = { 0 };
+	if(fd < 0 && !openFile())
+		return false;
+	std::vector<struct iovec> iov;
+	iov.reserve(slab.count * 3);
+	unsigned long long written = 0;
+	for(int i = 0; i < slab.count; i++) {
+		const packet_capture_record_T &record = slab.records[i];
+		if(record.kind == CAPTURE_NONE)
+			continue;
+		iov.push_back({ const_cast<packet_capture_record_T *>(&record), sizeof(record) });
+		iov.push_back({ slab.slot(i), record.size });
+		const size_t pad = (8 - record.size % 8) % 8;
+		if(pad > 0)
+			iov.push_back({ const_cast<unsigned char *>(padding), pad });
+		written++;
+	}
+	if(!writeAll(fd, iov.data(), static_cast<int>(iov.size())))
+		return false;
+	captured += written;
+	return true;
+}
+
+bool PacketCapture::openFile(void)
+{
+	time_t timer;
+	struct tm local_time;
+	char filename[1024];
+	char capture_path[] = "log/";
+
+	timer = time(NULL);
+	localtime_r(&timer, &local_time);
+	sprintf(filename, "%s%d-%d-%d-%d-%d%s.cap", capture_path, local_time.tm_year+1900, local_time.tm_mon+1, local_time.tm_mday, local_time.tm_hour, local_time.tm_min, suffix.c_str());
+	fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if(fd < 0)
+		return false;
+	using namespace std::chrono;
+	packet_capture_header_T header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, PACKET_CAPTURE_MAGIC, sizeof(PACKET_CAPTURE_MAGIC));
+	header.version = PACKET_CAPTURE_VERSION;
+	header.wall_offset_us = duration_cast<microseconds>(system_clock::now().time_since_epoch()).count() -
+		duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+	struct iovec iov = { &header, sizeof(header) };
+	return writeAll(fd, &iov, 1);
+}
+#else
+bool PacketCapture::writeSlab(CaptureSlab &)
+{
+	errno = ENOSYS;
+	return false;
+}
+
+bool PacketCapture::openFile(void)
+{
+	return false;
+}
+#endif
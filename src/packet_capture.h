@@ -0,0 +1,128 @@
+#ifndef PACKET_CAPTURE_H
+#define PACKET_CAPTURE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "spsc_queue.h"
+
+/*
+ * Raw packet capture file, written when capture/enable is true.
+ *
+ * A file is one packet_capture_header_T followed by records, each a
+ * packet_capture_record_T and the datagram as received, padded to a
+ * multiple of 8 bytes. Times are microseconds of the monotonic clock
+ * (std::chrono::steady_clock); the header holds the offset to the wall
+ * clock when the file was opened. All fields are in host byte order.
+ */
+static const char PACKET_CAPTURE_MAGIC[8] = { 'H', 'L', 'G', 'M', 'C', 'A', 'P', '\0' };
+static const uint32_t PACKET_CAPTURE_VERSION = 1;
+
+enum {
+	CAPTURE_NONE = 0, // in a slab only: an empty slot, never written
+	CAPTURE_ROBOT = 1,
+	CAPTURE_GAMECONTROLLER = 2,
+};
+
+struct packet_capture_header_T {
+	char magic[8];
+	uint32_t version;
+	uint32_t reserved;
+	int64_t wall_offset_us; // wall clock minus monotonic clock
+};
+
+struct packet_capture_record_T {
+	uint32_t size; // of the datagram
+	uint16_t kind;
+	uint16_t local_port;
+	uint32_t source_address; // IPv4
+	uint16_t source_port;
+	uint16_t reserved;
+	int64_t time_us; // receive time
+};
+
+static_assert(sizeof(packet_capture_header_T) == 24, "packet capture header layout");
+static_assert(sizeof(packet_capture_record_T) == 24, "packet capture record layout");
+
+/*
+ * Fixed slots that a receiver reads datagrams into, and the record of
+ * each one. Record i belongs to slot i; the first `count' are in use.
+ */
+struct CaptureSlab {
+	CaptureSlab(const int slot_bytes, const int slot_count) : data(slot_bytes * slot_count), records(slot_count), count(0), slot_size(slot_bytes) {}
+	unsigned char *slot(const int index) { return &data[index * slot_size]; }
+	std::vector<unsigned char> data;
+	std::vector<packet_capture_record_T> records;
+	int count;
+	const int slot_size;
+};
+
+/*
+ * The connection between one receiver and the capture writer. The
+ * receiver reads its datagrams straight into the current slab, which is
+ * handed to the writer as it is once the batch is done, and takes a free
+ * slab in its place. The writer writes the datagrams from the slab and
+ * returns it, so captured data is never copied. If the writer is so far
+ * behind that no slab is free, the batch is dropped and counted, the
+ * receiver never waits.
+ */
+class CaptureChannel
+{
+public:
+	CaptureChannel(const int, const int, const int);
+	// receiver side
+	CaptureSlab *slab(void);
+	bool submit(void);
+	// writer side
+	bool takeFull(CaptureSlab *&);
+	void release(CaptureSlab *);
+	unsigned long long droppedCount(void) const;
+private:
+	std::vector<std::unique_ptr<CaptureSlab> > slabs;
+	SpscQueue<CaptureSlab *> full;
+	SpscQueue<CaptureSlab *> free_slabs;
+	CaptureSlab *current;
+	std::atomic<unsigned long long> dropped;
+};
+
+/*
+ * Writes the raw datagrams of all channels to one capture file per field
+ * from its own thread, started by start() once all channels are added.
+ * The file is opened when the first datagram is written.
+ */
+class PacketCapture
+{
+public:
+	PacketCapture(const std::string & = std::string());
+	~PacketCapture();
+	CaptureChannel *addChannel(const int, const int);
+	void start(void);
+	void stop(void);
+	unsigned long long capturedCount(void) const;
+	unsigned long long droppedCount(void) const;
+private:
+	static const int SLABS_PER_CHANNEL = 16;
+	static const int WRITE_INTERVAL_MS = 100;
+	void run(void);
+	bool writeSlab(CaptureSlab &);
+	bool openFile(void);
+	// writer thread only
+	int fd;
+	bool failed;
+	// shared
+	const std::string suffix; // appended to the file name, e.g. "-field2"
+	std::vector<std::unique_ptr<CaptureChannel> > channels;
+	std::atomic<unsigned long long> captured;
+	std::mutex stop_mutex;
+	std::condition_variable stop_condition;
+	bool stopping;
+	std::thread writer;
+};
+
+#endif // PACKET_CAPTURE_H
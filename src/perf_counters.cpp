@@ -0,0 +1,126 @@
+#include "perf_counters.h"
+
+// index of the highest set bit of a value above 0
+static int highestBit(unsigned long long value)
+{
+#ifdef __GNUC__
+	return 63 - __builtin_clzll(value);
+#else
+	int bit = 0;
+	while(value >>= 1)
+		bit++;
+	return bit;
+#endif
+}
+
+LatencyHistogram::LatencyHistogram()
+{
+	clear();
+}
+
+/*
+ * Bucket 0 to 3 hold 0 to 3 us. Above, bucket 4 * (e - 1) + s holds the
+ * values from (4 + s) << (e - 2) up to the next bucket, where 2^e is the
+ * highest power of two in the value.
+ */
+int LatencyHistogram::bucketOf(const long long us)
+{
+	if(us < 4)
+		return us < 0 ? 0 : static_cast<int>(us);
+	const int e = highestBit(static_cast<unsigned long long>(us));
+	const int bucket = 4 * (e - 1) + static_cast<int>((us >> (e - 2)) & 3);
+	return bucket < BUCKETS ? bucket : BUCKETS - 1;
+}
+
+long long LatencyHistogram::bucketLowerUs(const int bucket)
+{
+	if(bucket < 4)
+		return bucket;
+	const int e = bucket / 4 + 1;
+	return static_cast<long long>(4 + bucket % 4) << (e - 2);
+}
+
+void LatencyHistogram::record(const long long us)
+{
+	buckets[bucketOf(us)].fetch_add(1, std::memory_order_relaxed);
+	total_us.fetch_add(us, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::clear(void)
+{
+	for(int i = 0; i < BUCKETS; i++)
+		buckets[i].store(0, std::memory_order_relaxed);
+	total_us.store(0, std::memory_order_relaxed);
+}
+
+unsigned long long LatencyHistogram::count(void) const
+{
+	unsigned long long n = 0;
+	for(int i = 0; i < BUCKETS; i++)
+		n += buckets[i].load(std::memory_order_relaxed);
+	return n;
+}
+
+long long LatencyHistogram::totalUs(void) const
+{
+	return total_us.load(std::memory_order_relaxed);
+}
+
+/*
+ * Upper end of the bucket that holds the given fraction (0 to 1) of the
+ * recorded values, 0 if nothing was recorded. With a baseline, an earlier
+ * copy of this histogram, only the values recorded since then count.
+ */
+double LatencyHistogram::percentileUs(const double fraction, const LatencyHistogram *baseline) const
+{
+	unsigned long long counts[BUCKETS];
+	unsigned long long n = 0;
+	for(int i = 0; i < BUCKETS; i++) {
+		counts[i] = buckets[i].load(std::memory_order_relaxed);
+		if(baseline != nullptr)
+			counts[i] -= baseline->buckets[i].load(std::memory_order_relaxed);
+		n += counts[i];
+	}
+	if(n == 0)
+		return 0.0;
+	const unsigned long long rank = static_cast<unsigned long long>(fraction * (n - 1));
+	unsigned long long seen = 0;
+	for(int i = 0; i < BUCKETS; i++) {
+		seen += counts[i];
+		if(seen > rank)
+			return i + 1 < BUCKETS ? bucketLowerUs(i + 1) : bucketLowerUs(i);
+	}
+	return bucketLowerUs(BUCKETS - 1);
+}
+
+void LatencyHistogram::copyFrom(const LatencyHistogram &other)
+{
+	for(int i = 0; i < BUCKETS; i++)
+		buckets[i].store(other.buckets[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+	total_us.store(other.total_us.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+/*
+ * One line per histogram: name, count, total time and the non-empty
+ * buckets as lower_bound_us:count.
+ */
+void LatencyHistogram::dump(FILE *fp, const char *name) const
+{
+	fprintf(fp, "%s,%llu,%lld", name, count(), totalUs());
+	for(int i = 0; i < BUCKETS; i++) {
+		const unsigned long long n = buckets[i].load(std::memory_order_relaxed);
+		if(n > 0)
+			fprintf(fp, ",%lld:%llu", bucketLowerUs(i), n);
+	}
+	fprintf(fp, "\n");
+}
+
+ScopedTimer::ScopedTimer(LatencyHistogram &target) : histogram(target), start(std::chrono::steady_clock::now())
+{
+}
+
+ScopedTimer::~ScopedTimer()
+{
+	using namespace std::chrono;
+	histogram.record(duration_cast<microseconds>(steady_clock::now() - start).count());
+}
@@ -0,0 +1,46 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+
+/*
+ * Histogram of durations in microseconds with a fixed set of buckets:
+ * every power of two is split into four linear steps, so a percentile is
+ * accurate to 25 %. Recording is two relaxed atomic additions, cheap
+ * enough to be always on. Any thread may record while another one reads.
+ */
+class LatencyHistogram
+{
+public:
+	static const int BUCKETS = 128; // up to about 2^33 us
+	LatencyHistogram();
+	void record(const long long);
+	void clear(void);
+	unsigned long long count(void) const;
+	long long totalUs(void) const;
+	double percentileUs(const double, const LatencyHistogram * = nullptr) const;
+	void copyFrom(const LatencyHistogram &);
+	void dump(FILE *, const char *) const;
+	static long long bucketLowerUs(const int);
+private:
+	static int bucketOf(const long long);
+	std::atomic<unsigned long long> buckets[BUCKETS];
+	std::atomic<long long> total_us;
+};
+
+/*
+ * Records the time from construction to the end of the scope.
+ */
+class ScopedTimer
+{
+public:
+	explicit ScopedTimer(LatencyHistogram &);
+	~ScopedTimer();
+private:
+	LatencyHistogram &histogram;
+	const std::chrono::steady_clock::time_point start;
+};
+
+#endif // PERF_COUNTERS_H
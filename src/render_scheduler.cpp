@@ -0,0 +1,44 @@
+#include "render_scheduler.h"
+
+RenderScheduler::RenderScheduler(const int max_fps, QObject *parent) : QObject(parent), last_render_ms(0), frame_interval_ms(0), render_count(0), avoided_count(0)
+{
+	timer = new QTimer(this);
+	timer->setSingleShot(true);
+	connect(timer, SIGNAL(timeout()), this, SLOT(frame()));
+	clock.start();
+	setMaxFps(max_fps);
+}
+
+void RenderScheduler::setMaxFps(const int max_fps)
+{
+	frame_interval_ms = max_fps > 0 ? 1000 / max_fps : 0;
+}
+
+void RenderScheduler::requestRender(void)
+{
+	if(timer->isActive()) {
+		avoided_count++;
+		return;
+	}
+	// render with the next event loop pass, unless the last frame is too recent
+	const qint64 since_last = clock.elapsed() - last_render_ms;
+	const qint64 wait = render_count > 0 ? frame_interval_ms - since_last : 0;
+	timer->start(wait > 0 ? static_cast<int>(wait) : 0);
+}
+
+void RenderScheduler::frame(void)
+{
+	last_render_ms = clock.elapsed();
+	render_count++;
+	emit render();
+}
+
+unsigned long long RenderScheduler::renderCount(void) const
+{
+	return render_count;
+}
+
+unsigned long long RenderScheduler::avoidedCount(void) const
+{
+	return avoided_count;
+}
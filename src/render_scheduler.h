@@ -0,0 +1,35 @@
+#ifndef RENDER_SCHEDULER_H
+#define RENDER_SCHEDULER_H
+
+#include <QtCore>
+
+/*
+ * Coalesces repaint requests into frames. requestRender() only marks the
+ * view dirty; render() is emitted once for all requests of a frame and at
+ * most max_fps times per second. A request arriving while a frame is
+ * already pending costs nothing and is counted as an avoided repaint.
+ */
+class RenderScheduler : public QObject
+{
+	Q_OBJECT
+public:
+	RenderScheduler(const int, QObject *parent = 0);
+	void setMaxFps(const int);
+	unsigned long long renderCount(void) const;
+	unsigned long long avoidedCount(void) const;
+public slots:
+	void requestRender(void);
+signals:
+	void render(void);
+private:
+	QTimer *timer;
+	QElapsedTimer clock;
+	qint64 last_render_ms;
+	int frame_interval_ms;
+	unsigned long long render_count;
+	unsigned long long avoided_count;
+private slots:
+	void frame(void);
+};
+
+#endif // RENDER_SCHEDULER_H
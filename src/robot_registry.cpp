@@ -0,0 +1,55 @@
+#include "robot_registry.h"
+
+RobotRegistry::RobotRegistry() : key_of_slot(), count(0)
+{
+	clear();
+}
+
+int RobotRegistry::slotOf(const unsigned char key)
+{
+	int slot = slot_of_key[key];
+	if(slot < 0) {
+		slot = count.load(std::memory_order_relaxed);
+		slot_of_key[key] = slot;
+		key_of_slot[slot] = key;
+		count.store(slot + 1, std::memory_order_release);
+	}
+	return slot;
+}
+
+int RobotRegistry::find(const unsigned char key) const
+{
+	return slot_of_key[key];
+}
+
+int RobotRegistry::size(void) const
+{
+	return count.load(std::memory_order_acquire);
+}
+
+unsigned char RobotRegistry::keyOf(const int slot) const
+{
+	return key_of_slot[slot];
+}
+
+void RobotRegistry::clear(void)
+{
+	for(int i = 0; i < MAX_ROBOTS; i++)
+		slot_of_key[i] = -1;
+	count.store(0, std::memory_order_release);
+}
+
+unsigned char RobotRegistry::makeKey(const int color, const int id)
+{
+	return static_cast<unsigned char>(((color & 0x1) << 7) | (id & 0x7F));
+}
+
+int RobotRegistry::colorOf(const unsigned char key)
+{
+	return (key & 0x80) >> 7;
+}
+
+int RobotRegistry::idOf(const unsigned char key)
+{
+	return key & 0x7F;
+}
@@ -0,0 +1,35 @@
+#ifndef ROBOT_REGISTRY_H
+#define ROBOT_REGISTRY_H
+
+#include <atomic>
+
+/*
+ * Maps the robot key carried in comm_info_T::id (team color in the top
+ * bit, robot number in the low 7 bits) to a dense slot index. Slots are
+ * handed out in order of first appearance and never reused, so per-robot
+ * data can live in plain arrays indexed by slot and lookups are a single
+ * table access.
+ *
+ * Only one thread may register robots. Other threads may read size() and
+ * keyOf() for any slot below size().
+ */
+class RobotRegistry
+{
+public:
+	static const int MAX_ROBOTS = 256; // one slot for every possible key
+	RobotRegistry();
+	int slotOf(const unsigned char key);
+	int find(const unsigned char key) const;
+	int size(void) const;
+	unsigned char keyOf(const int slot) const;
+	void clear(void);
+	static unsigned char makeKey(const int color, const int id);
+	static int colorOf(const unsigned char key);
+	static int idOf(const unsigned char key);
+private:
+	short slot_of_key[MAX_ROBOTS];
+	unsigned char key_of_slot[MAX_ROBOTS];
+	std::atomic<int> count;
+};
+
+#endif // ROBOT_REGISTRY_H
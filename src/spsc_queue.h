@@ -0,0 +1,61 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/*
+ * Bounded lock-free FIFO for exactly one producer thread and one consumer
+ * thread. The capacity is rounded up to a power of two.
+ */
+template<typename T>
+class SpscQueue
+{
+public:
+	explicit SpscQueue(size_t capacity) : head(0), tail(0)
+	{
+		size_t size = 1;
+		while(size < capacity)
+			size <<= 1;
+		buffer.resize(size);
+		mask = size - 1;
+	}
+	// producer side; returns false if the queue is full
+	bool push(const T &value)
+	{
+		const size_t t = tail.load(std::memory_order_relaxed);
+		if(t - head.load(std::memory_order_acquire) == buffer.size())
+			return false;
+		buffer[t & mask] = value;
+		tail.store(t + 1, std::memory_order_release);
+		return true;
+	}
+	// consumer side; returns false if the queue is empty
+	bool pop(T &value)
+	{
+		const size_t h = head.load(std::memory_order_relaxed);
+		if(h == tail.load(std::memory_order_acquire))
+			return false;
+		value = buffer[h & mask];
+		head.store(h + 1, std::memory_order_release);
+		return true;
+	}
+	size_t size(void) const
+	{
+		return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+	}
+	size_t capacity(void) const
+	{
+		return buffer.size();
+	}
+private:
+	SpscQueue(const SpscQueue &);
+	SpscQueue &operator=(const SpscQueue &);
+	std::vector<T> buffer;
+	size_t mask;
+	std::atomic<size_t> head;
+	std::atomic<size_t> tail;
+};
+
+#endif // SPSC_QUEUE_H
@@ -0,0 +1,55 @@
+#include <QFontMetricsF>
+
+#include "text_cache.h"
+
+TextCache::TextCache(const int max_texts) : texts(max_texts)
+{
+}
+
+/*
+ * Draw text with its baseline starting at (x, y), like
+ * QPainter::drawText(), in the current font and pen of the painter.
+ * Under a rotating or shearing transform the text is drawn directly.
+ */
+void TextCache::drawText(QPainter &painter, const int x, const int y, const QString &text)
+{
+	const QTransform transform = painter.transform();
+	if(transform.type() > QTransform::TxScale) {
+		painter.drawText(x, y, text);
+		return;
+	}
+	const QFont &font = painter.font();
+	const QColor color = painter.pen().color();
+	// the image is rendered at the painter's scale, the translation does
+	// not matter
+	const Key key = { font, transform.m11(), transform.m22(), color.rgba(), text };
+	Entry *entry = texts.object(key);
+	if(entry == nullptr) {
+		entry = new Entry;
+		const QTransform scale = QTransform::fromScale(transform.m11(), transform.m22());
+		const QRect bounds = scale.mapRect(QFontMetricsF(font).boundingRect(text).adjusted(-1, -1, 1, 1)).toAlignedRect();
+		entry->image = QImage(bounds.size(), QImage::Format_ARGB32_Premultiplied);
+		entry->image.fill(Qt::transparent);
+		QPainter text_painter(&entry->image);
+		text_painter.setRenderHints(painter.renderHints());
+		text_painter.setPen(color);
+		text_painter.setFont(font);
+		text_painter.translate(-bounds.left(), -bounds.top());
+		text_painter.setTransform(scale, true);
+		text_painter.drawText(0, 0, text);
+		text_painter.end();
+		entry->offset = bounds.topLeft();
+		texts.insert(key, entry);
+	}
+	// draw in device pixels, so the image is not resampled
+	const QPoint origin = transform.map(QPointF(x, y)).toPoint();
+	painter.save();
+	painter.resetTransform();
+	painter.drawImage(origin + entry->offset, entry->image);
+	painter.restore();
+}
+
+void TextCache::clear(void)
+{
+	texts.clear();
+}
@@ -0,0 +1,54 @@
+#ifndef TEXT_CACHE_H
+#define TEXT_CACHE_H
+
+#include <QCache>
+#include <QColor>
+#include <QFont>
+#include <QHash>
+#include <QImage>
+#include <QPainter>
+#include <QPoint>
+#include <QString>
+
+/*
+ * Rendered texts, keyed by font, painter scale, pen color and string. A
+ * text that was drawn before the same way is not shaped or rasterized
+ * again, drawing it only blits its image. This matters most at large
+ * scales, where Qt renders glyphs bigger than its glyph cache takes as
+ * paths on every call. The least recently used texts are dropped when
+ * more than the given number are cached. Use from one thread only.
+ */
+class TextCache
+{
+public:
+	TextCache(const int = 256);
+	void drawText(QPainter &, const int, const int, const QString &);
+	void clear(void);
+private:
+	struct Key {
+		QFont font;
+		qreal scale_x;
+		qreal scale_y;
+		QRgb color;
+		QString text;
+		bool operator==(const Key &other) const
+		{
+			return scale_x == other.scale_x && scale_y == other.scale_y && color == other.color && text == other.text && font == other.font;
+		}
+		friend uint qHash(const Key &key, uint seed = 0)
+		{
+			uint hash = qHash(key.text, seed);
+			hash = hash * 31 + qHash(key.font, seed);
+			hash = hash * 31 + qHash(key.scale_x, seed);
+			hash = hash * 31 + qHash(key.scale_y, seed);
+			return hash * 31 + qHash(key.color, seed);
+		}
+	};
+	struct Entry {
+		QImage image;
+		QPoint offset; // of the image's top left from the baseline start, in device pixels
+	};
+	QCache<Key, Entry> texts;
+};
+
+#endif // TEXT_CACHE_H
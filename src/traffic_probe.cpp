@@ -0,0 +1,91 @@
+#include <chrono>
+#include <cstring>
+
+#include "traffic_probe.h"
+
+long long probeClockMicroseconds(void)
+{
+	using namespace std::chrono;
+	return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void writeTrafficProbe(struct comm_info_T &comm_info, const uint32_t seq, const long long send_time_us)
+{
+	traffic_probe_T probe;
+	probe.magic = TRAFFIC_PROBE_MAGIC;
+	probe.seq = seq;
+	probe.send_time_us = send_time_us;
+	std::memcpy(comm_info.command + TRAFFIC_PROBE_OFFSET, &probe, sizeof(probe));
+}
+
+bool readTrafficProbe(const struct comm_info_T &comm_info, traffic_probe_T &probe)
+{
+	std::memcpy(&probe, comm_info.command + TRAFFIC_PROBE_OFFSET, sizeof(probe));
+	return probe.magic == TRAFFIC_PROBE_MAGIC;
+}
+
+TrafficProbeStats::TrafficProbeStats()
+{
+	clear();
+}
+
+bool TrafficProbeStats::addPacket(const struct comm_info_T &comm_info, const long long receive_time_us)
+{
+	traffic_probe_T probe;
+	if(!readTrafficProbe(comm_info, probe))
+		return false;
+	const int key = comm_info.id;
+	if(seen[key]) {
+		// a negative gap is a reordered or duplicated packet, not a drop
+		const int32_t gap = static_cast<int32_t>(probe.seq - next_seq[key]);
+		if(gap < 0)
+			return true;
+		lost += gap;
+	}
+	seen[key] = true;
+	next_seq[key] = probe.seq + 1;
+	packets++;
+	const long long latency = receive_time_us - probe.send_time_us;
+	latency_sum_us += latency;
+	if(latency > latency_max_us)
+		latency_max_us = latency;
+	return true;
+}
+
+void TrafficProbeStats::clear(void)
+{
+	for(int i = 0; i < MAX_KEYS; i++) {
+		seen[i] = false;
+		next_seq[i] = 0;
+	}
+	packets = 0;
+	lost = 0;
+	latency_sum_us = 0;
+	latency_max_us = 0;
+}
+
+unsigned long long TrafficProbeStats::packetCount(void) const
+{
+	return packets;
+}
+
+unsigned long long TrafficProbeStats::lostCount(void) const
+{
+	return lost;
+}
+
+double TrafficProbeStats::lossRate(void) const
+{
+	const unsigned long long total = packets + lost;
+	return total > 0 ? static_cast<double>(lost) / total : 0.0;
+}
+
+double TrafficProbeStats::meanLatencyMs(void) const
+{
+	return packets > 0 ? latency_sum_us / 1000.0 / packets : 0.0;
+}
+
+double TrafficProbeStats::maxLatencyMs(void) const
+{
+	return latency_max_us / 1000.0;
+}
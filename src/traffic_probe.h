@@ -0,0 +1,54 @@
+#ifndef TRAFFIC_PROBE_H
+#define TRAFFIC_PROBE_H
+
+#include <cstdint>
+
+#include "comm_info.h"
+
+/*
+ * Sequence number and send time that gm_trafficgen hides in the unused
+ * tail of the command string, behind its terminating zero. The monitor
+ * uses them to measure drop rate and end-to-end latency on one machine,
+ * so the values are in host byte order and the time is read from the
+ * same monotonic clock on both sides.
+ */
+struct traffic_probe_T {
+	uint32_t magic;
+	uint32_t seq;
+	int64_t send_time_us;
+};
+
+static const uint32_t TRAFFIC_PROBE_MAGIC = 0x47544d47; // "GMTG"
+static const int TRAFFIC_PROBE_OFFSET = MAX_STRING - sizeof(traffic_probe_T);
+
+long long probeClockMicroseconds(void);
+void writeTrafficProbe(struct comm_info_T &, const uint32_t, const long long);
+bool readTrafficProbe(const struct comm_info_T &, traffic_probe_T &);
+
+/*
+ * Drop and latency statistics of probe packets. Feed it every received
+ * packet, packets without a probe are ignored. Drops are counted from
+ * gaps in the sequence numbers of each robot.
+ */
+class TrafficProbeStats
+{
+public:
+	TrafficProbeStats();
+	bool addPacket(const struct comm_info_T &, const long long);
+	void clear(void);
+	unsigned long long packetCount(void) const;
+	unsigned long long lostCount(void) const;
+	double lossRate(void) const;
+	double meanLatencyMs(void) const;
+	double maxLatencyMs(void) const;
+private:
+	static const int MAX_KEYS = 256;
+	bool seen[MAX_KEYS];
+	uint32_t next_seq[MAX_KEYS];
+	unsigned long long packets;
+	unsigned long long lost;
+	long long latency_sum_us;
+	long long latency_max_us;
+};
+
+#endif // TRAFFIC_PROBE_H
@@ -0,0 +1,48 @@
+#include "trail.h"
+
+Trail::Trail() : head(0), count(0)
+{
+}
+
+void Trail::add(const int x, const int y, const long long time_ms)
+{
+	points[head].x = x;
+	points[head].y = y;
+	points[head].time_ms = time_ms;
+	head = (head + 1) % CAPACITY;
+	if(count < CAPACITY)
+		count++;
+}
+
+void Trail::clear(void)
+{
+	head = 0;
+	count = 0;
+}
+
+int Trail::size(void) const
+{
+	return count;
+}
+
+const Trail::Point &Trail::at(const int i) const
+{
+	return points[(head - count + i + CAPACITY) % CAPACITY];
+}
+
+/*
+ * Index of the oldest point not older than since_ms, size() if there is
+ * none. Points are in time order, so this is a binary search.
+ */
+int Trail::firstSince(const long long since_ms) const
+{
+	int low = 0, high = count;
+	while(low < high) {
+		const int mid = (low + high) / 2;
+		if(at(mid).time_ms < since_ms)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	return low;
+}
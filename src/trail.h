@@ -0,0 +1,30 @@
+#ifndef TRAIL_H
+#define TRAIL_H
+
+/*
+ * The last CAPACITY positions of an object in a fixed ring buffer.
+ * Adding a point is O(1) and never allocates; when the buffer is full the
+ * oldest point is overwritten.
+ */
+class Trail
+{
+public:
+	static const int CAPACITY = 512;
+	struct Point {
+		int x;
+		int y;
+		long long time_ms;
+	};
+	Trail();
+	void add(const int, const int, const long long);
+	void clear(void);
+	int size(void) const;
+	const Point &at(const int) const; // 0 is the oldest point
+	int firstSince(const long long) const;
+private:
+	Point points[CAPACITY];
+	int head; // next slot to write
+	int count;
+};
+
+#endif // TRAIL_H
@@ -0,0 +1,58 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+
+/*
+ * Lock-free latest-value mailbox for one producer and one consumer.
+ * The producer always owns one buffer and the consumer another; the third
+ * is exchanged atomically. A value that is overwritten before the consumer
+ * picks it up is simply lost, which is what we want for state that only
+ * matters in its newest version.
+ */
+template<typename T>
+class TripleBuffer
+{
+public:
+	TripleBuffer() : state(1), back(0), front(2) {}
+	// producer side
+	T &writeBuffer(void) { return buffers[back]; }
+	bool publish(void)
+	{
+		const unsigned int prev = state.exchange(back | DIRTY, std::memory_order_acq_rel);
+		back = prev & INDEX_MASK;
+		return (prev & DIRTY) != 0; // true if an unread value was superseded
+	}
+	bool write(const T &value)
+	{
+		buffers[back] = value;
+		return publish();
+	}
+	// consumer side
+	bool update(void)
+	{
+		if(!(state.load(std::memory_order_relaxed) & DIRTY))
+			return false;
+		front = state.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+		return true;
+	}
+	bool read(T &value)
+	{
+		if(!update())
+			return false;
+		value = buffers[front];
+		return true;
+	}
+	const T &readBuffer(void) const { return buffers[front]; }
+private:
+	TripleBuffer(const TripleBuffer &);
+	TripleBuffer &operator=(const TripleBuffer &);
+	static const unsigned int INDEX_MASK = 0x3;
+	static const unsigned int DIRTY = 0x4;
+	T buffers[3];
+	std::atomic<unsigned int> state; // index of the middle buffer and dirty flag
+	unsigned int back;
+	unsigned int front;
+};
+
+#endif // TRIPLE_BUFFER_H
@@ -1,33 +1,184 @@
-#include <cmath>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+#ifdef __linux__
+#include <cerrno>
+#include <ctime>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#endif
 
 #include "udp_thread.h"
 
-inline static double radian(double degree)
+#ifdef __linux__
+static const size_t CONTROL_SIZE = CMSG_SPACE(sizeof(uint32_t)) + CMSG_SPACE(sizeof(struct timespec));
+
+UdpServer::UdpServer(int base, int num) : base_port(base), port_num(num), port_drops(num), mailboxes(new TripleBuffer<struct comm_info_T>[RobotRegistry::MAX_ROBOTS]), link_quality(RobotRegistry::MAX_ROBOTS), link_mailboxes(new TripleBuffer<LinkQuality>[RobotRegistry::MAX_ROBOTS]), log_writer(nullptr), notify_pending(false), rejected_datagrams(0), capture(nullptr), epoll_fd(-1), notifier(nullptr), slab(RECV_BATCH * MAX_DATAGRAM_SIZE), msgs(RECV_BATCH), iovecs(RECV_BATCH), control(RECV_BATCH * CONTROL_SIZE), senders(RECV_BATCH)
 {
-	return degree * M_PI / 180.0;
+	for(int i = 0; i < RECV_BATCH; i++) {
+		iovecs[i].iov_base = &slab[i * MAX_DATAGRAM_SIZE];
+		iovecs[i].iov_len = MAX_DATAGRAM_SIZE;
+		std::memset(&msgs[i], 0, sizeof(msgs[i]));
+		msgs[i].msg_hdr.msg_iov = &iovecs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+		msgs[i].msg_hdr.msg_control = &control[i * CONTROL_SIZE];
+		msgs[i].msg_hdr.msg_name = &senders[i];
+	}
 }
 
-UdpServer::UdpServer(int port_num)
+void UdpServer::setCapture(PacketCapture *packet_capture)
 {
-	udpSocket = new QUdpSocket(this);
-	udpSocket->bind(QHostAddress::Any, port_num);
-	connect(udpSocket, SIGNAL(readyRead()), this, SLOT(readPendingDatagrams()));
+	capture = packet_capture->addChannel(MAX_DATAGRAM_SIZE, RECV_BATCH);
+}
+
+void UdpServer::start(void)
+{
+	epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if(epoll_fd < 0) {
+		std::cerr << "epoll_create1 failed: " << std::strerror(errno) << std::endl;
+		return;
+	}
+	for(int i = 0; i < port_num; i++) {
+		const int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+		if(fd < 0) {
+			std::cerr << "socket failed: " << std::strerror(errno) << std::endl;
+			continue;
+		}
+		const int enable = 1;
+		setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+		// report the kernel's drop counter with every datagram
+		setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, &enable, sizeof(enable));
+		// and the time the datagram arrived
+		setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable));
+		struct sockaddr_in addr;
+		std::memset(&addr, 0, sizeof(addr));
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_ANY);
+		addr.sin_port = htons(base_port + i);
+		if(bind(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) < 0) {
+			std::cerr << "bind to port " << (base_port + i) << " failed: " << std::strerror(errno) << std::endl;
+			close(fd);
+			continue;
+		}
+		struct epoll_event ev;
+		std::memset(&ev, 0, sizeof(ev));
+		ev.events = EPOLLIN;
+		ev.data.u32 = socket_fds.size();
+		epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+		socket_fds.push_back(fd);
+		port_indexes.push_back(i);
+	}
+	notifier = new QSocketNotifier(epoll_fd, QSocketNotifier::Read, this);
+	connect(notifier, SIGNAL(activated(int)), this, SLOT(readPendingDatagrams()));
+}
+
+UdpServer::~UdpServer()
+{
+	for(auto fd : socket_fds)
+		close(fd);
+	if(epoll_fd >= 0)
+		close(epoll_fd);
 }
 
 void UdpServer::readPendingDatagrams(void)
 {
-	while(udpSocket->hasPendingDatagrams()) {
-		QByteArray datagrams;
-		datagrams.resize(udpSocket->pendingDatagramSize());
-		QHostAddress sender;
-		quint16 senderPort;
-		udpSocket->readDatagram(datagrams.data(), datagrams.size(), &sender, &senderPort);
-		char *buf = datagrams.data();
-		char *p = (char *)&comm_info;
-		for(size_t i = 0; (i < (unsigned)datagrams.size()) && (i < sizeof(struct comm_info_T)); i++) {
-			*p++ = buf[i];
+	constexpr int max_events = 16;
+	struct epoll_event events[max_events];
+	int received = 0;
+	const int n = epoll_wait(epoll_fd, events, max_events, 0);
+	for(int i = 0; i < n; i++) {
+		received += readSocket(events[i].data.u32);
+	}
+	if(received > 0)
+		notify();
+}
+
+int UdpServer::readSocket(int socket_index)
+{
+	int total = 0;
+	// Drain a bounded number of rounds; epoll is level triggered, so
+	// anything left over wakes us up again on the next event loop pass.
+	constexpr int max_rounds = 4;
+	const int port_index = port_indexes[socket_index];
+	for(int round = 0; round < max_rounds; round++) {
+		// when capturing, receive into the capture slab instead of our own
+		CaptureSlab *capture_slab = capture != nullptr ? capture->slab() : nullptr;
+		for(int i = 0; i < RECV_BATCH; i++) {
+			msgs[i].msg_hdr.msg_controllen = CONTROL_SIZE;
+			msgs[i].msg_hdr.msg_namelen = sizeof(senders[i]);
+			iovecs[i].iov_base = capture_slab != nullptr ? capture_slab->slot(i) : &slab[i * MAX_DATAGRAM_SIZE];
+		}
+		const int received = recvmmsg(socket_fds[socket_index], msgs.data(), RECV_BATCH, MSG_DONTWAIT, nullptr);
+		if(received <= 0)
+			break;
+		const long long read_time = monotonicMicroseconds();
+		struct timespec now;
+		clock_gettime(CLOCK_REALTIME, &now);
+		const long long read_realtime = now.tv_sec * 1000000LL + now.tv_nsec / 1000;
+		for(int i = 0; i < received; i++) {
+			struct msghdr &hdr = msgs[i].msg_hdr;
+			long long receive_time = read_time;
+			for(struct cmsghdr *cmsg = CMSG_FIRSTHDR(&hdr); cmsg != nullptr; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+				if(cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL) {
+					uint32_t drops;
+					std::memcpy(&drops, CMSG_DATA(cmsg), sizeof(drops));
+					port_drops[port_index] = drops;
+				} else if(cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+					// the kernel stamps with the wall clock; move the stamp
+					// to the monotonic clock by its age
+					struct timespec stamp;
+					std::memcpy(&stamp, CMSG_DATA(cmsg), sizeof(stamp));
+					const long long age = read_realtime - (stamp.tv_sec * 1000000LL + stamp.tv_nsec / 1000);
+					if(age >= 0)
+						receive_time = read_time - age;
+				}
+			}
+			if(capture_slab != nullptr) {
+				packet_capture_record_T &record = capture_slab->records[i];
+				record.kind = (hdr.msg_flags & MSG_TRUNC) ? CAPTURE_NONE : CAPTURE_ROBOT;
+				record.size = msgs[i].msg_len;
+				record.local_port = base_port + port_index;
+				record.source_address = ntohl(senders[i].sin_addr.s_addr);
+				record.source_port = ntohs(senders[i].sin_port);
+				record.reserved = 0;
+				record.time_us = receive_time;
+			}
+			if(hdr.msg_flags & MSG_TRUNC) {
+				rejected_datagrams++;
+				continue;
+			}
+			appendDatagram(port_index, static_cast<const unsigned char *>(iovecs[i].iov_base), msgs[i].msg_len, receive_time);
+		}
+		if(capture_slab != nullptr) {
+			capture_slab->count = received;
+			capture->submit();
 		}
-		emit receiveData(comm_info);
+		total += received;
+		if(received < RECV_BATCH)
+			break;
+	}
+	return total;
+}
+#else
+UdpServer::UdpServer(int base, int num) : base_port(base), port_num(num), port_drops(num), mailboxes(new TripleBuffer<struct comm_info_T>[RobotRegistry::MAX_ROBOTS]), link_quality(RobotRegistry::MAX_ROBOTS), link_mailboxes(new TripleBuffer<LinkQuality>[RobotRegistry::MAX_ROBOTS]), log_writer(nullptr), notify_pending(false), rejected_datagrams(0), capture(nullptr)
+{
+}
+
+void UdpServer::setCapture(PacketCapture *packet_capture)
+{
+	capture = packet_capture->addChannel(sizeof(datagram), CAPTURE_BATCH);
+}
+
+void UdpServer::start(void)
+{
+	for(int i = 0; i < port_num; i++) {
+		QUdpSocket *udpSocket = new QUdpSocket(this);
+		udpSocket->bind(QHostAddress::Any, base_port + i);
+		connect(udpSocket, SIGNAL(readyRead()), this, SLOT(readPendingDatagrams()));
+		udpSockets.push_back(udpSocket);
 	}
 }
 
@@ -35,31 +186,133 @@ UdpServer::~UdpServer()
 {
 }
 
-bool getCommInfoObject(unsigned char *data, Object *obj)
-{
-	bool data_exist = false;
-
-	/* calculate position of object */
-	if(data[0] & COMM_EXIST) {
-		data_exist = true;
-		int x = ((data[0] & 0x0f) << 6) + ((data[1] & 0xfc) >> 2);
-		if((x & 0x0200) != 0) x = -(0x0400 - x);
-		x *= 10;
-		int y = ((data[1] & 0x03) << 8) + data[2];
-		if((y & 0x0200) != 0) y = -(0x0400 - y);
-		y *= 10;
-		const int theta = (data[3] * 2) - 180;
-		const float th = (float)radian(theta);
-		bool is_our_side = ((data[0] & COMM_OUR_SIDE) != 0) ? true : false;
-		bool is_opposite_side = ((data[0] & COMM_OPPOSITE_SIDE) != 0) ? true : false;
-		if(is_our_side && is_opposite_side) obj->type = BALL;
-		if(is_our_side && !is_opposite_side) obj->type = SELF_POS;
-		if(!is_our_side && is_opposite_side) obj->type = ENEMY;
-		if(!is_our_side && !is_opposite_side) obj->type = GOAL_POLE;
-		obj->pos.x = x;
-		obj->pos.y = y;
-		obj->pos.th = th;
+void UdpServer::readPendingDatagrams(void)
+{
+	int received = 0;
+	for(size_t i = 0; i < udpSockets.size(); i++) {
+		while(udpSockets[i]->hasPendingDatagrams()) {
+			// when capturing, receive into the next slot of the capture slab
+			CaptureSlab *capture_slab = capture != nullptr ? capture->slab() : nullptr;
+			unsigned char *buffer = capture_slab != nullptr ? capture_slab->slot(capture_slab->count) : datagram;
+			QHostAddress sender;
+			quint16 sender_port = 0;
+			const bool oversized = udpSockets[i]->pendingDatagramSize() > static_cast<qint64>(sizeof(datagram));
+			const qint64 size = udpSockets[i]->readDatagram(reinterpret_cast<char *>(buffer), sizeof(datagram), &sender, &sender_port);
+			if(size < 0)
+				break;
+			if(oversized) {
+				rejected_datagrams++;
+				continue;
+			}
+			const long long receive_time = monotonicMicroseconds();
+			appendDatagram(i, buffer, size, receive_time);
+			received++;
+			if(capture_slab != nullptr) {
+				packet_capture_record_T &record = capture_slab->records[capture_slab->count];
+				record.kind = CAPTURE_ROBOT;
+				record.size = size;
+				record.local_port = base_port + i;
+				record.source_address = sender.toIPv4Address();
+				record.source_port = sender_port;
+				record.reserved = 0;
+				record.time_us = receive_time;
+				if(++capture_slab->count == CAPTURE_BATCH)
+					capture->submit();
+			}
+		}
 	}
-	return data_exist;
+	if(capture != nullptr)
+		capture->submit();
+	if(received > 0)
+		notify();
 }
+#endif
 
+long long UdpServer::monotonicMicroseconds(void)
+{
+	using namespace std::chrono;
+	return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+/*
+ * Log every received packet to log_writer, which has to outlive the
+ * network thread.
+ */
+void UdpServer::setLogWriter(LogWriter *writer)
+{
+	log_writer = writer;
+}
+
+void UdpServer::appendDatagram(int port_index, const unsigned char *data, size_t size, long long receive_time)
+{
+	// decode straight out of the receive buffer into the mailbox slot
+	const CommInfoView view(data, size);
+	if(!view.isValid()) {
+		rejected_datagrams++;
+		return;
+	}
+	const int slot = robots.slotOf(view.id());
+	TripleBuffer<struct comm_info_T> &mailbox = mailboxes[slot];
+	struct comm_info_T &comm_info = mailbox.writeBuffer();
+	view.copyTo(comm_info);
+
+	if(log_writer != nullptr) {
+		comm_packet_T packet;
+		packet.port_index = port_index;
+		packet.receive_time = receive_time;
+		packet.comm_info = comm_info;
+		log_writer->writePacket(packet);
+	}
+	probe_stats.addPacket(comm_info, receive_time);
+	mailbox.publish();
+	LinkQuality &quality = link_quality[slot];
+	quality.addPacket(receive_time);
+	quality.setSocketDrops(port_drops[port_index]);
+	link_mailboxes[slot].write(quality);
+}
+
+void UdpServer::notify(void)
+{
+	if(probe_stats.packetCount() > 0)
+		probe_mailbox.write(probe_stats);
+	if(!notify_pending.exchange(true))
+		emit dataArrived();
+}
+
+int UdpServer::slotCount(void) const
+{
+	return robots.size();
+}
+
+unsigned char UdpServer::robotKey(int slot) const
+{
+	return robots.keyOf(slot);
+}
+
+void UdpServer::acknowledge(void)
+{
+	notify_pending.store(false);
+}
+
+bool UdpServer::takeLatest(int index, struct comm_info_T &comm_info)
+{
+	return mailboxes[index].read(comm_info);
+}
+
+bool UdpServer::takeLinkQuality(int index, LinkQuality &quality)
+{
+	return link_mailboxes[index].read(quality);
+}
+
+/*
+ * Statistics of the traffic probes received so far, if they changed.
+ */
+bool UdpServer::takeProbeStats(TrafficProbeStats &stats)
+{
+	return probe_mailbox.read(stats);
+}
+
+unsigned int UdpServer::rejectedCount(void) const
+{
+	return rejected_datagrams.load(std::memory_order_relaxed);
+}
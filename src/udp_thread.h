@@ -1,62 +1,124 @@
 #ifndef UDP_THREAD_H
 #define UDP_THREAD_H
 
+#include <atomic>
+#include <memory>
+#include <vector>
+
 #include <QtGui>
 #include <QUdpSocket>
 #include <QtCore>
 
-#include "pos_types.h"
-
-static const int NUM_PLAYERS = 6;
-static const int COMM_INFO_PORT = 7110;
-static const int MAX_COMM_INFO_OBJ = 7;
-static const int MAX_STRING = 74;
-
-static const unsigned char COMM_EXIST = 0x80;
-static const unsigned char COMM_OUR_SIDE = 0x40;
-static const unsigned char COMM_OPPOSITE_SIDE = 0x20;
-static const unsigned char COMM_NOT_EXIST = 0x00;
-
-static const int MAX_BLACK_POLES = 6;
-static const int MAX_YELLOW_POLES = 1;
-static const int MAX_BLUE_POLES = 1;
-static const int MAX_MAGENTA_OBJECTS = 3;
-static const int MAX_CYAN_OBJECTS = 3;
+#ifdef __linux__
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
 
-static const int MAGENTA = 0;
-static const int CYAN    = 1;
-
-struct comm_info_T {
-	unsigned char id;
-	unsigned char cf_own;
-	unsigned char cf_ball;
-	unsigned char object[MAX_COMM_INFO_OBJ][4];
-	unsigned char status;
-	unsigned char fps;
-	unsigned char voltage;
-	unsigned char temperature;
-	unsigned char hishest_servo;
-	unsigned char command[MAX_STRING];
-};
+#include "comm_info.h"
+#include "triple_buffer.h"
+#include "spsc_queue.h"
+#include "link_quality.h"
+#include "robot_registry.h"
+#include "packet_capture.h"
+#include "log_writer.h"
+#include "traffic_probe.h"
 
 Q_DECLARE_METATYPE(comm_info_T);
 
+/*
+ * Receives robot communication from `port_num' consecutive UDP ports.
+ * On Linux every port is registered in one epoll set and drained with
+ * recvmmsg() into a preallocated slab; on other platforms one QUdpSocket
+ * per port is used.
+ *
+ * The server is meant to live on the network thread: construct it, move it
+ * with moveToThread() and invoke start() from that thread. Sockets are
+ * only created in start(), so they belong to the network thread and are
+ * never serviced by the GUI event loop.
+ *
+ * Robots are told apart by the key in comm_info_T::id, whichever port
+ * they send to, and get a dense slot from a RobotRegistry on first
+ * contact. Received data is handed to the GUI thread through a
+ * latest-value mailbox per slot, which the renderer reads once per frame
+ * so that superseded packets cost nothing. Every packet also goes straight
+ * to the LogWriter's packet queue and is formatted on the writer thread,
+ * so the log sees every packet however far the GUI falls behind; the
+ * receive path never allocates or waits. dataArrived() is emitted only
+ * when the GUI has acknowledged the previous notification, so at most one
+ * queued call is outstanding however fast packets arrive.
+ *
+ * Link statistics of every robot are updated on the receive path and
+ * published through a second mailbox. On Linux they include the number of
+ * datagrams the kernel dropped on the socket the robot sends to
+ * (SO_RXQ_OVFL), and receive times are the kernel's (SO_TIMESTAMPNS)
+ * rather than the time the batch was read.
+ *
+ * Traffic probes (traffic_probe.h) are timed on the receive path as well,
+ * against the receive time of each packet, and published through a
+ * mailbox of their own.
+ *
+ * With a packet capture, datagrams are received straight into the slabs of
+ * a capture channel and decoded from there, so capturing costs no copy.
+ */
 class UdpServer : public QObject
 {
 	Q_OBJECT
 public:
-	UdpServer(int);
+	UdpServer(int, int);
 	~UdpServer();
+	// before the network thread starts
+	void setCapture(PacketCapture *);
+	void setLogWriter(LogWriter *);
+	// consumer side, called from the GUI thread
+	int slotCount(void) const;
+	unsigned char robotKey(int) const;
+	void acknowledge(void);
+	bool takeLatest(int, struct comm_info_T &);
+	bool takeLinkQuality(int, LinkQuality &);
+	bool takeProbeStats(TrafficProbeStats &);
+	unsigned int rejectedCount(void) const;
+public slots:
+	void start(void);
 private:
-	struct comm_info_T comm_info;
-	QUdpSocket *udpSocket;
+	static long long monotonicMicroseconds(void);
+	void appendDatagram(int, const unsigned char *, size_t, long long);
+	void notify(void);
+	const int base_port;
+	const int port_num;
+	RobotRegistry robots;
+	std::vector<unsigned int> port_drops;
+	std::unique_ptr<TripleBuffer<struct comm_info_T>[]> mailboxes;
+	std::vector<LinkQuality> link_quality;
+	std::unique_ptr<TripleBuffer<LinkQuality>[]> link_mailboxes;
+	TrafficProbeStats probe_stats;
+	TripleBuffer<TrafficProbeStats> probe_mailbox;
+	LogWriter *log_writer;
+	std::atomic<bool> notify_pending;
+	std::atomic<unsigned int> rejected_datagrams;
+	CaptureChannel *capture;
+#ifdef __linux__
+	static const int RECV_BATCH = 64;
+	static const int MAX_DATAGRAM_SIZE = 128; // slot size in the slab, larger than comm_info_T
+	int readSocket(int);
+	int epoll_fd;
+	std::vector<int> socket_fds;
+	std::vector<int> port_indexes;
+	QSocketNotifier *notifier;
+	std::vector<unsigned char> slab;
+	std::vector<struct mmsghdr> msgs;
+	std::vector<struct iovec> iovecs;
+	std::vector<char> control;
+	std::vector<struct sockaddr_in> senders;
+#else
+	static const int CAPTURE_BATCH = 64;
+	std::vector<QUdpSocket *> udpSockets;
+	unsigned char datagram[sizeof(struct comm_info_T)];
+#endif
 private slots:
 	void readPendingDatagrams(void);
 signals:
-	void receiveData(struct comm_info_T);
+	void dataArrived(void);
 };
 
-bool getCommInfoObject(unsigned char *, Object *);
-
 #endif // UDP_THREAD_H
-
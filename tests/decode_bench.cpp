@@ -0,0 +1,168 @@
+/*
+ * decode_bench: robot datagram decoding, the old per-datagram buffer and
+ * per-object unpack against CommInfoView and decodeCommInfoObjects().
+ *
+ * Both paths decode the same slab of datagrams and must agree on every
+ * object. Heap allocations are counted by replacing operator new; the
+ * view path must not allocate at all.
+ */
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+
+#include "comm_info.h"
+
+static unsigned long long allocations = 0;
+
+void *operator new(std::size_t size)
+{
+	allocations++;
+	void *p = std::malloc(size == 0 ? 1 : size);
+	if(p == nullptr)
+		throw std::bad_alloc();
+	return p;
+}
+
+void operator delete(void *p) noexcept
+{
+	std::free(p);
+}
+
+namespace {
+
+const int DATAGRAMS = 64;
+const int ROUNDS = 20000;
+
+typedef std::chrono::steady_clock bench_clock;
+
+/*
+ * The decoder UdpServer and Interface used before CommInfoView.
+ */
+bool getCommInfoObject(const unsigned char *data, Object *obj)
+{
+	if(!(data[0] & COMM_EXIST))
+		return false;
+	int x = ((data[0] & 0x0f) << 6) + ((data[1] & 0xfc) >> 2);
+	if((x & 0x0200) != 0) x = -(0x0400 - x);
+	x *= 10;
+	int y = ((data[1] & 0x03) << 8) + data[2];
+	if((y & 0x0200) != 0) y = -(0x0400 - y);
+	y *= 10;
+	const int theta = (data[3] * 2) - 180;
+	const float th = static_cast<float>(theta * M_PI / 180.0);
+	const bool is_our_side = (data[0] & COMM_OUR_SIDE) != 0;
+	const bool is_opposite_side = (data[0] & COMM_OPPOSITE_SIDE) != 0;
+	if(is_our_side && is_opposite_side) obj->type = BALL;
+	if(is_our_side && !is_opposite_side) obj->type = SELF_POS;
+	if(!is_our_side && is_opposite_side) obj->type = ENEMY;
+	if(!is_our_side && !is_opposite_side) obj->type = GOAL_POLE;
+	obj->pos.x = x;
+	obj->pos.y = y;
+	obj->pos.th = th;
+	return true;
+}
+
+long long decodeOld(const std::vector<unsigned char> &slab, const std::vector<size_t> &sizes, Object (*objects)[MAX_COMM_INFO_OBJ])
+{
+	long long sum = 0;
+	struct comm_info_T comm_info;
+	for(int n = 0; n < DATAGRAMS; n++) {
+		// a fresh buffer per datagram, like the QByteArray of the old reader
+		std::vector<char> datagram(sizes[n]);
+		std::memcpy(datagram.data(), &slab[n * sizeof(comm_info)], sizes[n]);
+		char *p = reinterpret_cast<char *>(&comm_info);
+		for(size_t i = 0; i < datagram.size() && i < sizeof(comm_info); i++)
+			*p++ = datagram[i];
+		for(int i = 0; i < MAX_COMM_INFO_OBJ; i++) {
+			objects[n][i].type = NONE;
+			if(getCommInfoObject(comm_info.object[i], &objects[n][i]))
+				sum += objects[n][i].pos.x;
+		}
+	}
+	return sum;
+}
+
+long long decodeView(const std::vector<unsigned char> &slab, const std::vector<size_t> &sizes, CommInfoObjects *objects)
+{
+	long long sum = 0;
+	struct comm_info_T comm_info;
+	for(int n = 0; n < DATAGRAMS; n++) {
+		const CommInfoView view(&slab[n * sizeof(comm_info)], sizes[n]);
+		if(!view.isValid())
+			continue;
+		view.copyTo(comm_info);
+		decodeCommInfoObjects(view.objects(), objects[n]);
+		for(int i = 0; i < MAX_COMM_INFO_OBJ; i++)
+			sum += objects[n].type[i] != NONE ? objects[n].x[i] : 0;
+	}
+	return sum;
+}
+
+} // namespace
+
+int main(void)
+{
+	static const int types[] = { NONE, SELF_POS, BALL, ENEMY, GOAL_POLE };
+	std::vector<unsigned char> slab(DATAGRAMS * sizeof(struct comm_info_T));
+	std::vector<size_t> sizes(DATAGRAMS);
+	std::srand(1);
+	for(int n = 0; n < DATAGRAMS; n++) {
+		struct comm_info_T comm_info;
+		std::memset(&comm_info, 0, sizeof(comm_info));
+		comm_info.id = static_cast<unsigned char>(n % 6 + 1);
+		for(int i = 0; i < MAX_COMM_INFO_OBJ; i++) {
+			const Pos pos(std::rand() % 10000 - 5000, std::rand() % 10000 - 5000, (std::rand() % 360 - 180) * M_PI / 180.0);
+			encodeCommInfoObject(comm_info.object[i], types[std::rand() % 5], pos);
+		}
+		std::memcpy(&slab[n * sizeof(comm_info)], &comm_info, sizeof(comm_info));
+		sizes[n] = CommInfoView::MIN_SIZE + std::rand() % (CommInfoView::MAX_SIZE - CommInfoView::MIN_SIZE + 1);
+	}
+
+	Object old_objects[DATAGRAMS][MAX_COMM_INFO_OBJ];
+	CommInfoObjects view_objects[DATAGRAMS];
+	decodeOld(slab, sizes, old_objects);
+	decodeView(slab, sizes, view_objects);
+	for(int n = 0; n < DATAGRAMS; n++) {
+		for(int i = 0; i < MAX_COMM_INFO_OBJ; i++) {
+			const Object &a = old_objects[n][i];
+			if(a.type != view_objects[n].type[i] || (a.type != NONE &&
+				(a.pos.x != view_objects[n].x[i] || a.pos.y != view_objects[n].y[i] || std::fabs(a.pos.th - view_objects[n].th[i]) > 1e-5))) {
+				std::cerr << "decoders disagree on datagram " << n << " object " << i << std::endl;
+				return 1;
+			}
+		}
+	}
+
+	long long check = 0;
+	unsigned long long start_allocations = allocations;
+	bench_clock::time_point start = bench_clock::now();
+	for(int round = 0; round < ROUNDS; round++)
+		check += decodeOld(slab, sizes, old_objects);
+	const double old_s = std::chrono::duration<double>(bench_clock::now() - start).count();
+	const unsigned long long old_allocations = allocations - start_allocations;
+
+	start_allocations = allocations;
+	start = bench_clock::now();
+	for(int round = 0; round < ROUNDS; round++)
+		check -= decodeView(slab, sizes, view_objects);
+	const double view_s = std::chrono::duration<double>(bench_clock::now() - start).count();
+	const unsigned long long view_allocations = allocations - start_allocations;
+
+	const double datagrams = static_cast<double>(DATAGRAMS) * ROUNDS;
+	std::cout << "old:  " << old_s * 1e9 / datagrams << " ns/datagram, " << old_allocations / datagrams << " allocations/datagram" << std::endl
+		<< "view: " << view_s * 1e9 / datagrams << " ns/datagram, " << view_allocations / datagrams << " allocations/datagram" << std::endl
+		<< "speedup: " << old_s / view_s << std::endl;
+	if(check != 0) {
+		std::cerr << "decoders disagree" << std::endl;
+		return 1;
+	}
+	if(view_allocations != 0) {
+		std::cerr << "the view path allocated" << std::endl;
+		return 1;
+	}
+	return 0;
+}
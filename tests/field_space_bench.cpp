@@ -0,0 +1,209 @@
+/*
+ * field_space_bench: information box layout, the original full grid scan
+ * against FieldSpaceManager's summed-area table and ring search.
+ *
+ * A frame marks twelve robots and their balls and then places an
+ * information box for every robot, as FieldPainter::placeInformation()
+ * does when no box of the last frame can be kept. The scan is also run
+ * with exact distances, which is the order FieldSpaceManager promises;
+ * both must place every box in the same spot.
+ */
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "field_space_manager.h"
+
+namespace {
+
+const int FIELD_W = 1040;
+const int FIELD_H = 740;
+const int ROBOTS = 12;
+const int INFO_W = 200;
+const int INFO_H = 80;
+const int SCENES = 200;
+const int ROUNDS = 20;
+
+typedef std::chrono::steady_clock bench_clock;
+
+/*
+ * FieldSpaceManager as it was before the summed-area table: every free
+ * cell is tried as the corner of the box and the candidates are sorted
+ * by their integer distance. With exact set, distances are not truncated.
+ */
+class ScanSpaceManager
+{
+public:
+	ScanSpaceManager(const int field_w, const int field_h, const int grid_x, const int grid_y, const bool exact) : grid_num_x(grid_x), grid_num_y(grid_y), grid_map(grid_num_y, std::vector<int>(grid_num_x, EMPTY)), field_width(field_w), field_height(field_h), fExact(exact) {}
+	void setObjectPos(const int x, const int y, const int w, const int h)
+	{
+		const int step_x = field_width / grid_num_x;
+		const int step_y = field_height / grid_num_y;
+		for(int yi = (y - h / 2) / step_y; yi * step_y < (y + h / 2); yi++) {
+			for(int xi = (x - w / 2) / step_x; xi * step_x < (x + w / 2); xi++) {
+				if(yi < 0 || yi >= grid_num_y) continue;
+				if(xi < 0 || xi >= grid_num_x) continue;
+				grid_map[yi][xi] = EXIST;
+			}
+		}
+	}
+	void clear(void)
+	{
+		for(int i = 0; i < grid_num_y; i++)
+			for(int j = 0; j < grid_num_x; j++)
+				grid_map[i][j] = EMPTY;
+	}
+	bool getEmptySpace(int &space_x, int &space_y, const int request_w, const int request_h, const int priority_x, const int priority_y)
+	{
+		const int grid_step_x = field_width / grid_num_x;
+		const int grid_step_y = field_height / grid_num_y;
+		const int necessary_grid_num_x = request_w / grid_step_x + 1;
+		const int necessary_grid_num_y = request_h / grid_step_y + 1;
+		std::vector<std::pair<int, int>> spaces;
+		for(int yi = 0; yi < grid_num_y; yi++) {
+			for(int xi = 0; xi < grid_num_x; xi++) {
+				if(grid_map[yi][xi] == EMPTY) {
+					for(int yyi = 0; yyi < necessary_grid_num_y; yyi++) {
+						for(int xxi = 0; xxi < necessary_grid_num_x; xxi++) {
+							if(yi + yyi >= grid_num_y) goto exit_loop;
+							if(xi + xxi >= grid_num_x) goto exit_loop;
+							if(grid_map[yi + yyi][xi + xxi] != EMPTY)
+								goto exit_loop;
+						}
+					}
+					spaces.push_back(std::pair<int, int>(xi, yi));
+				}
+exit_loop: ;
+			}
+		}
+		space_x = 0;
+		space_y = 0;
+		if(spaces.empty())
+			return false;
+		size_t min_index = 0;
+		double min_distance = fExact ? std::numeric_limits<double>::max() : 10000;
+		for(size_t index = 0; index < spaces.size(); index++) {
+			const int posx = grid_step_x * spaces[index].first + static_cast<int>(necessary_grid_num_x / 2.0 * grid_step_x);
+			const int posy = grid_step_y * spaces[index].second + static_cast<int>(necessary_grid_num_y / 2.0 * grid_step_y);
+			const int x = posx - priority_x;
+			const int y = posy - priority_y;
+			const double dist = fExact ? std::sqrt(static_cast<double>(x * x + y * y)) : static_cast<int>(std::sqrt(x * x + y * y));
+			if(dist < min_distance) {
+				min_distance = dist;
+				min_index = index;
+			}
+		}
+		const int xi = spaces[min_index].first;
+		const int yi = spaces[min_index].second;
+		for(int yyi = 0; yyi < necessary_grid_num_y; yyi++)
+			for(int xxi = 0; xxi < necessary_grid_num_x; xxi++)
+				grid_map[yi + yyi][xi + xxi] = EXIST;
+		space_x = grid_step_x * xi + static_cast<int>(necessary_grid_num_x / 2.0 * grid_step_x);
+		space_y = grid_step_y * yi + static_cast<int>(necessary_grid_num_y / 2.0 * grid_step_y);
+		return true;
+	}
+private:
+	static const int EXIST = 1;
+	static const int EMPTY = 0;
+	const int grid_num_x;
+	const int grid_num_y;
+	std::vector<std::vector<int>> grid_map;
+	const int field_width;
+	const int field_height;
+	const bool fExact;
+};
+
+struct Scene {
+	int robot_x[ROBOTS], robot_y[ROBOTS];
+	int ball_x[ROBOTS], ball_y[ROBOTS];
+};
+
+/*
+ * One frame of layout; the box centers go to boxes, -1 where none was
+ * found. Returns a checksum of the centers.
+ */
+template <typename Manager>
+long long layout(Manager &field_space, const Scene &scene, std::vector<int> &boxes)
+{
+	field_space.clear();
+	for(int i = 0; i < ROBOTS; i++) {
+		field_space.setObjectPos(scene.robot_x[i], scene.robot_y[i], 200, 200);
+		field_space.setObjectPos(scene.ball_x[i], scene.ball_y[i], 50, 50);
+	}
+	long long sum = 0;
+	for(int i = 0; i < ROBOTS; i++) {
+		int x, y;
+		if(!field_space.getEmptySpace(x, y, INFO_W, INFO_H, scene.robot_x[i], scene.robot_y[i]))
+			x = y = -1;
+		boxes[2 * i] = x;
+		boxes[2 * i + 1] = y;
+		sum += x * FIELD_H + y;
+	}
+	return sum;
+}
+
+} // namespace
+
+int main(void)
+{
+	static const struct {
+		const char *name;
+		int grid_x, grid_y;
+	} grids[] = {
+		{ "monitor", 52, 37 },
+		{ "exporter", 20, 20 },
+	};
+	std::vector<Scene> scenes(SCENES);
+	std::srand(1);
+	for(auto &scene : scenes) {
+		for(int i = 0; i < ROBOTS; i++) {
+			scene.robot_x[i] = std::rand() % FIELD_W;
+			scene.robot_y[i] = std::rand() % FIELD_H;
+			scene.ball_x[i] = std::rand() % FIELD_W;
+			scene.ball_y[i] = std::rand() % FIELD_H;
+		}
+	}
+
+	bool ok = true;
+	for(const auto &grid : grids) {
+		ScanSpaceManager scan(FIELD_W, FIELD_H, grid.grid_x, grid.grid_y, false);
+		ScanSpaceManager exact_scan(FIELD_W, FIELD_H, grid.grid_x, grid.grid_y, true);
+		FieldSpaceManager field_space(FIELD_W, FIELD_H, grid.grid_x, grid.grid_y);
+		std::vector<int> expected(2 * ROBOTS), boxes(2 * ROBOTS);
+		int placed = 0;
+		for(int n = 0; n < SCENES; n++) {
+			layout(exact_scan, scenes[n], expected);
+			layout(field_space, scenes[n], boxes);
+			if(boxes != expected) {
+				std::cerr << grid.name << " grid: scene " << n << " is laid out differently" << std::endl;
+				ok = false;
+			}
+			for(int i = 0; i < ROBOTS; i++)
+				placed += expected[2 * i] >= 0;
+		}
+
+		long long check = 0;
+		bench_clock::time_point start = bench_clock::now();
+		for(int round = 0; round < ROUNDS; round++)
+			for(const auto &scene : scenes)
+				check += layout(scan, scene, boxes);
+		const double scan_s = std::chrono::duration<double>(bench_clock::now() - start).count();
+		start = bench_clock::now();
+		for(int round = 0; round < ROUNDS; round++)
+			for(const auto &scene : scenes)
+				check += layout(field_space, scene, boxes);
+		const double table_s = std::chrono::duration<double>(bench_clock::now() - start).count();
+
+		const double frames = static_cast<double>(SCENES) * ROUNDS;
+		std::cout << grid.name << " grid " << grid.grid_x << "x" << grid.grid_y << ", "
+			<< placed * 100.0 / (SCENES * ROBOTS) << "% of boxes placed" << std::endl
+			<< "  scan:  " << scan_s * 1e6 / frames << " us/frame" << std::endl
+			<< "  table: " << table_s * 1e6 / frames << " us/frame" << std::endl
+			<< "  speedup: " << scan_s / table_s << " (checksum " << check << ")" << std::endl;
+	}
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,162 @@
+/*
+ * gc_decode_test: GameController packets of every supported protocol
+ * version decoded by GameState.
+ *
+ * The packets are built from the layouts in gc_layout.h with different
+ * values at every field, so a field read at the offset of another version
+ * shows up as a wrong value. Also checks the size and version checks and
+ * the packet numbering of several GameControllers at once.
+ */
+#include <iostream>
+#include <cstring>
+#include <vector>
+
+#include "game_state.h"
+#include "gc_layout.h"
+
+static int failures = 0;
+
+#define CHECK(cond) \
+	do { \
+		if(!(cond)) { \
+			std::cerr << __FILE__ << ":" << __LINE__ << ": " #cond << std::endl; \
+			failures++; \
+		} \
+	} while(0)
+
+static void writeInt16(unsigned char *p, const int value)
+{
+	p[0] = value & 0xff;
+	p[1] = (value >> 8) & 0xff;
+}
+
+/*
+ * A packet of the given layout. The teams are blue and red, with scores
+ * score1 and score2, and player i of team t has penalty 10 * t + i.
+ */
+template<class Layout>
+static std::vector<char> makePacket(const int packet_number, const int state, const int secs_remaining, const int score1, const int score2)
+{
+	typedef Layout L;
+	std::vector<unsigned char> data(L::packet_size, 0);
+	std::memcpy(data.data(), "RGme", 4);
+	writeInt16(&data[4], L::version);
+	data[L::packet_number] = packet_number;
+	data[L::players_per_team] = 4;
+	data[L::state] = state;
+	data[L::first_half] = 1;
+	data[L::kick_off_team] = 7;
+	data[L::secondary_state] = 2;
+	writeInt16(&data[L::secs_remaining], secs_remaining);
+	writeInt16(&data[L::secondary_time], -5);
+	for(int t = 0; t < 2; t++) {
+		unsigned char *team = &data[L::team_info + t * L::team_info_size];
+		team[L::team_number] = 20 + t;
+		team[L::team_color] = t == 0 ? GC_TEAM_COLOR_BLUE : GC_TEAM_COLOR_RED;
+		team[L::score] = t == 0 ? score1 : score2;
+		writeInt16(&team[L::single_shots], 0x0102 + t);
+		team[L::coach_sequence] = 30 + t;
+		team[L::coach] = 40 + t;
+		for(unsigned int i = 0; i < L::max_players; i++)
+			team[L::players + i * L::robot_info_size] = 10 * t + i;
+	}
+	return std::vector<char>(data.begin(), data.end());
+}
+
+template<class Layout>
+static void testVersion(void)
+{
+	typedef Layout L;
+	GameState game_state;
+	std::vector<char> packet = makePacket<L>(1, 3, 421, 2, 1);
+	CHECK(game_state.setData(packet.data(), packet.size()) == GS_ALL);
+	const GameStateData &data = game_state.getData();
+	CHECK(data.version == L::version);
+	CHECK(data.game_state == 3);
+	CHECK(data.remaining_time == 421);
+	CHECK(data.secondary_time == -5);
+	CHECK(data.players_per_team == 4);
+	CHECK(data.first_half == 1);
+	CHECK(data.kick_off_team == 7);
+	CHECK(data.secondary_state == 2);
+	CHECK(data.score1 == 2);
+	CHECK(data.score2 == 1);
+	for(int t = 0; t < 2; t++) {
+		const GCTeamInfo &team = game_state.getTeamInfo(t);
+		CHECK(team.team_number == 20 + t);
+		CHECK(team.single_shots == 0x0102 + t);
+		CHECK(team.coach_sequence == 30 + t);
+		CHECK(team.coach.penalty == 40 + t);
+		for(unsigned int i = 0; i < L::max_players; i++)
+			CHECK(team.players[i].penalty == 10 * t + i);
+	}
+
+	// only what changed is reported
+	packet = makePacket<L>(2, 3, 420, 2, 2);
+	CHECK(game_state.setData(packet.data(), packet.size()) == (GS_REMAINING_TIME | GS_SCORE2 | GS_TEAM_INFO));
+	CHECK(game_state.getScore2() == 2);
+
+	// a packet one byte short is malformed
+	packet = makePacket<L>(3, 4, 419, 2, 2);
+	CHECK(game_state.setData(packet.data(), packet.size() - 1) == 0);
+	CHECK(game_state.getRejectedPackets() == 1);
+	CHECK(game_state.getGameState() == 3);
+}
+
+/*
+ * The first packet reports every field, even if all of them are 0.
+ */
+static void testFirstPacket(void)
+{
+	GameState game_state;
+	const std::vector<char> packet = makePacket<GCLayoutV12>(0, 0, 0, 0, 0);
+	CHECK(game_state.setData(packet.data(), packet.size()) == GS_ALL);
+}
+
+static void testUnsupported(void)
+{
+	GameState game_state;
+	std::vector<char> packet = makePacket<GCLayoutV12>(1, 3, 421, 2, 1);
+	writeInt16(reinterpret_cast<unsigned char *>(&packet[4]), 10);
+	CHECK(game_state.setData(packet.data(), packet.size()) == 0);
+	CHECK(game_state.getUnsupportedPackets() == 1);
+	CHECK(game_state.getRejectedPackets() == 0);
+}
+
+/*
+ * Two GameControllers with their own packet numbers: neither is taken
+ * for late packets of the other, and duplicates of each are rejected.
+ */
+static void testSources(void)
+{
+	GameState game_state;
+	const unsigned int gc1 = 0x0a000001, gc2 = 0x0a000002;
+	std::vector<char> packet = makePacket<GCLayoutV12>(100, 1, 600, 0, 0);
+	CHECK(game_state.setData(packet.data(), packet.size(), gc1) != 0);
+	packet = makePacket<GCLayoutV12>(5, 2, 500, 0, 0);
+	CHECK(game_state.setData(packet.data(), packet.size(), gc2) != 0);
+	packet = makePacket<GCLayoutV12>(101, 3, 599, 0, 0);
+	CHECK(game_state.setData(packet.data(), packet.size(), gc1) != 0);
+	packet = makePacket<GCLayoutV12>(6, 4, 499, 0, 0);
+	CHECK(game_state.setData(packet.data(), packet.size(), gc2) != 0);
+	CHECK(game_state.getRejectedPackets() == 0);
+	packet = makePacket<GCLayoutV12>(101, 1, 599, 0, 0);
+	CHECK(game_state.setData(packet.data(), packet.size(), gc1) == 0);
+	CHECK(game_state.getRejectedPackets() == 1);
+	CHECK(game_state.getGameState() == 4);
+}
+
+int main(void)
+{
+	testVersion<GCLayoutV12>();
+	testVersion<GCLayoutV11>();
+	testFirstPacket();
+	testUnsupported();
+	testSources();
+	if(failures > 0) {
+		std::cerr << failures << " checks failed" << std::endl;
+		return 1;
+	}
+	std::cout << "all checks passed" << std::endl;
+	return 0;
+}
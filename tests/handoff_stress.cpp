@@ -0,0 +1,140 @@
+/*
+ * handoff_stress: the network thread handoff under a slow renderer.
+ *
+ * A sender streams probe-carrying robot datagrams over the loopback. A
+ * network thread receives and decodes them and hands them on the way
+ * UdpServer does: a TripleBuffer mailbox per robot for the renderer and a
+ * SpscQueue that carries every packet to the log. The main thread plays
+ * the GUI and takes far longer per frame than the packet interval.
+ *
+ * Passes when the ingest latency measured on the network thread stays far
+ * below the frame time, no datagram is lost, and the log side sees every
+ * packet in order.
+ */
+#include <iostream>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "comm_info.h"
+#include "spsc_queue.h"
+#include "traffic_probe.h"
+#include "triple_buffer.h"
+
+namespace {
+
+const int ROBOTS = 6;
+const int PACKETS_PER_ROBOT = 1500;
+const int SEND_INTERVAL_US = 500;   // between packets of all robots, 2000 packets/s
+const int FRAME_TIME_MS = 40;       // a slow repaint
+const int LOG_QUEUE_SIZE = 4096;    // as in UdpServer
+const double MAX_INGEST_LATENCY_MS = FRAME_TIME_MS / 2.0;
+
+std::atomic<bool> sending(true);
+
+void sendPackets(const struct sockaddr_in addr)
+{
+	const int sock = socket(AF_INET, SOCK_DGRAM, 0);
+	struct comm_info_T comm_info;
+	std::memset(&comm_info, 0, sizeof(comm_info));
+	std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+	for(int n = 0; n < PACKETS_PER_ROBOT; n++) {
+		for(int robot = 0; robot < ROBOTS; robot++) {
+			comm_info.id = static_cast<unsigned char>(robot + 1);
+			writeTrafficProbe(comm_info, n, probeClockMicroseconds());
+			sendto(sock, &comm_info, sizeof(comm_info), 0, reinterpret_cast<const struct sockaddr *>(&addr), sizeof(addr));
+		}
+		next += std::chrono::microseconds(SEND_INTERVAL_US * ROBOTS);
+		std::this_thread::sleep_until(next);
+	}
+	close(sock);
+	sending = false;
+}
+
+} // namespace
+
+int main(void)
+{
+	const int sock = socket(AF_INET, SOCK_DGRAM, 0);
+	struct sockaddr_in addr;
+	std::memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	socklen_t len = sizeof(addr);
+	if(sock < 0 || bind(sock, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) < 0 ||
+		getsockname(sock, reinterpret_cast<struct sockaddr *>(&addr), &len) < 0) {
+		std::cerr << "socket setup failed: " << std::strerror(errno) << std::endl;
+		return 1;
+	}
+
+	TripleBuffer<struct comm_info_T> mailboxes[ROBOTS + 1];
+	SpscQueue<struct comm_info_T> log_queue(LOG_QUEUE_SIZE);
+	std::atomic<unsigned long long> log_dropped(0);
+	TrafficProbeStats ingest_stats;
+	std::atomic<bool> receiving(true);
+
+	std::thread network([&] {
+		unsigned char datagram[sizeof(struct comm_info_T)];
+		struct pollfd pfd = { sock, POLLIN, 0 };
+		while(receiving) {
+			if(poll(&pfd, 1, 10) <= 0)
+				continue;
+			const ssize_t size = recv(sock, datagram, sizeof(datagram), 0);
+			const CommInfoView view(datagram, size < 0 ? 0 : size);
+			if(!view.isValid() || view.id() > ROBOTS)
+				continue;
+			struct comm_info_T &comm_info = mailboxes[view.id()].writeBuffer();
+			view.copyTo(comm_info);
+			ingest_stats.addPacket(comm_info, probeClockMicroseconds());
+			if(!log_queue.push(comm_info))
+				log_dropped++;
+			mailboxes[view.id()].publish();
+		}
+	});
+	std::thread sender(sendPackets, addr);
+
+	TrafficProbeStats log_stats;
+	int frames = 0;
+	for(;;) {
+		const bool last = !sending;
+		std::this_thread::sleep_for(std::chrono::milliseconds(FRAME_TIME_MS));
+		struct comm_info_T comm_info;
+		for(int robot = 1; robot <= ROBOTS; robot++)
+			mailboxes[robot].read(comm_info);
+		while(log_queue.pop(comm_info))
+			log_stats.addPacket(comm_info, probeClockMicroseconds());
+		frames++;
+		if(last)
+			break;
+	}
+	receiving = false;
+	sender.join();
+	network.join();
+	close(sock);
+
+	const unsigned long long expected = static_cast<unsigned long long>(ROBOTS) * PACKETS_PER_ROBOT;
+	std::cout << "frames: " << frames << " of " << FRAME_TIME_MS << " ms" << std::endl
+		<< "ingest: " << ingest_stats.packetCount() << " packets, " << ingest_stats.lostCount() << " lost, latency mean "
+		<< ingest_stats.meanLatencyMs() << " ms, max " << ingest_stats.maxLatencyMs() << " ms" << std::endl
+		<< "log: " << log_stats.packetCount() << " packets, " << log_stats.lostCount() << " out of order or lost, "
+		<< log_dropped << " dropped at the queue" << std::endl;
+	bool ok = true;
+	if(ingest_stats.packetCount() != expected || log_stats.packetCount() != expected || log_stats.lostCount() != 0) {
+		std::cerr << "expected " << expected << " packets on both sides" << std::endl;
+		ok = false;
+	}
+	if(ingest_stats.maxLatencyMs() > MAX_INGEST_LATENCY_MS) {
+		std::cerr << "ingest latency follows the frame time" << std::endl;
+		ok = false;
+	}
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,182 @@
+/*
+ * ingest_bench: robot datagram ingest rate, one datagram per call versus
+ * the batched receiver of UdpServer.
+ *
+ * Bursts of comm_info_T datagrams are sent over the loopback to six ports
+ * and then drained, once the way the per-port QUdpSocket receivers did
+ * (one recvfrom() and one buffer allocation per datagram, port by port)
+ * and once the way UdpServer does on Linux (one epoll set, recvmmsg() into
+ * a preallocated slab). Only the draining is timed. Fails if a datagram
+ * goes missing.
+ */
+#include <iostream>
+#include <chrono>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "comm_info.h"
+
+namespace {
+
+const int PORT_COUNT = 6;
+const int BURST = 60;         // datagrams per port and burst
+const int ROUNDS = 200;
+const int RECV_BATCH = 64;    // as in UdpServer
+const int MAX_DATAGRAM_SIZE = 128;
+
+typedef std::chrono::steady_clock bench_clock;
+
+struct Sockets {
+	std::vector<int> fds;
+	std::vector<struct sockaddr_in> addrs;
+	~Sockets()
+	{
+		for(auto fd : fds)
+			close(fd);
+	}
+};
+
+bool openSockets(Sockets &sockets)
+{
+	for(int i = 0; i < PORT_COUNT; i++) {
+		const int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+		if(fd < 0)
+			return false;
+		sockets.fds.push_back(fd);
+		const int buffer_size = 4 << 20;
+		setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
+		struct sockaddr_in addr;
+		std::memset(&addr, 0, sizeof(addr));
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		addr.sin_port = 0;
+		socklen_t len = sizeof(addr);
+		if(bind(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) < 0 ||
+			getsockname(fd, reinterpret_cast<struct sockaddr *>(&addr), &len) < 0)
+			return false;
+		sockets.addrs.push_back(addr);
+	}
+	return true;
+}
+
+void sendBurst(const int sock, const Sockets &sockets)
+{
+	struct comm_info_T comm_info;
+	std::memset(&comm_info, 0, sizeof(comm_info));
+	for(int n = 0; n < BURST; n++) {
+		for(int i = 0; i < PORT_COUNT; i++) {
+			comm_info.id = static_cast<unsigned char>(i + 1);
+			sendto(sock, &comm_info, sizeof(comm_info), 0, reinterpret_cast<const struct sockaddr *>(&sockets.addrs[i]), sizeof(sockets.addrs[i]));
+		}
+	}
+}
+
+/*
+ * The old receive path: every port drained on its own, one datagram and
+ * one freshly allocated buffer at a time.
+ */
+long long drainSingle(const Sockets &sockets)
+{
+	long long received = 0;
+	for(auto fd : sockets.fds) {
+		for(;;) {
+			std::unique_ptr<unsigned char[]> datagram(new unsigned char[sizeof(struct comm_info_T)]);
+			const ssize_t size = recv(fd, datagram.get(), sizeof(struct comm_info_T), 0);
+			if(size < 0)
+				break;
+			received += CommInfoView(datagram.get(), size).isValid() ? 1 : 0;
+		}
+	}
+	return received;
+}
+
+/*
+ * The UdpServer receive path: ready sockets from one epoll set, each
+ * drained in batches into the same slab.
+ */
+long long drainBatched(const int epoll_fd, const Sockets &sockets, std::vector<unsigned char> &slab, std::vector<struct mmsghdr> &msgs)
+{
+	long long received = 0;
+	struct epoll_event events[PORT_COUNT];
+	const int n = epoll_wait(epoll_fd, events, PORT_COUNT, 0);
+	for(int e = 0; e < n; e++) {
+		const int fd = sockets.fds[events[e].data.u32];
+		for(;;) {
+			const int count = recvmmsg(fd, msgs.data(), RECV_BATCH, MSG_DONTWAIT, nullptr);
+			if(count <= 0)
+				break;
+			for(int i = 0; i < count; i++)
+				received += CommInfoView(&slab[i * MAX_DATAGRAM_SIZE], msgs[i].msg_len).isValid() ? 1 : 0;
+			if(count < RECV_BATCH)
+				break;
+		}
+	}
+	return received;
+}
+
+} // namespace
+
+int main(void)
+{
+	Sockets sockets;
+	const int sock = socket(AF_INET, SOCK_DGRAM, 0);
+	if(sock < 0 || !openSockets(sockets)) {
+		std::cerr << "socket setup failed: " << std::strerror(errno) << std::endl;
+		return 1;
+	}
+	const int epoll_fd = epoll_create1(0);
+	for(int i = 0; i < PORT_COUNT; i++) {
+		struct epoll_event ev;
+		std::memset(&ev, 0, sizeof(ev));
+		ev.events = EPOLLIN;
+		ev.data.u32 = i;
+		epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sockets.fds[i], &ev);
+	}
+	std::vector<unsigned char> slab(RECV_BATCH * MAX_DATAGRAM_SIZE);
+	std::vector<struct iovec> iovecs(RECV_BATCH);
+	std::vector<struct mmsghdr> msgs(RECV_BATCH);
+	for(int i = 0; i < RECV_BATCH; i++) {
+		iovecs[i].iov_base = &slab[i * MAX_DATAGRAM_SIZE];
+		iovecs[i].iov_len = MAX_DATAGRAM_SIZE;
+		std::memset(&msgs[i], 0, sizeof(msgs[i]));
+		msgs[i].msg_hdr.msg_iov = &iovecs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	const long long expected = static_cast<long long>(ROUNDS) * BURST * PORT_COUNT;
+	bench_clock::duration single_time(0), batched_time(0);
+	long long single = 0, batched = 0;
+	for(int round = 0; round < ROUNDS; round++) {
+		sendBurst(sock, sockets);
+		bench_clock::time_point start = bench_clock::now();
+		single += drainSingle(sockets);
+		single_time += bench_clock::now() - start;
+
+		sendBurst(sock, sockets);
+		start = bench_clock::now();
+		batched += drainBatched(epoll_fd, sockets, slab, msgs);
+		batched_time += bench_clock::now() - start;
+	}
+	close(epoll_fd);
+	close(sock);
+
+	const double single_s = std::chrono::duration<double>(single_time).count();
+	const double batched_s = std::chrono::duration<double>(batched_time).count();
+	std::cout << "per datagram: " << single << " datagrams, " << single / single_s << " /s" << std::endl
+		<< "batched:      " << batched << " datagrams, " << batched / batched_s << " /s" << std::endl
+		<< "speedup:      " << single_s / batched_s << std::endl;
+	if(single != expected || batched != expected) {
+		std::cerr << "expected " << expected << " datagrams each" << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,194 @@
+/*
+ * log_archive_test: a game written to a LogArchive and read back, whole
+ * and by time range.
+ *
+ * The game spans several blocks and midnight, and has robots of both
+ * colors and every kind of game event. Everything LogData holds must come
+ * back, theta to 1e-6 and the voltage to 0.01. Logs archived together
+ * under the same name must not overwrite each other.
+ */
+#include <iostream>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <QDir>
+#include <QFile>
+#include <QString>
+
+#include "binary_log.h"
+#include "log_archive.h"
+#include "log_reader.h"
+
+static int failures = 0;
+
+#define CHECK(cond) \
+	do { \
+		if(!(cond)) { \
+			std::cerr << __FILE__ << ":" << __LINE__ << ": " #cond << std::endl; \
+			failures++; \
+		} \
+	} while(0)
+
+static const int ENTRIES = 3 * LogArchive::BLOCK_ENTRIES + 100;
+static const long long DAY_MS = 24LL * 60 * 60 * 1000;
+// the first block ends at midnight, 10 ms between entries
+static const long long START_MS = DAY_MS - LogArchive::BLOCK_ENTRIES * 10LL;
+
+static std::vector<LogData> makeGame(void)
+{
+	std::vector<LogData> log_data(ENTRIES);
+	std::srand(1);
+	long long time_ms = START_MS;
+	for(int i = 0; i < ENTRIES; i++, time_ms += 10) {
+		LogData &ldata = log_data[i];
+		logTimeString(ldata.time_str, sizeof(ldata.time_str), time_ms);
+		if(i % 50 == 10) {
+			ldata.type = LOG_TYPE_REMAININGTIME;
+			ldata.remaining_time = 600 - i / 100;
+		} else if(i % 50 == 20) {
+			ldata.type = LOG_TYPE_SECONDARYTIME;
+			ldata.secondary_time = i / 100;
+		} else if(i % 500 == 30) {
+			ldata.type = LOG_TYPE_SCORE1;
+			ldata.score1 = i / 500;
+		} else if(i % 500 == 40) {
+			ldata.type = LOG_TYPE_SCORE2;
+			ldata.score2 = i / 1000;
+		} else if(i % 1000 == 45) {
+			ldata.type = LOG_TYPE_GAMESTATE;
+			ldata.game_state = i / 1000 % 5;
+		} else {
+			LogDataRobotComm &buf = ldata.robot_comm;
+			ldata.type = LOG_TYPE_ROBOTINFO;
+			strcpy(buf.time_str, ldata.time_str);
+			buf.id = i % 6 + 1;
+			strcpy(buf.color_str, i % 2 == 0 ? "CYAN" : "MAGENTA");
+			buf.fps = 20 + std::rand() % 10;
+			buf.voltage = (std::rand() % 1000 + 1000) / 100.0;
+			buf.x = std::rand() % 1040;
+			buf.y = std::rand() % 740;
+			buf.theta = std::floor((std::rand() % 6283 - 3141) / 1000.0 * 1e6) / 1e6;
+			buf.ball_x = std::rand() % 1040;
+			buf.ball_y = std::rand() % 740;
+			buf.goal_pole_x1 = -1;
+			buf.goal_pole_y1 = -1;
+			buf.goal_pole_x2 = std::rand() % 1040;
+			buf.goal_pole_y2 = std::rand() % 740;
+			buf.cf_own = std::rand() % 101;
+			buf.cf_ball = std::rand() % 101;
+			snprintf(buf.msg, sizeof(buf.msg), "state %d", i % 7);
+		}
+	}
+	return log_data;
+}
+
+static bool sameEntry(const LogData &a, const LogData &b)
+{
+	if(a.type != b.type || strcmp(a.time_str, b.time_str) != 0)
+		return false;
+	if(a.type == LOG_TYPE_SCORE1)
+		return a.score1 == b.score1;
+	if(a.type == LOG_TYPE_SCORE2)
+		return a.score2 == b.score2;
+	if(a.type == LOG_TYPE_REMAININGTIME)
+		return a.remaining_time == b.remaining_time;
+	if(a.type == LOG_TYPE_SECONDARYTIME)
+		return a.secondary_time == b.secondary_time;
+	if(a.type == LOG_TYPE_GAMESTATE)
+		return a.game_state == b.game_state;
+	const LogDataRobotComm &x = a.robot_comm;
+	const LogDataRobotComm &y = b.robot_comm;
+	return x.id == y.id && strcmp(x.color_str, y.color_str) == 0 && x.fps == y.fps &&
+		std::fabs(x.voltage - y.voltage) < 0.01 + 1e-9 && x.x == y.x && x.y == y.y &&
+		std::fabs(x.theta - y.theta) < 1e-6 + 1e-9 && x.ball_x == y.ball_x && x.ball_y == y.ball_y &&
+		x.goal_pole_x1 == y.goal_pole_x1 && x.goal_pole_y1 == y.goal_pole_y1 &&
+		x.goal_pole_x2 == y.goal_pole_x2 && x.goal_pole_y2 == y.goal_pole_y2 &&
+		x.cf_own == y.cf_own && x.cf_ball == y.cf_ball && strcmp(x.msg, y.msg) == 0;
+}
+
+static void testRoundTrip(const QString &path, const std::vector<LogData> &log_data)
+{
+	CHECK(LogArchive::write(path, log_data));
+	CHECK(isLogArchive(path.toStdString()));
+	LogArchive archive;
+	CHECK(archive.open(path));
+	CHECK(archive.blockCount() == 4);
+	CHECK(archive.startMs() == START_MS);
+	CHECK(archive.endMs() == START_MS + (ENTRIES - 1) * 10LL);
+
+	std::vector<LogData> read_back;
+	CHECK(archive.readAll(read_back));
+	CHECK(read_back.size() == log_data.size());
+	int wrong = 0;
+	for(size_t i = 0; i < log_data.size() && i < read_back.size(); i++) {
+		if(!sameEntry(log_data[i], read_back[i]))
+			wrong++;
+	}
+	CHECK(wrong == 0);
+
+	// readLogFile() recognizes archives as well
+	std::vector<LogData> read_file;
+	CHECK(readLogFile(path.toStdString(), read_file));
+	CHECK(read_file.size() == log_data.size());
+}
+
+/*
+ * A range across a block boundary and past midnight returns exactly the
+ * entries inside it.
+ */
+static void testRange(const QString &path, const std::vector<LogData> &log_data)
+{
+	LogArchive archive;
+	CHECK(archive.open(path));
+	const size_t first = LogArchive::BLOCK_ENTRIES - 20;
+	const size_t last = LogArchive::BLOCK_ENTRIES + 30;
+	const long long from_ms = archive.startMs() + first * 10LL;
+	const long long to_ms = archive.startMs() + last * 10LL;
+	CHECK(from_ms < DAY_MS && to_ms > DAY_MS);
+	std::vector<LogData> range;
+	CHECK(archive.read(from_ms, to_ms, range));
+	CHECK(range.size() == last - first + 1);
+	for(size_t i = 0; i < range.size() && first + i < log_data.size(); i++)
+		CHECK(sameEntry(log_data[first + i], range[i]));
+}
+
+/*
+ * Logs of the same name from different directories are archived to
+ * different files.
+ */
+static void testArchiveNames(const std::vector<LogData> &log_data)
+{
+	const QString dir = QDir::tempPath() + "/log_archive_test";
+	CHECK(QDir().mkpath(dir + "/a") && QDir().mkpath(dir + "/b"));
+	std::vector<std::string> inputs;
+	inputs.push_back((dir + "/a/game.log").toStdString());
+	inputs.push_back((dir + "/b/game.log").toStdString());
+	inputs.push_back((dir + "/b/Game.txt").toStdString());
+	for(const auto &input : inputs)
+		CHECK(writeBinaryLog(input, log_data));
+	CHECK(archiveLogs(inputs, dir + "/out") == 0);
+	CHECK(isLogArchive((dir + "/out/game.logz").toStdString()));
+	CHECK(isLogArchive((dir + "/out/game-2.logz").toStdString()));
+	CHECK(isLogArchive((dir + "/out/Game-3.logz").toStdString()));
+	QDir(dir).removeRecursively();
+}
+
+int main(void)
+{
+	const QString path = QDir::tempPath() + "/log_archive_test.logz";
+	const std::vector<LogData> log_data = makeGame();
+	testRoundTrip(path, log_data);
+	testRange(path, log_data);
+	testArchiveNames(log_data);
+	QFile::remove(path);
+	if(failures > 0) {
+		std::cerr << failures << " checks failed" << std::endl;
+		return 1;
+	}
+	std::cout << "all checks passed" << std::endl;
+	return 0;
+}
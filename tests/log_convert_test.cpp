@@ -0,0 +1,163 @@
+/*
+ * log_convert_test: a game written as a text log of every format and as
+ * a binary log, and read back with readLogFile().
+ *
+ * Format 2.1 keeps the times with milliseconds, 2.0 and 1.0 in whole
+ * seconds, and 1.0 leaves out the secondary time and the game state. A
+ * binary log cuts robot messages to its text field.
+ */
+#include <iostream>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <QDir>
+#include <QFile>
+#include <QString>
+
+#include "binary_log.h"
+#include "log_reader.h"
+
+static int failures = 0;
+
+#define CHECK(cond) \
+	do { \
+		if(!(cond)) { \
+			std::cerr << __FILE__ << ":" << __LINE__ << ": " #cond << std::endl; \
+			failures++; \
+		} \
+	} while(0)
+
+static const int ENTRIES = 600;
+
+static std::vector<LogData> makeGame(void)
+{
+	std::vector<LogData> log_data(ENTRIES);
+	long long time_ms = (13 * 60 + 5) * 60 * 1000LL;
+	for(int i = 0; i < ENTRIES; i++, time_ms += 37) {
+		LogData &ldata = log_data[i];
+		logTimeString(ldata.time_str, sizeof(ldata.time_str), time_ms);
+		if(i % 50 == 10) {
+			ldata.type = LOG_TYPE_REMAININGTIME;
+			ldata.remaining_time = 600 - i / 10;
+		} else if(i % 50 == 20) {
+			ldata.type = LOG_TYPE_SECONDARYTIME;
+			ldata.secondary_time = i / 10;
+		} else if(i % 100 == 30) {
+			ldata.type = LOG_TYPE_SCORE1;
+			ldata.score1 = i / 100;
+		} else if(i % 100 == 40) {
+			ldata.type = LOG_TYPE_SCORE2;
+			ldata.score2 = i / 200;
+		} else if(i % 100 == 45) {
+			ldata.type = LOG_TYPE_GAMESTATE;
+			ldata.game_state = i / 100 % 5;
+		} else {
+			LogDataRobotComm &buf = ldata.robot_comm;
+			ldata.type = LOG_TYPE_ROBOTINFO;
+			strcpy(buf.time_str, ldata.time_str);
+			buf.id = i % 6 + 1;
+			strcpy(buf.color_str, i % 2 == 0 ? "CYAN" : "MAGENTA");
+			buf.fps = 20 + i % 10;
+			buf.voltage = 12.25;
+			buf.x = i % 1040;
+			buf.y = i % 740;
+			buf.theta = (i % 628 - 314) / 100.0;
+			buf.ball_x = (i * 7) % 1040;
+			buf.ball_y = (i * 7) % 740;
+			buf.goal_pole_x1 = -1;
+			buf.goal_pole_y1 = -1;
+			buf.goal_pole_x2 = i % 300;
+			buf.goal_pole_y2 = i % 200;
+			buf.cf_own = i % 101;
+			buf.cf_ball = (i * 3) % 101;
+			snprintf(buf.msg, sizeof(buf.msg), "state %d", i % 7);
+		}
+	}
+	return log_data;
+}
+
+/*
+ * Whether b is a read back, with times in whole seconds unless
+ * milliseconds is set.
+ */
+static bool sameEntry(const LogData &a, const LogData &b, const bool milliseconds)
+{
+	const long long time_a = logTimeMs(a.time_str);
+	const long long time_b = logTimeMs(b.time_str);
+	if(a.type != b.type || time_b != (milliseconds ? time_a : time_a / 1000 * 1000))
+		return false;
+	if(a.type == LOG_TYPE_SCORE1)
+		return a.score1 == b.score1;
+	if(a.type == LOG_TYPE_SCORE2)
+		return a.score2 == b.score2;
+	if(a.type == LOG_TYPE_REMAININGTIME)
+		return a.remaining_time == b.remaining_time;
+	if(a.type == LOG_TYPE_SECONDARYTIME)
+		return a.secondary_time == b.secondary_time;
+	if(a.type == LOG_TYPE_GAMESTATE)
+		return a.game_state == b.game_state;
+	const LogDataRobotComm &x = a.robot_comm;
+	const LogDataRobotComm &y = b.robot_comm;
+	return x.id == y.id && strcmp(x.color_str, y.color_str) == 0 && x.fps == y.fps &&
+		std::fabs(x.voltage - y.voltage) < 0.01 && x.x == y.x && x.y == y.y &&
+		std::fabs(x.theta - y.theta) < 1e-6 && x.ball_x == y.ball_x && x.ball_y == y.ball_y &&
+		x.goal_pole_x1 == y.goal_pole_x1 && x.goal_pole_y1 == y.goal_pole_y1 &&
+		x.goal_pole_x2 == y.goal_pole_x2 && x.goal_pole_y2 == y.goal_pole_y2 &&
+		x.cf_own == y.cf_own && x.cf_ball == y.cf_ball && strcmp(x.msg, y.msg) == 0;
+}
+
+static void testText(const std::string &path, const std::vector<LogData> &log_data, const TextLogVersion version)
+{
+	CHECK(writeTextLog(path, log_data, version));
+	std::vector<LogData> read_back;
+	CHECK(readLogFile(path, read_back));
+	std::vector<LogData> expected;
+	for(const auto &ldata : log_data) {
+		if(version != TEXT_LOG_1_0 || (ldata.type != LOG_TYPE_SECONDARYTIME && ldata.type != LOG_TYPE_GAMESTATE))
+			expected.push_back(ldata);
+	}
+	CHECK(read_back.size() == expected.size());
+	int wrong = 0;
+	for(size_t i = 0; i < expected.size() && i < read_back.size(); i++) {
+		if(!sameEntry(expected[i], read_back[i], version == TEXT_LOG_2_1))
+			wrong++;
+	}
+	CHECK(wrong == 0);
+}
+
+static void testBinaryMessage(const std::string &path, std::vector<LogData> log_data)
+{
+	LogDataRobotComm &buf = log_data[0].robot_comm;
+	CHECK(log_data[0].type == LOG_TYPE_ROBOTINFO);
+	memset(buf.msg, 'a', sizeof(buf.msg) - 1);
+	buf.msg[sizeof(buf.msg) - 1] = '\0';
+	CHECK(writeBinaryLog(path, log_data));
+	std::vector<LogData> read_back;
+	CHECK(readLogFile(path, read_back));
+	CHECK(read_back.size() == log_data.size());
+	if(read_back.empty())
+		return;
+	CHECK(strlen(read_back[0].robot_comm.msg) == sizeof(binary_log_record_T::text) - 1);
+	CHECK(strncmp(read_back[0].robot_comm.msg, buf.msg, sizeof(binary_log_record_T::text) - 1) == 0);
+	CHECK(sameEntry(log_data[1], read_back[1], true));
+}
+
+int main(void)
+{
+	const std::string path = (QDir::tempPath() + "/log_convert_test.log").toStdString();
+	const std::vector<LogData> log_data = makeGame();
+	testText(path, log_data, TEXT_LOG_2_1);
+	testText(path, log_data, TEXT_LOG_2_0);
+	testText(path, log_data, TEXT_LOG_1_0);
+	testBinaryMessage(path, log_data);
+	QFile::remove(QString::fromStdString(path));
+	if(failures > 0) {
+		std::cerr << failures << " checks failed" << std::endl;
+		return 1;
+	}
+	std::cout << "all checks passed" << std::endl;
+	return 0;
+}
@@ -0,0 +1,224 @@
+/*
+ * multifield_load: four fields at full packet rate in one process,
+ * checked against a CPU budget.
+ *
+ * Every field has its own port range and its own network thread, which
+ * receives the way UdpServer does on Linux (one epoll set, recvmmsg()
+ * into a slab) and hands the data on through a RobotRegistry, a
+ * TripleBuffer mailbox per robot and the log SpscQueue. One sender thread
+ * per field plays its robots. The CPU time of the network threads is
+ * measured with CLOCK_THREAD_CPUTIME_ID.
+ *
+ * Passes when every packet arrives in the right field and the network
+ * threads together stay below the budget.
+ */
+#include <iostream>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "comm_info.h"
+#include "robot_registry.h"
+#include "spsc_queue.h"
+#include "triple_buffer.h"
+
+namespace {
+
+const int FIELDS = 4;
+const int PORTS_PER_FIELD = 6;
+const int ROBOTS_PER_FIELD = 12;  // both teams
+const int RATE = 100;             // packets per second and robot, above what robots send
+const int SECONDS = 3;
+const double CPU_BUDGET = 0.25;   // of one core, all fields together
+const int RECV_BATCH = 64;
+const int MAX_DATAGRAM_SIZE = 128;
+const int LOG_QUEUE_SIZE = 16384;
+
+struct Field {
+	Field() : log_queue(LOG_QUEUE_SIZE), received(0), wrong_field(0), cpu_seconds(0.0) {}
+	~Field()
+	{
+		for(auto fd : fds)
+			close(fd);
+	}
+	int index;
+	std::vector<int> fds;
+	std::vector<struct sockaddr_in> addrs;
+	RobotRegistry robots;
+	TripleBuffer<struct comm_info_T> mailboxes[RobotRegistry::MAX_ROBOTS];
+	SpscQueue<struct comm_info_T> log_queue;
+	std::atomic<unsigned long long> received;
+	std::atomic<unsigned long long> wrong_field;
+	double cpu_seconds;
+};
+
+std::atomic<bool> running(true);
+
+bool openPorts(Field &field)
+{
+	for(int i = 0; i < PORTS_PER_FIELD; i++) {
+		const int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+		if(fd < 0)
+			return false;
+		field.fds.push_back(fd);
+		struct sockaddr_in addr;
+		std::memset(&addr, 0, sizeof(addr));
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		socklen_t len = sizeof(addr);
+		if(bind(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) < 0 ||
+			getsockname(fd, reinterpret_cast<struct sockaddr *>(&addr), &len) < 0)
+			return false;
+		field.addrs.push_back(addr);
+	}
+	return true;
+}
+
+void receiveField(Field &field)
+{
+	const int epoll_fd = epoll_create1(0);
+	for(int i = 0; i < PORTS_PER_FIELD; i++) {
+		struct epoll_event ev;
+		std::memset(&ev, 0, sizeof(ev));
+		ev.events = EPOLLIN;
+		ev.data.u32 = i;
+		epoll_ctl(epoll_fd, EPOLL_CTL_ADD, field.fds[i], &ev);
+	}
+	std::vector<unsigned char> slab(RECV_BATCH * MAX_DATAGRAM_SIZE);
+	std::vector<struct iovec> iovecs(RECV_BATCH);
+	std::vector<struct mmsghdr> msgs(RECV_BATCH);
+	for(int i = 0; i < RECV_BATCH; i++) {
+		iovecs[i].iov_base = &slab[i * MAX_DATAGRAM_SIZE];
+		iovecs[i].iov_len = MAX_DATAGRAM_SIZE;
+		std::memset(&msgs[i], 0, sizeof(msgs[i]));
+		msgs[i].msg_hdr.msg_iov = &iovecs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+	struct epoll_event events[PORTS_PER_FIELD];
+	while(running) {
+		const int n = epoll_wait(epoll_fd, events, PORTS_PER_FIELD, 10);
+		for(int e = 0; e < n; e++) {
+			const int fd = field.fds[events[e].data.u32];
+			for(;;) {
+				const int count = recvmmsg(fd, msgs.data(), RECV_BATCH, MSG_DONTWAIT, nullptr);
+				if(count <= 0)
+					break;
+				for(int i = 0; i < count; i++) {
+					const CommInfoView view(&slab[i * MAX_DATAGRAM_SIZE], msgs[i].msg_len);
+					if(!view.isValid())
+						continue;
+					// the sender puts its field into the first object byte
+					if(view.objects()[0][3] != field.index)
+						field.wrong_field++;
+					TripleBuffer<struct comm_info_T> &mailbox = field.mailboxes[field.robots.slotOf(view.id())];
+					view.copyTo(mailbox.writeBuffer());
+					field.log_queue.push(mailbox.writeBuffer());
+					mailbox.publish();
+					field.received++;
+				}
+				if(count < RECV_BATCH)
+					break;
+			}
+		}
+	}
+	close(epoll_fd);
+	struct timespec cpu;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu);
+	field.cpu_seconds = cpu.tv_sec + cpu.tv_nsec / 1e9;
+}
+
+void playRobots(const Field &field)
+{
+	const int sock = socket(AF_INET, SOCK_DGRAM, 0);
+	struct comm_info_T comm_info;
+	std::memset(&comm_info, 0, sizeof(comm_info));
+	comm_info.object[0][3] = static_cast<unsigned char>(field.index);
+	const std::chrono::microseconds period(1000000 / RATE);
+	std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+	for(int n = 0; n < RATE * SECONDS; n++) {
+		for(int robot = 0; robot < ROBOTS_PER_FIELD; robot++) {
+			comm_info.id = RobotRegistry::makeKey(robot % 2, robot / 2 + 1);
+			const struct sockaddr_in &addr = field.addrs[robot % PORTS_PER_FIELD];
+			sendto(sock, &comm_info, sizeof(comm_info), 0, reinterpret_cast<const struct sockaddr *>(&addr), sizeof(addr));
+		}
+		next += period;
+		std::this_thread::sleep_until(next);
+	}
+	close(sock);
+}
+
+/*
+ * The GUI side: every field's log queue is drained once per frame.
+ */
+void drainLogs(std::vector<std::unique_ptr<Field> > &fields)
+{
+	struct comm_info_T comm_info;
+	for(auto &field : fields)
+		while(field->log_queue.pop(comm_info))
+			;
+}
+
+} // namespace
+
+int main(void)
+{
+	std::vector<std::unique_ptr<Field> > fields;
+	for(int i = 0; i < FIELDS; i++) {
+		fields.push_back(std::unique_ptr<Field>(new Field));
+		fields.back()->index = i;
+		if(!openPorts(*fields.back())) {
+			std::cerr << "socket setup failed: " << std::strerror(errno) << std::endl;
+			return 1;
+		}
+	}
+	std::vector<std::thread> receivers, senders;
+	for(auto &field : fields)
+		receivers.push_back(std::thread(receiveField, std::ref(*field)));
+	for(auto &field : fields)
+		senders.push_back(std::thread(playRobots, std::cref(*field)));
+	for(auto &sender : senders)
+		sender.join();
+	for(int i = 0; i < 10; i++) {
+		drainLogs(fields);
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	}
+	running = false;
+	for(auto &receiver : receivers)
+		receiver.join();
+	drainLogs(fields);
+
+	const unsigned long long expected = static_cast<unsigned long long>(ROBOTS_PER_FIELD) * RATE * SECONDS;
+	double cpu_seconds = 0.0;
+	bool ok = true;
+	for(auto &field : fields) {
+		std::cout << "field " << field->index + 1 << ": " << field->received << " packets, " << field->robots.size()
+			<< " robots, " << field->cpu_seconds * 1000.0 << " ms CPU" << std::endl;
+		cpu_seconds += field->cpu_seconds;
+		if(field->received != expected || field->wrong_field != 0 || field->robots.size() != ROBOTS_PER_FIELD)
+			ok = false;
+	}
+	const double load = cpu_seconds / SECONDS;
+	std::cout << FIELDS * ROBOTS_PER_FIELD * RATE << " packets/s, network threads use " << load * 100.0
+		<< "% of one core (budget " << CPU_BUDGET * 100.0 << "%)" << std::endl;
+	if(!ok) {
+		std::cerr << "expected " << expected << " packets from " << ROBOTS_PER_FIELD << " robots in every field" << std::endl;
+		return 1;
+	}
+	if(load > CPU_BUDGET) {
+		std::cerr << "over the CPU budget" << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,157 @@
+/*
+ * render_bench: map frame time at 1080p and 4K window sizes, drawing at
+ * field resolution and smooth-scaling the result, as the monitor did,
+ * against drawing straight at the label's resolution through the scene
+ * transform.
+ *
+ * Every frame copies the field background and draws the markers and
+ * information boxes of twelve robots with FieldPainter. Runs without a
+ * display on the offscreen platform.
+ */
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <QGuiApplication>
+#include <QImage>
+#include <QPainter>
+#include <QTransform>
+
+#include "field_painter.h"
+#include "field_space_manager.h"
+#include "monitor_config.h"
+#include "text_cache.h"
+
+namespace {
+
+const int ROBOTS = 12;
+const int FRAMES = 100;
+
+typedef std::chrono::steady_clock bench_clock;
+
+std::shared_ptr<const MonitorConfig> defaultConfig(void)
+{
+	const FieldParameterInt field_param = FieldParameterInt(FieldParameter());
+	std::shared_ptr<MonitorConfig> config = std::make_shared<MonitorConfig>();
+	config->field_image_width = field_param.border_strip_width * 2 + field_param.field_length;
+	config->field_image_height = field_param.border_strip_width * 2 + field_param.field_width;
+	config->field_size_x = field_param.field_length * 10;
+	config->field_size_y = field_param.field_width * 10;
+	config->field_line_width = 5;
+	config->marker_pen_size = 3;
+	config->marker_robot_size = 15;
+	config->marker_ball_size = 6;
+	config->marker_goal_pole_size = 5;
+	config->marker_direction_marker_length = 20;
+	config->marker_font_size = 24;
+	config->marker_font_offset_x = 8;
+	config->marker_font_offset_y = 24;
+	config->marker_time_up_limit = 5;
+	config->font_size = 48;
+	config->display_minimum_height = 50;
+	config->render_max_fps = 30;
+	config->trail_seconds = 10;
+	config->log_flush_interval_ms = 200;
+	config->log_fsync = false;
+	config->log_binary = false;
+	config->image_scale_x = static_cast<double>(config->field_image_width) / config->field_size_x;
+	config->image_scale_y = static_cast<double>(config->field_image_height) / config->field_size_y;
+	return config;
+}
+
+std::vector<PositionMarker> robotMarkers(const MonitorConfig &config)
+{
+	static const char *colors[] = { "red", "blue", "green", "orange" };
+	std::vector<PositionMarker> positions(ROBOTS);
+	std::srand(1);
+	for(int i = 0; i < ROBOTS; i++) {
+		PositionMarker &marker = positions[i];
+		marker.robot_id = i / 2 + 1;
+		marker.colornum = i % 2;
+		std::strcpy(marker.color, colors[i % 4]);
+		marker.enable_pos = true;
+		marker.enable_ball = true;
+		marker.pos = Pos(50 + std::rand() % (config.field_image_width - 100), 50 + std::rand() % (config.field_image_height - 100), (std::rand() % 360) * M_PI / 180.0);
+		marker.ball = Pos(50 + std::rand() % (config.field_image_width - 100), 50 + std::rand() % (config.field_image_height - 100), 0.0);
+		marker.self_conf = 0.8;
+		marker.ball_conf = 0.6;
+		marker.message = "Attacker";
+	}
+	return positions;
+}
+
+QImage background(const FieldPainter &field_painter, const QSize &size, const QTransform &transform)
+{
+	QImage image(size, QImage::Format_ARGB32_Premultiplied);
+	image.fill(Qt::black);
+	QPainter paint(&image);
+	paint.setRenderHint(QPainter::Antialiasing);
+	paint.setTransform(transform);
+	field_painter.drawField(paint, FieldParameterInt(FieldParameter()));
+	field_painter.drawTeamMarker(paint, FieldParameterInt(FieldParameter()));
+	return image;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	qputenv("QT_QPA_PLATFORM", "offscreen");
+	QGuiApplication app(argc, argv);
+	const std::shared_ptr<const MonitorConfig> config = defaultConfig();
+	TextCache text_cache;
+	const FieldPainter field_painter(config, FieldView(), &text_cache);
+	std::vector<PositionMarker> positions = robotMarkers(*config);
+	// information boxes where the monitor puts them
+	FieldSpaceManager field_space(config->field_image_width, config->field_image_height, std::max(1, config->field_image_width / 20), std::max(1, config->field_image_height / 20));
+	field_painter.placeInformation(positions, field_space);
+	const QSize scene_size(config->field_image_width, config->field_image_height);
+	const QImage scene_background = background(field_painter, scene_size, QTransform());
+
+	static const struct {
+		const char *name;
+		QSize window;
+	} windows[] = {
+		{ "1080p", QSize(1920, 1080) },
+		{ "4K", QSize(3840, 2160) },
+	};
+	for(const auto &window : windows) {
+		const QSize target = scene_size.scaled(window.window, Qt::KeepAspectRatio);
+		const QTransform scene_transform = QTransform::fromScale(static_cast<qreal>(target.width()) / scene_size.width(), static_cast<qreal>(target.height()) / scene_size.height());
+		const QImage target_background = background(field_painter, target, scene_transform);
+
+		// draw at field resolution, then scale to the label
+		bench_clock::time_point start = bench_clock::now();
+		for(int frame = 0; frame < FRAMES; frame++) {
+			QImage map = scene_background;
+			QPainter paint(&map);
+			paint.setRenderHint(QPainter::Antialiasing);
+			field_painter.drawMarkers(paint, positions, 0, FieldPainter::RobotDrawer());
+			paint.end();
+			const QImage shown = map.scaled(target, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+			if(shown.size() != target)
+				return 1;
+		}
+		const double scaled_ms = std::chrono::duration<double, std::milli>(bench_clock::now() - start).count() / FRAMES;
+
+		// draw at the label's resolution
+		start = bench_clock::now();
+		for(int frame = 0; frame < FRAMES; frame++) {
+			QImage map = target_background;
+			QPainter paint(&map);
+			paint.setRenderHint(QPainter::Antialiasing);
+			paint.setTransform(scene_transform);
+			field_painter.drawMarkers(paint, positions, 0, FieldPainter::RobotDrawer());
+		}
+		const double direct_ms = std::chrono::duration<double, std::milli>(bench_clock::now() - start).count() / FRAMES;
+
+		std::cout << window.name << " (" << target.width() << "x" << target.height() << "): scaled "
+			<< scaled_ms << " ms/frame, direct " << direct_ms << " ms/frame" << std::endl;
+	}
+	return 0;
+}
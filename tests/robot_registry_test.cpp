@@ -0,0 +1,95 @@
+/*
+ * robot_registry_test: slot assignment of RobotRegistry, and a reader
+ * thread that follows the registry while robots are being added.
+ */
+#include <iostream>
+#include <atomic>
+#include <thread>
+
+#include "comm_info.h"
+#include "robot_registry.h"
+
+static int failures = 0;
+
+#define CHECK(cond) \
+	do { \
+		if(!(cond)) { \
+			std::cerr << __FILE__ << ":" << __LINE__ << ": " #cond << std::endl; \
+			failures++; \
+		} \
+	} while(0)
+
+static void testSlots(void)
+{
+	RobotRegistry robots;
+	CHECK(robots.size() == 0);
+	const unsigned char cyan3 = RobotRegistry::makeKey(CYAN, 3);
+	const unsigned char magenta1 = RobotRegistry::makeKey(MAGENTA, 1);
+	CHECK(RobotRegistry::colorOf(cyan3) == CYAN);
+	CHECK(RobotRegistry::idOf(cyan3) == 3);
+	CHECK(RobotRegistry::colorOf(magenta1) == MAGENTA);
+	CHECK(RobotRegistry::idOf(magenta1) == 1);
+	CHECK(robots.find(cyan3) < 0);
+
+	// slots follow the order of first appearance, not the id
+	CHECK(robots.slotOf(cyan3) == 0);
+	CHECK(robots.slotOf(magenta1) == 1);
+	CHECK(robots.slotOf(cyan3) == 0);
+	CHECK(robots.size() == 2);
+	CHECK(robots.find(magenta1) == 1);
+	CHECK(robots.keyOf(0) == cyan3);
+	CHECK(robots.keyOf(1) == magenta1);
+
+	// every possible key fits
+	for(int key = 0; key < RobotRegistry::MAX_ROBOTS; key++)
+		robots.slotOf(static_cast<unsigned char>(key));
+	CHECK(robots.size() == RobotRegistry::MAX_ROBOTS);
+	for(int slot = 0; slot < robots.size(); slot++)
+		CHECK(robots.find(robots.keyOf(slot)) == slot);
+
+	robots.clear();
+	CHECK(robots.size() == 0);
+	CHECK(robots.find(cyan3) < 0);
+	CHECK(robots.slotOf(magenta1) == 0);
+}
+
+/*
+ * The GUI thread reads size() and keyOf() while the network thread adds
+ * robots; every slot below size() must already hold its key.
+ */
+static void testConcurrentReader(void)
+{
+	static const int ROUNDS = 2000;
+	for(int round = 0; round < ROUNDS; round++) {
+		RobotRegistry robots;
+		std::atomic<bool> done(false);
+		std::atomic<int> bad(0);
+		std::thread reader([&] {
+			while(!done) {
+				const int size = robots.size();
+				for(int slot = 0; slot < size; slot++) {
+					// keys are registered in reverse order below
+					if(robots.keyOf(slot) != RobotRegistry::MAX_ROBOTS - 1 - slot)
+						bad++;
+				}
+			}
+		});
+		for(int key = RobotRegistry::MAX_ROBOTS - 1; key >= 0; key--)
+			robots.slotOf(static_cast<unsigned char>(key));
+		done = true;
+		reader.join();
+		CHECK(bad == 0);
+	}
+}
+
+int main(void)
+{
+	testSlots();
+	testConcurrentReader();
+	if(failures > 0) {
+		std::cerr << failures << " checks failed" << std::endl;
+		return 1;
+	}
+	std::cout << "all checks passed" << std::endl;
+	return 0;
+}
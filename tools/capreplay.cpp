@@ -0,0 +1,180 @@
+/*
+ * gm_capreplay: replays a raw packet capture (capture/enable, see
+ * packet_capture.h) to a running game monitor.
+ *
+ * Every datagram is sent unchanged to the port it was received on, in the
+ * order and with the spacing it was received, so the monitor decodes it
+ * with the same code as live traffic. The file is written slab by slab
+ * per receiver, so the datagrams are sorted by receive time first.
+ *
+ * The datagrams come from this host, so a monitor that follows a
+ * GameController address (network/gc_address) ignores the replayed
+ * GameController packets; leave it empty for replays.
+ */
+#include <iostream>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "packet_capture.h"
+
+namespace {
+
+struct Options {
+	const char *host = "127.0.0.1";
+	int port_offset = 0;
+	double speed = 1.0; // 0 sends as fast as possible
+	bool robots = true;
+	bool gamecontroller = true;
+};
+
+struct Datagram {
+	packet_capture_record_T record;
+	size_t offset; // of the payload in the data buffer
+};
+
+volatile std::sig_atomic_t running = 1;
+
+void stop(int)
+{
+	running = 0;
+}
+
+void usage(const char *name)
+{
+	std::cerr << "usage: " << name << " [options] capture.cap" << std::endl
+		<< "  -a host    destination address (127.0.0.1)" << std::endl
+		<< "  -o offset  added to every destination port (0)" << std::endl
+		<< "  -s speed   replay speed, 0 sends as fast as possible (1)" << std::endl
+		<< "  -R         robot packets only" << std::endl
+		<< "  -G         GameController packets only" << std::endl;
+}
+
+bool parseOptions(int argc, char **argv, Options &opt)
+{
+	int c;
+	while((c = getopt(argc, argv, "a:o:s:RGh")) != -1) {
+		switch(c) {
+		case 'a': opt.host = optarg; break;
+		case 'o': opt.port_offset = std::atoi(optarg); break;
+		case 's': opt.speed = std::atof(optarg); break;
+		case 'R': opt.gamecontroller = false; break;
+		case 'G': opt.robots = false; break;
+		default: return false;
+		}
+	}
+	if(optind != argc - 1 || opt.speed < 0.0 || (!opt.robots && !opt.gamecontroller)) {
+		std::cerr << "invalid options" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool readCapture(const char *filename, const Options &opt, std::vector<Datagram> &datagrams, std::vector<unsigned char> &data)
+{
+	FILE *fp = std::fopen(filename, "rb");
+	if(fp == nullptr) {
+		std::cerr << filename << ": " << std::strerror(errno) << std::endl;
+		return false;
+	}
+	packet_capture_header_T header;
+	if(std::fread(&header, sizeof(header), 1, fp) != 1 || std::memcmp(header.magic, PACKET_CAPTURE_MAGIC, sizeof(PACKET_CAPTURE_MAGIC)) != 0) {
+		std::cerr << filename << ": not a packet capture" << std::endl;
+		std::fclose(fp);
+		return false;
+	}
+	if(header.version != PACKET_CAPTURE_VERSION) {
+		std::cerr << filename << ": unsupported capture version " << header.version << std::endl;
+		std::fclose(fp);
+		return false;
+	}
+	Datagram datagram;
+	while(std::fread(&datagram.record, sizeof(datagram.record), 1, fp) == 1) {
+		const size_t padded = (datagram.record.size + 7) / 8 * 8;
+		datagram.offset = data.size();
+		data.resize(data.size() + padded);
+		if(std::fread(&data[datagram.offset], 1, padded, fp) != padded) {
+			std::cerr << filename << ": truncated, replaying " << datagrams.size() << " packets" << std::endl;
+			data.resize(datagram.offset);
+			break;
+		}
+		const bool wanted = datagram.record.kind == CAPTURE_ROBOT ? opt.robots : datagram.record.kind == CAPTURE_GAMECONTROLLER ? opt.gamecontroller : false;
+		if(wanted)
+			datagrams.push_back(datagram);
+	}
+	std::fclose(fp);
+	std::stable_sort(datagrams.begin(), datagrams.end(), [](const Datagram &a, const Datagram &b) {
+		return a.record.time_us < b.record.time_us;
+	});
+	return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	Options opt;
+	if(!parseOptions(argc, argv, opt)) {
+		usage(argv[0]);
+		return 1;
+	}
+	std::vector<Datagram> datagrams;
+	std::vector<unsigned char> data;
+	if(!readCapture(argv[optind], opt, datagrams, data))
+		return 1;
+	if(datagrams.empty()) {
+		std::cout << "no packets to replay" << std::endl;
+		return 0;
+	}
+	const int sock = socket(AF_INET, SOCK_DGRAM, 0);
+	if(sock < 0) {
+		std::cerr << "socket: " << std::strerror(errno) << std::endl;
+		return 1;
+	}
+	struct sockaddr_in addr;
+	std::memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	if(inet_pton(AF_INET, opt.host, &addr.sin_addr) != 1) {
+		std::cerr << "invalid address: " << opt.host << std::endl;
+		return 1;
+	}
+	std::signal(SIGINT, stop);
+	std::signal(SIGTERM, stop);
+
+	typedef std::chrono::steady_clock clock;
+	const clock::time_point start = clock::now();
+	const long long first_us = datagrams.front().record.time_us;
+	unsigned long long sent = 0, failed = 0;
+
+	for(size_t i = 0; i < datagrams.size() && running; i++) {
+		const packet_capture_record_T &record = datagrams[i].record;
+		if(opt.speed > 0.0) {
+			const double offset = (record.time_us - first_us) / 1e6 / opt.speed;
+			std::this_thread::sleep_until(start + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(offset)));
+		}
+		addr.sin_port = htons(record.local_port + opt.port_offset);
+		if(sendto(sock, &data[datagrams[i].offset], record.size, 0, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) < 0)
+			failed++;
+		else
+			sent++;
+	}
+	close(sock);
+
+	const double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+	const double captured = (datagrams.back().record.time_us - first_us) / 1e6;
+	std::cout << "packets sent: " << sent << " of " << datagrams.size() << std::endl
+		<< "send errors: " << failed << std::endl
+		<< "replayed " << captured << " s of capture in " << elapsed << " s" << std::endl;
+	return 0;
+}
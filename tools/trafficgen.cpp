@@ -0,0 +1,227 @@
+/*
+ * gm_trafficgen: synthetic robot and GameController traffic for the game
+ * monitor.
+ *
+ * Sends comm_info_T packets for N robots, spread over the monitor's port
+ * range, and GameController version 12 packets. Every robot packet carries
+ * a traffic probe (sequence number and send time, see traffic_probe.h) so
+ * the monitor can report end-to-end latency and drop rate. Packets
+ * discarded with -l still consume a sequence number and show up as drops.
+ *
+ * Robots are sent in bursts: with a burst size of B each robot sends B
+ * packets back to back every B / rate seconds, so the mean rate does not
+ * depend on the burst size.
+ */
+#include <iostream>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "comm_info.h"
+#include "gc_layout.h"
+#include "traffic_probe.h"
+
+namespace {
+
+struct Options {
+	const char *host = "127.0.0.1";
+	int port = COMM_INFO_PORT;
+	int port_count = 6;
+	int robots = 6;
+	double rate = 30.0; // packets per second and robot
+	int burst = 1;
+	double loss = 0.0;
+	int gc_port = 3838;
+	double gc_rate = 2.0;
+	double duration = 0.0; // seconds, 0 runs until interrupted
+};
+
+volatile std::sig_atomic_t running = 1;
+
+void stop(int)
+{
+	running = 0;
+}
+
+void usage(const char *name)
+{
+	std::cerr << "usage: " << name << " [options]" << std::endl
+		<< "  -a host    destination address (127.0.0.1)" << std::endl
+		<< "  -p port    first robot port (" << COMM_INFO_PORT << ")" << std::endl
+		<< "  -n count   number of robot ports (6)" << std::endl
+		<< "  -r robots  number of robots, alternately MAGENTA and CYAN (6)" << std::endl
+		<< "  -f rate    packets per second and robot (30)" << std::endl
+		<< "  -b burst   packets per burst (1)" << std::endl
+		<< "  -l loss    probability of discarding a packet before sending (0)" << std::endl
+		<< "  -G port    GameController port (3838)" << std::endl
+		<< "  -g rate    GameController packets per second, 0 disables (2)" << std::endl
+		<< "  -d secs    run time, 0 runs until interrupted (0)" << std::endl;
+}
+
+bool parseOptions(int argc, char **argv, Options &opt)
+{
+	int c;
+	while((c = getopt(argc, argv, "a:p:n:r:f:b:l:G:g:d:h")) != -1) {
+		switch(c) {
+		case 'a': opt.host = optarg; break;
+		case 'p': opt.port = std::atoi(optarg); break;
+		case 'n': opt.port_count = std::atoi(optarg); break;
+		case 'r': opt.robots = std::atoi(optarg); break;
+		case 'f': opt.rate = std::atof(optarg); break;
+		case 'b': opt.burst = std::atoi(optarg); break;
+		case 'l': opt.loss = std::atof(optarg); break;
+		case 'G': opt.gc_port = std::atoi(optarg); break;
+		case 'g': opt.gc_rate = std::atof(optarg); break;
+		case 'd': opt.duration = std::atof(optarg); break;
+		default: return false;
+		}
+	}
+	if(opt.port_count < 1 || opt.robots < 1 || opt.robots > 252 || opt.rate <= 0.0 || opt.burst < 1) {
+		std::cerr << "invalid option value" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/*
+ * Robot i walks a circle around the center of the field and looks at a
+ * ball that circles the other way.
+ */
+void fillRobotPacket(struct comm_info_T &comm_info, const int robot, const double t)
+{
+	std::memset(&comm_info, 0, sizeof(comm_info));
+	const int color = robot % 2 == 0 ? MAGENTA : CYAN;
+	comm_info.id = static_cast<unsigned char>((color << 7) | (robot / 2 + 1));
+	comm_info.cf_own = 80;
+	comm_info.cf_ball = 60;
+	const double phase = robot * 2.0 * M_PI / 6.0 + t * 0.5;
+	const Pos self(std::cos(phase) * 2500.0, std::sin(phase) * 1800.0, phase + M_PI / 2.0);
+	const Pos ball(std::cos(-phase) * 1000.0, std::sin(-phase) * 1000.0, 0.0);
+	encodeCommInfoObject(comm_info.object[0], SELF_POS, self);
+	encodeCommInfoObject(comm_info.object[1], BALL, ball);
+	comm_info.fps = 30;
+	comm_info.voltage = static_cast<unsigned char>(1480 / 8); // 14.8 V
+	comm_info.temperature = 40;
+	static const char *roles[] = { "Attacker", "Defender", "Keeper", "Neutral" };
+	std::snprintf(reinterpret_cast<char *>(comm_info.command), TRAFFIC_PROBE_OFFSET, "%s trafficgen", roles[robot % 4]);
+}
+
+void fillGameControllerPacket(unsigned char *data, const unsigned char packet_number, const double t)
+{
+	typedef GCLayoutV12 L;
+	std::memset(data, 0, L::packet_size);
+	std::memcpy(data, "RGme", 4);
+	data[4] = L::version & 0xff;
+	data[5] = L::version >> 8;
+	data[L::packet_number] = packet_number;
+	data[L::players_per_team] = 4;
+	data[L::state] = 3; // playing
+	data[L::first_half] = 1;
+	const int secs_remaining = 600 - static_cast<int>(t) % 600;
+	data[L::secs_remaining] = secs_remaining & 0xff;
+	data[L::secs_remaining + 1] = (secs_remaining >> 8) & 0xff;
+	for(int team = 0; team < 2; team++) {
+		unsigned char *info = data + L::team_info + team * L::team_info_size;
+		info[L::team_number] = static_cast<unsigned char>(team + 1);
+		info[L::team_color] = static_cast<unsigned char>(team);
+		info[L::score] = static_cast<unsigned char>(static_cast<int>(t) / (60 + team * 30));
+	}
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	Options opt;
+	if(!parseOptions(argc, argv, opt)) {
+		usage(argv[0]);
+		return 1;
+	}
+	const int sock = socket(AF_INET, SOCK_DGRAM, 0);
+	if(sock < 0) {
+		std::cerr << "socket: " << std::strerror(errno) << std::endl;
+		return 1;
+	}
+	struct sockaddr_in addr;
+	std::memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	if(inet_pton(AF_INET, opt.host, &addr.sin_addr) != 1) {
+		std::cerr << "invalid address: " << opt.host << std::endl;
+		return 1;
+	}
+	std::signal(SIGINT, stop);
+	std::signal(SIGTERM, stop);
+
+	typedef std::chrono::steady_clock clock;
+	const clock::time_point start = clock::now();
+	const clock::duration robot_period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(opt.burst / opt.rate));
+	const clock::duration gc_period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(opt.gc_rate > 0.0 ? 1.0 / opt.gc_rate : 0.0));
+	clock::time_point next_robot = start;
+	clock::time_point next_gc = start;
+
+	std::mt19937 rng(1);
+	std::bernoulli_distribution discard(std::max(0.0, std::min(1.0, opt.loss)));
+	std::vector<uint32_t> seq(opt.robots, 0);
+	unsigned long long sent = 0, discarded = 0, failed = 0, gc_sent = 0;
+	unsigned char packet_number = 0;
+	struct comm_info_T comm_info;
+	std::vector<unsigned char> gc_packet(GCLayoutV12::packet_size);
+
+	while(running) {
+		const clock::time_point now = clock::now();
+		const double t = std::chrono::duration<double>(now - start).count();
+		if(opt.duration > 0.0 && t >= opt.duration)
+			break;
+		if(now >= next_robot) {
+			for(int b = 0; b < opt.burst; b++) {
+				for(int i = 0; i < opt.robots; i++) {
+					fillRobotPacket(comm_info, i, t);
+					const uint32_t n = seq[i]++;
+					if(discard(rng)) {
+						discarded++;
+						continue;
+					}
+					writeTrafficProbe(comm_info, n, probeClockMicroseconds());
+					addr.sin_port = htons(opt.port + i % opt.port_count);
+					if(sendto(sock, &comm_info, sizeof(comm_info), 0, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) < 0)
+						failed++;
+					else
+						sent++;
+				}
+			}
+			next_robot += robot_period;
+		}
+		if(opt.gc_rate > 0.0 && now >= next_gc) {
+			fillGameControllerPacket(gc_packet.data(), packet_number++, t);
+			addr.sin_port = htons(opt.gc_port);
+			if(sendto(sock, gc_packet.data(), gc_packet.size(), 0, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) >= 0)
+				gc_sent++;
+			next_gc += gc_period;
+		}
+		clock::time_point wake = next_robot;
+		if(opt.gc_rate > 0.0 && next_gc < wake)
+			wake = next_gc;
+		std::this_thread::sleep_until(wake);
+	}
+	close(sock);
+
+	const double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+	std::cout << "robot packets sent: " << sent << " (" << sent / elapsed << "/s)" << std::endl
+		<< "discarded (simulated loss): " << discarded << std::endl
+		<< "send errors: " << failed << std::endl
+		<< "GameController packets sent: " << gc_sent << std::endl;
+	return 0;
+}